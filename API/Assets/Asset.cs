@@ -14,5 +14,15 @@ namespace FalcoEngine
         /// Get asset name
         /// </summary>
         public string name { [MethodImpl(MethodImplOptions.InternalCall)] get; }
+
+        /// <summary>
+        /// Is asset loaded and ready to use
+        /// </summary>
+        public bool isLoaded { [MethodImpl(MethodImplOptions.InternalCall)] get; }
+
+        /// <summary>
+        /// Is asset being loaded in background
+        /// </summary>
+        public bool isLoading { [MethodImpl(MethodImplOptions.InternalCall)] get; }
     }
 }
@@ -26,6 +26,16 @@ namespace FalcoEngine
             return INTERNAL_load(name);
         }
 
+        /// <summary>
+        /// Start loading existing texture in background. Returned texture is empty until isLoaded is true
+        /// </summary>
+        /// <param name="name">Name of the existing texture</param>
+        /// <returns>Texture which is being loaded</returns>
+        public static Texture LoadAsync(string name)
+        {
+            return INTERNAL_loadAsync(name);
+        }
+
         /// <summary>
         /// Create texture from bytes containing RGBA data
         /// </summary>
@@ -41,6 +51,9 @@ namespace FalcoEngine
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern Texture INTERNAL_load(string path);
 
+        [MethodImpl(MethodImplOptions.InternalCall)]
+        private static extern Texture INTERNAL_loadAsync(string path);
+
         [MethodImpl(MethodImplOptions.InternalCall)]
         private static extern Texture INTERNAL_fromBytesRGBA8(sbyte[] data, int width, int height);
     }
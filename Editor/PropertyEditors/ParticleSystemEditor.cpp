@@ -185,7 +185,7 @@ namespace GX
 			startSpeed->setOnChangeCallback([=](Property* prop, float val) { onChangeStartSpeed(i, val); });
 			emitterProp->addChild(startSpeed);
 
-			if (!emitter->getEnablePhysics())
+			if (!emitter->usesRigidBodies())
 			{
 				PropVector3* startDirection = new PropVector3(this, "Start direction", emitter->getStartDirection());
 				startDirection->setOnChangeCallback([=](Property* prop, glm::vec3 val) { onChangeStartDirection(i, val); });
@@ -201,14 +201,31 @@ namespace GX
 				PropInfo* alert = new PropInfo(this, "", "Physics simulation will be enabled only in runtime");
 				alert->setIcon(warnIcon);
 				emitterProp->addChild(alert);
-				
-				PropFloat* friction = new PropFloat(this, "Friction", emitter->getFriction());
-				friction->setOnChangeCallback([=](Property* prop, float val) { onChangeFriction(i, val); });
-				emitterProp->addChild(friction);
 
-				PropFloat* bounciness = new PropFloat(this, "Bounciness", emitter->getBounciness());
-				bounciness->setOnChangeCallback([=](Property* prop, float val) { onChangeBounciness(i, val); });
-				emitterProp->addChild(bounciness);
+				PropComboBox* collisionMode = new PropComboBox(this, "Collision mode", { "Rigid body", "Raycast" });
+				collisionMode->setCurrentItem(static_cast<int>(emitter->getCollisionMode()));
+				collisionMode->setOnChangeCallback([=](Property* prop, int val) { onChangeCollisionMode(i, val); });
+				emitterProp->addChild(collisionMode);
+
+				if (emitter->getCollisionMode() == ParticleEmitter::CollisionMode::Raycast)
+				{
+					PropComboBox* collisionResponse = new PropComboBox(this, "Collision response", { "Bounce", "Kill" });
+					collisionResponse->setCurrentItem(static_cast<int>(emitter->getCollisionResponse()));
+					collisionResponse->setOnChangeCallback([=](Property* prop, int val) { onChangeCollisionResponse(i, val); });
+					emitterProp->addChild(collisionResponse);
+				}
+
+				if (emitter->getCollisionMode() == ParticleEmitter::CollisionMode::RigidBody ||
+					emitter->getCollisionResponse() == ParticleEmitter::CollisionResponse::Bounce)
+				{
+					PropFloat* friction = new PropFloat(this, "Friction", emitter->getFriction());
+					friction->setOnChangeCallback([=](Property* prop, float val) { onChangeFriction(i, val); });
+					emitterProp->addChild(friction);
+
+					PropFloat* bounciness = new PropFloat(this, "Bounciness", emitter->getBounciness());
+					bounciness->setOnChangeCallback([=](Property* prop, float val) { onChangeBounciness(i, val); });
+					emitterProp->addChild(bounciness);
+				}
 			}
 
 			PropBool* animated = new PropBool(this, "Animated", emitter->getAnimated());
@@ -242,9 +259,10 @@ namespace GX
 
 			if (emitter->getSimulationSpace() == ParticleEmitter::SimulationSpace::Local)
 			{
-				if (emitter->getEnablePhysics())
+				//Raycast collision works in both spaces
+				if (emitter->getEnablePhysics() && emitter->getCollisionMode() == ParticleEmitter::CollisionMode::RigidBody)
 				{
-					PropInfo* alert = new PropInfo(this, "", "Physics simulation is not available in local space");
+					PropInfo* alert = new PropInfo(this, "", "Rigid body simulation is not available in local space, use raycast collision");
 					alert->setIcon(warnIcon);
 					emitterProp->addChild(alert);
 				}
@@ -548,6 +566,11 @@ namespace GX
 		sEmitter.startSizeMax = emitter->getStartSizeMax();
 		sEmitter.startDirection = emitter->getStartDirection();
 		sEmitter.startSpeed = emitter->getStartSpeed();
+		sEmitter.enablePhysics = emitter->getEnablePhysics();
+		sEmitter.friction = emitter->getFriction();
+		sEmitter.bounciness = emitter->getBounciness();
+		sEmitter.collisionMode = static_cast<int>(emitter->getCollisionMode());
+		sEmitter.collisionResponse = static_cast<int>(emitter->getCollisionResponse());
 		sEmitter.animated = emitter->getAnimated();
 		sEmitter.animationGridSize = emitter->getAnimationGridSize();
 		sEmitter.animationTimeMode = static_cast<int>(emitter->getAnimationTimeMode());
@@ -677,6 +700,11 @@ namespace GX
 		emitter->setStartSizeMax(sEmitter.startSizeMax);
 		emitter->setStartDirection(sEmitter.startDirection.getValue());
 		emitter->setStartSpeed(sEmitter.startSpeed);
+		emitter->setEnablePhysics(sEmitter.enablePhysics);
+		emitter->setFriction(sEmitter.friction);
+		emitter->setBounciness(sEmitter.bounciness);
+		emitter->setCollisionMode(static_cast<ParticleEmitter::CollisionMode>(sEmitter.collisionMode));
+		emitter->setCollisionResponse(static_cast<ParticleEmitter::CollisionResponse>(sEmitter.collisionResponse));
 		emitter->setAnimated(sEmitter.animated);
 		emitter->setAnimationGridSize(sEmitter.animationGridSize.getValue());
 		emitter->setAnimationTimeMode(static_cast<ParticleEmitter::AnimationTimeMode>(sEmitter.animationTimeMode));
@@ -2011,6 +2039,108 @@ namespace GX
 		}
 	}
 
+	void ParticleSystemEditor::onChangeCollisionMode(int emitterIdx, int value)
+	{
+		//Undo
+		UndoData* undoData = Undo::addUndo("Change emitter collision mode");
+		undoData->intData.resize(3);
+
+		undoData->intData[0][nullptr] = emitterIdx;
+
+		undoData->undoAction = [=](UndoData* data)
+		{
+			int idx = data->intData[0][nullptr];
+
+			for (auto& d : data->intData[1])
+			{
+				ParticleSystem* comp = (ParticleSystem*)d.first;
+				ParticleEmitter* emitter = comp->getEmitter(idx);
+				emitter->setCollisionMode(static_cast<ParticleEmitter::CollisionMode>(d.second));
+			}
+
+			MainWindow::getInspectorWindow()->updateCurrentEditor();
+		};
+
+		undoData->redoAction = [=](UndoData* data)
+		{
+			int idx = data->intData[0][nullptr];
+
+			for (auto& d : data->intData[2])
+			{
+				ParticleSystem* comp = (ParticleSystem*)d.first;
+				ParticleEmitter* emitter = comp->getEmitter(idx);
+				emitter->setCollisionMode(static_cast<ParticleEmitter::CollisionMode>(d.second));
+			}
+
+			MainWindow::getInspectorWindow()->updateCurrentEditor();
+		};
+		//
+
+		for (auto jt = components.begin(); jt != components.end(); ++jt)
+		{
+			ParticleSystem* ps = (ParticleSystem*)*jt;
+			ParticleEmitter* emitter = ps->getEmitter(emitterIdx);
+
+			undoData->intData[1][ps] = static_cast<int>(emitter->getCollisionMode());
+			undoData->intData[2][ps] = value;
+
+			emitter->setCollisionMode(static_cast<ParticleEmitter::CollisionMode>(value));
+		}
+
+		MainWindow::getInspectorWindow()->updateCurrentEditor();
+	}
+
+	void ParticleSystemEditor::onChangeCollisionResponse(int emitterIdx, int value)
+	{
+		//Undo
+		UndoData* undoData = Undo::addUndo("Change emitter collision response");
+		undoData->intData.resize(3);
+
+		undoData->intData[0][nullptr] = emitterIdx;
+
+		undoData->undoAction = [=](UndoData* data)
+		{
+			int idx = data->intData[0][nullptr];
+
+			for (auto& d : data->intData[1])
+			{
+				ParticleSystem* comp = (ParticleSystem*)d.first;
+				ParticleEmitter* emitter = comp->getEmitter(idx);
+				emitter->setCollisionResponse(static_cast<ParticleEmitter::CollisionResponse>(d.second));
+			}
+
+			MainWindow::getInspectorWindow()->updateCurrentEditor();
+		};
+
+		undoData->redoAction = [=](UndoData* data)
+		{
+			int idx = data->intData[0][nullptr];
+
+			for (auto& d : data->intData[2])
+			{
+				ParticleSystem* comp = (ParticleSystem*)d.first;
+				ParticleEmitter* emitter = comp->getEmitter(idx);
+				emitter->setCollisionResponse(static_cast<ParticleEmitter::CollisionResponse>(d.second));
+			}
+
+			MainWindow::getInspectorWindow()->updateCurrentEditor();
+		};
+		//
+
+		for (auto jt = components.begin(); jt != components.end(); ++jt)
+		{
+			ParticleSystem* ps = (ParticleSystem*)*jt;
+			ParticleEmitter* emitter = ps->getEmitter(emitterIdx);
+
+			undoData->intData[1][ps] = static_cast<int>(emitter->getCollisionResponse());
+			undoData->intData[2][ps] = value;
+
+			emitter->setCollisionResponse(static_cast<ParticleEmitter::CollisionResponse>(value));
+		}
+
+		MainWindow::getInspectorWindow()->updateCurrentEditor();
+	}
+
 	void ParticleSystemEditor::onChangeAnimated(int emitterIdx, bool value)
 	{
 		//Undo
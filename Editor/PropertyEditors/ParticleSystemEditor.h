@@ -48,6 +48,8 @@ namespace GX
 		void onChangeEnablePhysics(int emitterIdx, bool value);
 		void onChangeFriction(int emitterIdx, float value);
 		void onChangeBounciness(int emitterIdx, float value);
+		void onChangeCollisionMode(int emitterIdx, int value);
+		void onChangeCollisionResponse(int emitterIdx, int value);
 		void onChangeAnimated(int emitterIdx, bool value);
 		void onChangeAnimationGridSize(int emitterIdx, glm::vec2 value);
 		void onChangeAnimationTimeMode(int emitterIdx, int value);
@@ -159,7 +159,7 @@ namespace GX
 		Property* textureSettings = new Property(this, "Textures");
 		graphicsSettings->addChild(textureSettings);
 
-		PropComboBox* textureCompression = new PropComboBox(this, "Compression", { "None", "BC7" });
+		PropComboBox* textureCompression = new PropComboBox(this, "Compression", { "None", "BC7", "BC1", "BC3", "BC4", "BC5 (normal maps)", "Auto" });
 		textureCompression->setCurrentItem(projectSettings->getTextureCompression() - 1);
 		textureCompression->setOnChangeCallback([=](Property* prop, int val) { onChangeTextureCompression(prop, val); });
 
@@ -177,6 +177,20 @@ namespace GX
 
 		textureSettings->addChild(textureMaxResolution);
 
+		PropBool* textureStreaming = new PropBool(this, "Streaming", projectSettings->getTextureStreaming());
+		textureStreaming->setOnChangeCallback([=](Property* prop, bool val) { onChangeTextureStreaming(prop, val); });
+
+		textureSettings->addChild(textureStreaming);
+
+		if (projectSettings->getTextureStreaming())
+		{
+			PropInt* textureStreamingBudget = new PropInt(this, "Streaming budget (MB)", projectSettings->getTextureStreamingBudget());
+			textureStreamingBudget->setMinValue(16);
+			textureStreamingBudget->setOnChangeCallback([=](Property* prop, int val) { onChangeTextureStreamingBudget(prop, val); });
+
+			textureSettings->addChild(textureStreamingBudget);
+		}
+
 		addProperty(graphicsSettings);
 
 		//Steam API
@@ -514,6 +528,22 @@ namespace GX
 		);
 	}
 
+	void ProjectSettingsEditor::onChangeTextureStreaming(Property* prop, bool val)
+	{
+		ProjectSettings* projectSettings = Engine::getSingleton()->getSettings();
+		projectSettings->setTextureStreaming(val);
+		projectSettings->save();
+
+		updateEditor();
+	}
+
+	void ProjectSettingsEditor::onChangeTextureStreamingBudget(Property* prop, int val)
+	{
+		ProjectSettings* projectSettings = Engine::getSingleton()->getSettings();
+		projectSettings->setTextureStreamingBudget(val);
+		projectSettings->save();
+	}
+
 	void ProjectSettingsEditor::onChangeEnableSteamAPI(Property* prop, bool val)
 	{
 		ProjectSettings* projectSettings = Engine::getSingleton()->getSettings();
@@ -45,6 +45,8 @@ namespace GX
 		void onChangeTextureCompression(Property* prop, int val);
 		void onChangeTextureCompressionQuality(Property* prop, int val);
 		void onChangeTextureMaxResolution(Property* prop, int val);
+		void onChangeTextureStreaming(Property* prop, bool val);
+		void onChangeTextureStreamingBudget(Property* prop, int val);
 
 		void onChangeEnableSteamAPI(Property* prop, bool val);
 		void onChangeSteamAppID(Property* prop, int val);
@@ -842,6 +842,12 @@ namespace GX
 		float offset = 1.0f * terrain->getScale();
 		glm::vec3 tp = terrain->getGameObject()->getTransform()->getPosition();
 
+		//Splat texels changed by the brush
+		int splatMinX = INT_MAX;
+		int splatMinY = INT_MAX;
+		int splatMaxX = -1;
+		int splatMaxY = -1;
+
 		for (int32_t area_y = -brushSize; area_y < brushSize; ++area_y)
 		{
 			for (int32_t area_x = -brushSize; area_x < brushSize; ++area_x)
@@ -958,6 +964,11 @@ namespace GX
 						if (tw < 0 || th < 0) continue;
 						if (tw >= texWidth || th >= texWidth) continue;
 
+						splatMinX = std::min(splatMinX, tw);
+						splatMinY = std::min(splatMinY, th);
+						splatMaxX = std::max(splatMaxX, tw);
+						splatMaxY = std::max(splatMaxY, th);
+
 						//Clear other splat textures at this point
 						if (texDataList.size() > selectedTexture)
 						{
@@ -1115,8 +1126,11 @@ namespace GX
 		{
 			std::vector<Texture*>& splatTextures = terrain->getSplatTextures();
 
-			for (auto td = splatTextures.begin(); td != splatTextures.end(); ++td)
-				(*td)->updateTexture();
+			if (splatMaxX >= splatMinX)
+			{
+				for (auto td = splatTextures.begin(); td != splatTextures.end(); ++td)
+					(*td)->updateTextureRegion(splatMinX, splatMinY, splatMaxX - splatMinX + 1, splatMaxY - splatMinY + 1);
+			}
 		}
 	}
 
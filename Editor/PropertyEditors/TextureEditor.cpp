@@ -52,7 +52,7 @@ namespace GX
 
 		addProperty(filterMode);
 
-		PropComboBox* compressionMethod = new PropComboBox(this, "Compression", { "Default", "None", "BC7" });
+		PropComboBox* compressionMethod = new PropComboBox(this, "Compression", { "Default", "None", "BC7", "BC1", "BC3", "BC4", "BC5 (normal maps)", "Auto" });
 		compressionMethod->setCurrentItem(static_cast<int>(texture->getCompressionMethod()));
 		compressionMethod->setOnChangeCallback([=](Property* prop, int val) { onChangeCompressionMethod(val); });
 
@@ -183,7 +183,18 @@ namespace GX
 			ImVec2 sz = ImGui::GetContentRegionAvail();
 			sz.x -= 1;
 			float x = sz.x;
-			
+
+			if (!textures[0]->isLoaded())
+			{
+				//Reimport is running in the background
+				std::string str = textures[0]->isImporting() ? "Importing... " + std::to_string((int)(textures[0]->getImportProgress() * 100.0f)) + "%" : "Not loaded";
+				ImVec2 textSize = ImGui::CalcTextSize(str.c_str());
+				ImGui::SetCursorPos(ImVec2(x / 2 - textSize.x / 2, previewHeight / 2 - textSize.y / 2));
+				ImGui::Text(str.c_str());
+
+				return;
+			}
+
 			float w = textures[0]->getOriginalWidth();
 			float h = textures[0]->getOriginalHeight();
 			float aspect = h / w;
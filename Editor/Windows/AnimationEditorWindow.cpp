@@ -23,6 +23,24 @@
 
 namespace GX
 {
+	//Keys have to stay ordered by time, AnimationClip looks them up with binary search
+	template<typename T>
+	static void insertKey(std::vector<T>& keys, T key)
+	{
+		auto it = std::upper_bound(keys.begin(), keys.end(), key, [](const T& a, const T& b) -> bool { return a.time < b.time; });
+		keys.insert(it, key);
+	}
+
+	//Changes time of the key and restores the order. Returns new address of the key
+	template<typename T>
+	static T* moveKey(std::vector<T>& keys, T* key, int time)
+	{
+		key->time = time;
+		std::stable_sort(keys.begin(), keys.end(), [](const T& a, const T& b) -> bool { return a.time < b.time; });
+
+		return &*std::find_if(keys.begin(), keys.end(), [=](const T& v) -> bool { return v.time == time; });
+	}
+
 	AnimationEditorWindow::AnimationEditorWindow()
 	{
 	}
@@ -133,6 +151,9 @@ namespace GX
 		//Name
 		ImGui::Text(fileName.c_str());
 
+		ImGui::SameLine();
+		ImGui::TextDisabled(("(" + std::to_string(openedAnimation->getMemorySize() / 1024) + " KB)").c_str());
+
 		ImGui::Dummy(ImVec2(10, 5));
 		ImGui::Separator();
 		ImGui::Dummy(ImVec2(10, 5));
@@ -574,12 +595,11 @@ namespace GX
 							if (anim != nullptr)
 							{
 								int idxNode = data->intData[0][nullptr];
-								int idxKey = data->intData[1][nullptr];
 								AnimationClipNode* _node = anim->getAnimationClipNodes()[idxNode];
 								if (_node != nullptr)
 								{
 									auto& _posKeys = _node->getPositionKeys();
-									_posKeys.insert(_posKeys.begin() + idxKey, TimeVector3(data->intData[2][nullptr], data->vec3Data[0][nullptr]));
+									insertKey(_posKeys, TimeVector3(data->intData[2][nullptr], data->vec3Data[0][nullptr]));
 								}
 							}
 						};
@@ -638,12 +658,11 @@ namespace GX
 							if (anim != nullptr)
 							{
 								int idxNode = data->intData[0][nullptr];
-								int idxKey = data->intData[1][nullptr];
 								AnimationClipNode* _node = anim->getAnimationClipNodes()[idxNode];
 								if (_node != nullptr)
 								{
 									auto& _rotKeys = _node->getRotationKeys();
-									_rotKeys.insert(_rotKeys.begin() + idxKey, TimeQuaternion(data->intData[2][nullptr], data->quatData[0][nullptr]));
+									insertKey(_rotKeys, TimeQuaternion(data->intData[2][nullptr], data->quatData[0][nullptr]));
 								}
 							}
 						};
@@ -702,12 +721,11 @@ namespace GX
 							if (anim != nullptr)
 							{
 								int idxNode = data->intData[0][nullptr];
-								int idxKey = data->intData[1][nullptr];
 								AnimationClipNode* _node = anim->getAnimationClipNodes()[idxNode];
 								if (_node != nullptr)
 								{
 									auto& _sclKeys = _node->getScalingKeys();
-									_sclKeys.insert(_sclKeys.begin() + idxKey, TimeVector3(data->intData[2][nullptr], data->vec3Data[0][nullptr]));
+									insertKey(_sclKeys, TimeVector3(data->intData[2][nullptr], data->vec3Data[0][nullptr]));
 								}
 							}
 						};
@@ -873,7 +891,13 @@ namespace GX
 								if (_node != nullptr)
 								{
 									auto& _keys = _node->getPositionKeys();
-									_keys.erase(_keys.begin() + (_keys.size() - 1));
+									auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeVector3& v) -> bool { return v.time == data->intData[1][nullptr]; });
+									if (it != _keys.end())
+										_keys.erase(it);
+
+									selFramePos = nullptr;
+									selFrameRot = nullptr;
+									selFrameScl = nullptr;
 								}
 							}
 						};
@@ -888,7 +912,7 @@ namespace GX
 								if (_node != nullptr)
 								{
 									auto& _keys = _node->getPositionKeys();
-									_keys.push_back(TimeVector3(data->intData[1][nullptr], glm::vec3(0.0f)));
+									insertKey(_keys, TimeVector3(data->intData[1][nullptr], glm::vec3(0.0f)));
 
 									selFramePos = nullptr;
 									selFrameRot = nullptr;
@@ -912,7 +936,7 @@ namespace GX
 						auto it = std::find_if(keys.begin(), keys.end(), [=](TimeVector3& v) -> bool { return v.time == currentFrame; });
 
 						if (it == keys.end())
-							keys.push_back(TimeVector3(currentFrame, glm::vec3(0.0f)));
+							insertKey(keys, TimeVector3(currentFrame, glm::vec3(0.0f)));
 
 						if (openedAnimation->getDuration() < currentFrame + 1)
 							openedAnimation->setDuration(currentFrame + 1);
@@ -999,7 +1023,10 @@ namespace GX
 											int _t = (int)((ImGui::GetMousePos().x - ImGui::GetCursorScreenPos().x + (segW * 0.5f)) / segW);
 											auto it = std::find_if(keys.begin(), keys.end(), [=](TimeVector3& v) -> bool { return v.time == _t; });
 											if (it == keys.end())
-												dragFramePos->time = _t;
+											{
+												dragFramePos = moveKey(keys, dragFramePos, _t);
+												selFramePos = dragFramePos;
+											}
 										}
 									}
 									//}
@@ -1035,8 +1062,13 @@ namespace GX
 											if (_node != nullptr)
 											{
 												auto& _keys = _node->getPositionKeys();
-												TimeVector3& _key = _keys[data->intData[1][nullptr]];
-												_key.time = data->intData[2][nullptr];
+												auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeVector3& v) -> bool { return v.time == data->intData[3][nullptr]; });
+												if (it != _keys.end())
+													moveKey(_keys, &*it, data->intData[2][nullptr]);
+
+												selFramePos = nullptr;
+												selFrameRot = nullptr;
+												selFrameScl = nullptr;
 											}
 										}
 									};
@@ -1051,8 +1083,13 @@ namespace GX
 											if (_node != nullptr)
 											{
 												auto& _keys = _node->getPositionKeys();
-												TimeVector3& _key = _keys[data->intData[1][nullptr]];
-												_key.time = data->intData[3][nullptr];
+												auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeVector3& v) -> bool { return v.time == data->intData[2][nullptr]; });
+												if (it != _keys.end())
+													moveKey(_keys, &*it, data->intData[3][nullptr]);
+
+												selFramePos = nullptr;
+												selFrameRot = nullptr;
+												selFrameScl = nullptr;
 											}
 										}
 									};
@@ -1136,7 +1173,13 @@ namespace GX
 								if (_node != nullptr)
 								{
 									auto& _keys = _node->getRotationKeys();
-									_keys.erase(_keys.begin() + (_keys.size() - 1));
+									auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeQuaternion& v) -> bool { return v.time == data->intData[1][nullptr]; });
+									if (it != _keys.end())
+										_keys.erase(it);
+
+									selFramePos = nullptr;
+									selFrameRot = nullptr;
+									selFrameScl = nullptr;
 								}
 							}
 						};
@@ -1151,7 +1194,7 @@ namespace GX
 								if (_node != nullptr)
 								{
 									auto& _keys = _node->getRotationKeys();
-									_keys.push_back(TimeQuaternion(data->intData[1][nullptr], glm::identity<glm::quat>()));
+									insertKey(_keys, TimeQuaternion(data->intData[1][nullptr], glm::identity<glm::quat>()));
 
 									selFramePos = nullptr;
 									selFrameRot = nullptr;
@@ -1175,7 +1218,7 @@ namespace GX
 						auto it = std::find_if(keys.begin(), keys.end(), [=](TimeQuaternion& v) -> bool { return v.time == currentFrame; });
 
 						if (it == keys.end())
-							keys.push_back(TimeQuaternion(currentFrame, glm::identity<glm::quat>()));
+							insertKey(keys, TimeQuaternion(currentFrame, glm::identity<glm::quat>()));
 
 						if (openedAnimation->getDuration() < currentFrame + 1)
 							openedAnimation->setDuration(currentFrame + 1);
@@ -1262,7 +1305,10 @@ namespace GX
 											int _t = (int)((ImGui::GetMousePos().x - ImGui::GetCursorScreenPos().x + (segW * 0.5f)) / segW);
 											auto it = std::find_if(keys.begin(), keys.end(), [=](TimeQuaternion& v) -> bool { return v.time == _t; });
 											if (it == keys.end())
-												dragFrameRot->time = _t;
+											{
+												dragFrameRot = moveKey(keys, dragFrameRot, _t);
+												selFrameRot = dragFrameRot;
+											}
 										}
 									}
 									//}
@@ -1298,8 +1344,13 @@ namespace GX
 											if (_node != nullptr)
 											{
 												auto& _keys = _node->getRotationKeys();
-												TimeQuaternion& _key = _keys[data->intData[1][nullptr]];
-												_key.time = data->intData[2][nullptr];
+												auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeQuaternion& v) -> bool { return v.time == data->intData[3][nullptr]; });
+												if (it != _keys.end())
+													moveKey(_keys, &*it, data->intData[2][nullptr]);
+
+												selFramePos = nullptr;
+												selFrameRot = nullptr;
+												selFrameScl = nullptr;
 											}
 										}
 									};
@@ -1314,8 +1365,13 @@ namespace GX
 											if (_node != nullptr)
 											{
 												auto& _keys = _node->getRotationKeys();
-												TimeQuaternion& _key = _keys[data->intData[1][nullptr]];
-												_key.time = data->intData[3][nullptr];
+												auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeQuaternion& v) -> bool { return v.time == data->intData[2][nullptr]; });
+												if (it != _keys.end())
+													moveKey(_keys, &*it, data->intData[3][nullptr]);
+
+												selFramePos = nullptr;
+												selFrameRot = nullptr;
+												selFrameScl = nullptr;
 											}
 										}
 									};
@@ -1399,7 +1455,13 @@ namespace GX
 								if (_node != nullptr)
 								{
 									auto& _keys = _node->getScalingKeys();
-									_keys.erase(_keys.begin() + (_keys.size() - 1));
+									auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeVector3& v) -> bool { return v.time == data->intData[1][nullptr]; });
+									if (it != _keys.end())
+										_keys.erase(it);
+
+									selFramePos = nullptr;
+									selFrameRot = nullptr;
+									selFrameScl = nullptr;
 								}
 							}
 						};
@@ -1414,7 +1476,7 @@ namespace GX
 								if (_node != nullptr)
 								{
 									auto& _keys = _node->getScalingKeys();
-									_keys.push_back(TimeVector3(data->intData[1][nullptr], glm::vec3(1.0f)));
+									insertKey(_keys, TimeVector3(data->intData[1][nullptr], glm::vec3(1.0f)));
 
 									selFramePos = nullptr;
 									selFrameRot = nullptr;
@@ -1438,7 +1500,7 @@ namespace GX
 						auto it = std::find_if(keys.begin(), keys.end(), [=](TimeVector3& v) -> bool { return v.time == currentFrame; });
 
 						if (it == keys.end())
-							keys.push_back(TimeVector3(currentFrame, glm::vec3(1.0f)));
+							insertKey(keys, TimeVector3(currentFrame, glm::vec3(1.0f)));
 
 						if (openedAnimation->getDuration() < currentFrame + 1)
 							openedAnimation->setDuration(currentFrame + 1);
@@ -1525,7 +1587,10 @@ namespace GX
 											int _t = (int)((ImGui::GetMousePos().x - ImGui::GetCursorScreenPos().x + (segW * 0.5f)) / segW);
 											auto it = std::find_if(keys.begin(), keys.end(), [=](TimeVector3& v) -> bool { return v.time == _t; });
 											if (it == keys.end())
-												dragFrameScl->time = _t;
+											{
+												dragFrameScl = moveKey(keys, dragFrameScl, _t);
+												selFrameScl = dragFrameScl;
+											}
 										}
 									}
 									//}
@@ -1561,8 +1626,13 @@ namespace GX
 											if (_node != nullptr)
 											{
 												auto& _keys = _node->getScalingKeys();
-												TimeVector3& _key = _keys[data->intData[1][nullptr]];
-												_key.time = data->intData[2][nullptr];
+												auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeVector3& v) -> bool { return v.time == data->intData[3][nullptr]; });
+												if (it != _keys.end())
+													moveKey(_keys, &*it, data->intData[2][nullptr]);
+
+												selFramePos = nullptr;
+												selFrameRot = nullptr;
+												selFrameScl = nullptr;
 											}
 										}
 									};
@@ -1577,8 +1647,13 @@ namespace GX
 											if (_node != nullptr)
 											{
 												auto& _keys = _node->getScalingKeys();
-												TimeVector3& _key = _keys[data->intData[1][nullptr]];
-												_key.time = data->intData[3][nullptr];
+												auto it = std::find_if(_keys.begin(), _keys.end(), [=](TimeVector3& v) -> bool { return v.time == data->intData[2][nullptr]; });
+												if (it != _keys.end())
+													moveKey(_keys, &*it, data->intData[3][nullptr]);
+
+												selFramePos = nullptr;
+												selFrameRot = nullptr;
+												selFrameScl = nullptr;
 											}
 										}
 									};
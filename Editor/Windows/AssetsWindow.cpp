@@ -906,7 +906,15 @@ namespace GX
 					TreeNode* n = singleton->treeView->getNodeByName(it);
 					if (n != nullptr)
 					{
-						Texture* texture = Texture::load(Engine::getSingleton()->getAssetsPath(), n->getPath(), true, Texture::CompressionMethod::Default);
+						//Do not block on a texture that is being reimported, the editor shows its progress
+						Texture* texture = (Texture*)Asset::getLoadedInstance(Engine::getSingleton()->getAssetsPath(), n->getPath());
+						if (texture != nullptr && texture->isImporting())
+						{
+							textures.push_back(texture);
+							continue;
+						}
+
+						texture = Texture::load(Engine::getSingleton()->getAssetsPath(), n->getPath(), true, Texture::CompressionMethod::Default);
 						if (texture != nullptr && texture->isLoaded())
 							textures.push_back(texture);
 					}
@@ -43,6 +43,7 @@
 #include "../Engine/Core/Engine.h"
 #include "../Engine/Core/APIManager.h"
 #include "../Engine/Core/Debug.h"
+#include "../Engine/Core/AsyncLoader.h"
 #include "../Engine/Core/Time.h"
 #include "../Engine/Classes/Helpers.h"
 #include "../Engine/Classes/IO.h"
@@ -546,6 +547,8 @@ namespace GX
 			}
 		}
 
+		updateImportQueue();
+
 		Toast::update();
 
 		ImGui::PopFont();
@@ -1125,6 +1128,57 @@ namespace GX
 		}
 	}
 
+	void MainWindow::updateImportQueue()
+	{
+		std::vector<Texture*> textures;
+
+		for (auto& asset : AsyncLoader::getSingleton()->getPendingAssets())
+		{
+			if (asset->getAssetType() == Texture::ASSET_TYPE && ((Texture*)asset)->isImporting())
+				textures.push_back((Texture*)asset);
+		}
+
+		if (textures.empty())
+			return;
+
+		int _w = Renderer::getSingleton()->getWidth();
+		int _h = Renderer::getSingleton()->getHeight();
+		float sw = 320;
+
+		ImGui::SetNextWindowPos(ImVec2(_w - sw - 10, _h - 10), ImGuiCond_Always, ImVec2(0, 1));
+		ImGui::SetNextWindowSize(ImVec2(sw, 0));
+		ImGui::SetNextWindowBgAlpha(0.9f);
+		ImGui::Begin("Importing textures", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoSavedSettings);
+
+		Texture* cancelTexture = nullptr;
+
+		for (auto& texture : textures)
+		{
+			ImGui::PushID(texture);
+			ImGui::Text("%s", IO::GetFileNameWithExt(texture->getName()).c_str());
+			ImGui::ProgressBar(texture->getImportProgress(), ImVec2(sw - 80, 0));
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel"))
+				cancelTexture = texture;
+			ImGui::PopID();
+		}
+
+		if (textures.size() > 1)
+		{
+			if (ImGui::Button("Cancel all"))
+			{
+				for (auto& texture : textures)
+					AsyncLoader::getSingleton()->cancel(texture);
+			}
+		}
+
+		ImGui::End();
+
+		//Texture stays unloaded with no cache, the next reload imports it again
+		if (cancelTexture != nullptr)
+			AsyncLoader::getSingleton()->cancel(cancelTexture);
+	}
+
 	void MainWindow::updateMainToolbar()
 	{
 		bool open = true;
@@ -86,6 +86,7 @@ namespace GX
 
 		static void updateMainMenu();
 		static void updateMainToolbar();
+		static void updateImportQueue();
 
 		void loadLastScene();
 		void saveLastScene();
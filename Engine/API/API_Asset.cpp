@@ -21,4 +21,26 @@ namespace GX
 
 		return nullptr;
 	}
+
+	bool API_Asset::getIsLoaded(MonoObject* this_ptr)
+	{
+		Asset* asset = nullptr;
+		mono_field_get_value(this_ptr, APIManager::getSingleton()->asset_ptr_field, reinterpret_cast<void*>(&asset));
+
+		if (asset != nullptr)
+			return asset->isLoaded();
+
+		return false;
+	}
+
+	bool API_Asset::getIsLoading(MonoObject* this_ptr)
+	{
+		Asset* asset = nullptr;
+		mono_field_get_value(this_ptr, APIManager::getSingleton()->asset_ptr_field, reinterpret_cast<void*>(&asset));
+
+		if (asset != nullptr)
+			return asset->isLoading();
+
+		return false;
+	}
 }
\ No newline at end of file
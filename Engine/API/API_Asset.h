@@ -10,8 +10,12 @@ namespace GX
 		static void Register()
 		{
 			mono_add_internal_call("FalcoEngine.Asset::get_name", (void*)getName);
+			mono_add_internal_call("FalcoEngine.Asset::get_isLoaded", (void*)getIsLoaded);
+			mono_add_internal_call("FalcoEngine.Asset::get_isLoading", (void*)getIsLoading);
 		}
 
 		static MonoString* getName(MonoObject* this_ptr);
+		static bool getIsLoaded(MonoObject* this_ptr);
+		static bool getIsLoading(MonoObject* this_ptr);
 	};
 }
\ No newline at end of file
@@ -137,7 +137,7 @@ namespace GX
 
 		AxisAlignedBox aab = AxisAlignedBox::Extent::EXTENT_INFINITE;
 
-		MeshRenderer* rend = (MeshRenderer*)object->getComponent(MeshRenderer::COMPONENT_TYPE);
+		MeshRenderer* rend = object->getComponent<MeshRenderer>();
 		if (rend != nullptr)
 		{
 			aab = rend->getBounds();
@@ -145,7 +145,7 @@ namespace GX
 
 		if (aab.isInfinite())
 		{
-			ParticleSystem* rend2 = (ParticleSystem*)object->getComponent(ParticleSystem::COMPONENT_TYPE);
+			ParticleSystem* rend2 = object->getComponent<ParticleSystem>();
 			if (rend2 != nullptr)
 			{
 				for (auto& em : rend2->getEmitters())
@@ -155,7 +155,7 @@ namespace GX
 
 		if (aab.isInfinite())
 		{
-			Water* rend3 = (Water*)object->getComponent(Water::COMPONENT_TYPE);
+			Water* rend3 = object->getComponent<Water>();
 			if (rend3 != nullptr)
 			{
 				aab = rend3->getBounds();
@@ -164,7 +164,7 @@ namespace GX
 
 		if (aab.isInfinite())
 		{
-			Terrain* rend4 = (Terrain*)object->getComponent(Terrain::COMPONENT_TYPE);
+			Terrain* rend4 = object->getComponent<Terrain>();
 			if (rend4 != nullptr)
 				aab = rend4->getBounds();
 		}
@@ -193,7 +193,7 @@ namespace GX
 
 		if (node != nullptr)
 		{
-			RigidBody* body = ((RigidBody*)node->getComponent(RigidBody::COMPONENT_TYPE));
+			RigidBody* body = node->getComponent<RigidBody>();
 			if (body != nullptr)
 				return body->getManagedObject();
 		}
@@ -208,7 +208,7 @@ namespace GX
 
 		if (node != nullptr)
 		{
-			Animation* animList = ((Animation*)node->getComponent(Animation::COMPONENT_TYPE));
+			Animation* animList = node->getComponent<Animation>();
 			if (animList != nullptr)
 				return animList->getManagedObject();
 		}
@@ -223,7 +223,7 @@ namespace GX
 
 		if (node != nullptr)
 		{
-			AudioSource* audio = ((AudioSource*)node->getComponent(AudioSource::COMPONENT_TYPE));
+			AudioSource* audio = node->getComponent<AudioSource>();
 			if (audio != nullptr)
 				return audio->getManagedObject();
 		}
@@ -238,7 +238,7 @@ namespace GX
 
 		if (node != nullptr)
 		{
-			NavMeshAgent* agent = ((NavMeshAgent*)node->getComponent(NavMeshAgent::COMPONENT_TYPE));
+			NavMeshAgent* agent = node->getComponent<NavMeshAgent>();
 			if (agent != nullptr)
 				return agent->getManagedObject();
 		}
@@ -370,7 +370,7 @@ namespace GX
 
 		if (_className == "Animation")
 		{
-			Component* _comp = node->getComponent(Animation::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Animation>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -386,7 +386,7 @@ namespace GX
 
 		if (_className == "AudioListener")
 		{
-			Component* _comp = node->getComponent(AudioListener::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<AudioListener>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -410,7 +410,7 @@ namespace GX
 
 		if (_className == "NavMeshAgent")
 		{
-			Component* _comp = node->getComponent(NavMeshAgent::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<NavMeshAgent>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -434,7 +434,7 @@ namespace GX
 
 		if (_className == "Spline")
 		{
-			Component* _comp = node->getComponent(Spline::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Spline>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -474,7 +474,7 @@ namespace GX
 
 		if (_className == "MeshCollider")
 		{
-			Component* _comp = node->getComponent(MeshCollider::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<MeshCollider>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -490,7 +490,7 @@ namespace GX
 
 		if (_className == "TerrainCollider")
 		{
-			Component* _comp = node->getComponent(TerrainCollider::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<TerrainCollider>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -506,7 +506,7 @@ namespace GX
 
 		if (_className == "ConeTwistJoint")
 		{
-			Component* _comp = node->getComponent(ConeTwistJoint::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<ConeTwistJoint>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -522,7 +522,7 @@ namespace GX
 
 		if (_className == "FixedJoint")
 		{
-			Component* _comp = node->getComponent(FixedJoint::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<FixedJoint>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -538,7 +538,7 @@ namespace GX
 
 		if (_className == "FreeJoint")
 		{
-			Component* _comp = node->getComponent(FreeJoint::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<FreeJoint>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -554,7 +554,7 @@ namespace GX
 
 		if (_className == "HingeJoint")
 		{
-			Component* _comp = node->getComponent(HingeJoint::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<HingeJoint>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -570,7 +570,7 @@ namespace GX
 
 		if (_className == "Rigidbody")
 		{
-			Component* _comp = node->getComponent(RigidBody::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<RigidBody>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -586,7 +586,7 @@ namespace GX
 
 		if (_className == "Vehicle")
 		{
-			Component* _comp = node->getComponent(Vehicle::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Vehicle>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -602,7 +602,7 @@ namespace GX
 
 		if (_className == "Camera")
 		{
-			Component* _comp = node->getComponent(Camera::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Camera>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -618,7 +618,7 @@ namespace GX
 
 		if (_className == "Light")
 		{
-			Component* _comp = node->getComponent(Light::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Light>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -634,7 +634,7 @@ namespace GX
 
 		if (_className == "MeshRenderer")
 		{
-			Component* _comp = node->getComponent(MeshRenderer::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<MeshRenderer>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -650,7 +650,7 @@ namespace GX
 
 		if (_className == "ParticleSystem")
 		{
-			Component* _comp = node->getComponent(ParticleSystem::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<ParticleSystem>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -666,7 +666,7 @@ namespace GX
 
 		if (_className == "Terrain")
 		{
-			Component* _comp = node->getComponent(Terrain::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Terrain>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -682,7 +682,7 @@ namespace GX
 
 		if (_className == "Water")
 		{
-			Component* _comp = node->getComponent(Water::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Water>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -698,7 +698,7 @@ namespace GX
 
 		if (_className == "Button")
 		{
-			Component* _comp = node->getComponent(Button::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Button>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -714,7 +714,7 @@ namespace GX
 
 		if (_className == "Canvas")
 		{
-			Component* _comp = node->getComponent(Canvas::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Canvas>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -730,7 +730,7 @@ namespace GX
 
 		if (_className == "Image")
 		{
-			Component* _comp = node->getComponent(Image::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Image>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -746,7 +746,7 @@ namespace GX
 
 		if (_className == "Mask")
 		{
-			Component* _comp = node->getComponent(Mask::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Mask>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -762,7 +762,7 @@ namespace GX
 
 		if (_className == "Text")
 		{
-			Component* _comp = node->getComponent(Text::COMPONENT_TYPE);
+			Component* _comp = node->getComponent<Text>();
 			if (_comp != nullptr)
 			{
 				component = _comp;
@@ -74,7 +74,7 @@ namespace GX
 		if (node != nullptr)
 		{
 			GameObject* obj = node->getGameObject();
-			RigidBody* body = (RigidBody*)obj->getComponent(RigidBody::COMPONENT_TYPE);
+			RigidBody* body = obj->getComponent<RigidBody>();
 
 			if (body != nullptr)
 				return body->getManagedObject();
@@ -105,7 +105,7 @@ namespace GX
 		if (node != nullptr)
 		{
 			GameObject* obj = node->getGameObject();
-			Animation* animList = ((Animation*)obj->getComponent(Animation::COMPONENT_TYPE));
+			Animation* animList = obj->getComponent<Animation>();
 			if (animList != nullptr)
 				return animList->getManagedObject();
 		}
@@ -121,7 +121,7 @@ namespace GX
 		if (node != nullptr)
 		{
 			GameObject* obj = node->getGameObject();
-			AudioSource* audio = ((AudioSource*)obj->getComponent(AudioSource::COMPONENT_TYPE));
+			AudioSource* audio = obj->getComponent<AudioSource>();
 			
 			if (audio != nullptr)
 				return audio->getManagedObject();
@@ -138,7 +138,7 @@ namespace GX
 		if (node != nullptr)
 		{
 			GameObject* obj = node->getGameObject();
-			NavMeshAgent* agent = ((NavMeshAgent*)obj->getComponent(NavMeshAgent::COMPONENT_TYPE));
+			NavMeshAgent* agent = obj->getComponent<NavMeshAgent>();
 			
 			if (agent != nullptr)
 				return agent->getManagedObject();
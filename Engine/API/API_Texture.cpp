@@ -22,6 +22,19 @@ namespace GX
 		return nullptr;
 	}
 
+	MonoObject* API_Texture::loadAsync(MonoString* path)
+	{
+		std::string _path = (const char*)mono_string_to_utf8((MonoString*)path);
+		_path = CP_SYS(_path);
+
+		Texture* texture = Texture::loadAsync(Engine::getSingleton()->getAssetsPath(), _path);
+
+		if (texture != nullptr)
+			return texture->getManagedObject();
+
+		return nullptr;
+	}
+
 	int API_Texture::getWidth(MonoObject * this_ptr)
 	{
 		Texture* asset = nullptr;
@@ -10,6 +10,7 @@ namespace GX
 		static void Register()
 		{
 			mono_add_internal_call("FalcoEngine.Texture::INTERNAL_load", (void*)load);
+			mono_add_internal_call("FalcoEngine.Texture::INTERNAL_loadAsync", (void*)loadAsync);
 			mono_add_internal_call("FalcoEngine.Texture::get_width", (void*)getWidth);
 			mono_add_internal_call("FalcoEngine.Texture::get_height", (void*)getHeight);
 			mono_add_internal_call("FalcoEngine.Texture::INTERNAL_fromBytesRGBA8", (void*)fromBytesRGBA8);
@@ -17,6 +18,7 @@ namespace GX
 
 	private:
 		static MonoObject* load(MonoString* path);
+		static MonoObject* loadAsync(MonoString* path);
 		static int getWidth(MonoObject * this_ptr);
 		static int getHeight(MonoObject * this_ptr);
 		static MonoObject* fromBytesRGBA8(MonoArray* data, int width, int height);
@@ -1,6 +1,7 @@
 #include "AnimationClip.h"
 
 #include <iostream>
+#include <algorithm>
 #include <cassert>
 #include <fstream>
 #include <boost/iostreams/stream.hpp>
@@ -20,6 +21,13 @@
 namespace GX
 {
     std::string AnimationClip::ASSET_TYPE = "AnimationClip";
+    bool AnimationClip::compressOnLoad = false;
+
+    //Longest run of keys replaced by one interpolated segment. Keeps key reduction linear
+    static const size_t MAX_REDUCED_KEYS = 64;
+
+    //Vector tracks with a smaller range are stored as constants
+    static const float CONSTANT_TRACK_EPSILON = 0.00001f;
 
     AnimationClipNode::~AnimationClipNode()
     {
@@ -36,6 +44,259 @@ namespace GX
         nameHash = Hash::getHash(name);
     }
 
+    //Greedy reduction. A key is dropped while the segment from the last kept key reproduces all skipped keys
+    template<typename T, typename Interpolate, typename Distance>
+    static void reduceTrack(std::vector<T>& keys, float maxError, Interpolate interpolate, Distance distance)
+    {
+        if (keys.size() < 3)
+            return;
+
+        std::vector<T> result;
+        result.push_back(keys[0]);
+
+        size_t anchor = 0;
+        for (size_t i = 2; i < keys.size(); ++i)
+        {
+            bool fits = i - anchor <= MAX_REDUCED_KEYS;
+            double span = keys[i].time - keys[anchor].time;
+
+            for (size_t j = anchor + 1; j < i && fits; ++j)
+            {
+                float t = span > 0.0 ? (float)((keys[j].time - keys[anchor].time) / span) : 0.0f;
+                fits = distance(interpolate(keys[anchor].value, keys[i].value, t), keys[j].value) <= maxError;
+            }
+
+            if (!fits)
+            {
+                anchor = i - 1;
+                result.push_back(keys[anchor]);
+            }
+        }
+
+        result.push_back(keys.back());
+        keys = result;
+    }
+
+    static float vectorDistance(const glm::vec3& a, const glm::vec3& b)
+    {
+        return glm::distance(a, b);
+    }
+
+    //Angle between rotations. Stays precise for small angles, unlike acos of the dot product
+    static float rotationDistance(const glm::highp_quat& a, const glm::highp_quat& b)
+    {
+        glm::vec4 va = glm::vec4(a.x, a.y, a.z, a.w);
+        glm::vec4 vb = glm::vec4(b.x, b.y, b.z, b.w);
+
+        if (glm::dot(va, vb) < 0.0f)
+            vb = -vb;
+
+        return 2.0f * atan2(glm::length(va - vb), glm::length(va + vb));
+    }
+
+    void AnimationClipNode::sortKeys()
+    {
+        auto byTime = [](const auto& a, const auto& b) -> bool { return a.time < b.time; };
+
+        std::stable_sort(positionKeys.begin(), positionKeys.end(), byTime);
+        std::stable_sort(scalingKeys.begin(), scalingKeys.end(), byTime);
+        std::stable_sort(rotationKeys.begin(), rotationKeys.end(), byTime);
+    }
+
+    void AnimationClipNode::reduceKeys(float positionError, float rotationError, float scaleError)
+    {
+        if (compressed)
+            return;
+
+        auto lerp = [](const glm::vec3& a, const glm::vec3& b, float t) -> glm::vec3 { return Mathf::lerp(a, b, t); };
+        auto slerp = [](const glm::highp_quat& a, const glm::highp_quat& b, float t) -> glm::highp_quat { return glm::slerp(a, b, t); };
+
+        reduceTrack(positionKeys, positionError, lerp, vectorDistance);
+        reduceTrack(scalingKeys, scaleError, lerp, vectorDistance);
+        reduceTrack(rotationKeys, rotationError, slerp, rotationDistance);
+    }
+
+    void AnimationClipNode::compress()
+    {
+        if (compressed)
+            return;
+
+        float duration = parent != nullptr ? parent->getDuration() : 0.0f;
+
+        compressedPositions.compress(positionKeys, duration);
+        compressedScalings.compress(scalingKeys, duration);
+        compressedRotations.compress(rotationKeys, duration);
+
+        std::vector<TimeVector3>().swap(positionKeys);
+        std::vector<TimeVector3>().swap(scalingKeys);
+        std::vector<TimeQuaternion>().swap(rotationKeys);
+
+        compressed = true;
+    }
+
+    size_t AnimationClipNode::getMemorySize()
+    {
+        size_t size = positionKeys.capacity() * sizeof(TimeVector3)
+            + scalingKeys.capacity() * sizeof(TimeVector3)
+            + rotationKeys.capacity() * sizeof(TimeQuaternion);
+
+        size += compressedPositions.getMemorySize()
+            + compressedScalings.getMemorySize()
+            + compressedRotations.getMemorySize();
+
+        return size;
+    }
+
+    //CompressedTrack
+
+    static const float SQRT_2 = 1.41421356f;
+
+    //Three smallest components fit into [-1/sqrt(2), 1/sqrt(2)] and are stored with 15 bits.
+    //Index of the largest one takes the top bits of the first two values
+    static void packQuaternion(glm::highp_quat q, uint16_t* out)
+    {
+        q = glm::normalize(q);
+
+        float c[4] = { q.x, q.y, q.z, q.w };
+
+        int largest = 0;
+        for (int i = 1; i < 4; ++i)
+        {
+            if (std::abs(c[i]) > std::abs(c[largest]))
+                largest = i;
+        }
+
+        //q and -q are the same rotation, so the largest component is always positive
+        float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+
+        int n = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            float f = (c[i] * sign * SQRT_2 + 1.0f) * 0.5f;
+            out[n++] = (uint16_t)std::round(std::min(std::max(f, 0.0f), 1.0f) * 32767.0f);
+        }
+
+        out[0] |= (uint16_t)((largest & 1) << 15);
+        out[1] |= (uint16_t)((largest >> 1) << 15);
+    }
+
+    static glm::highp_quat unpackQuaternion(const uint16_t* v)
+    {
+        int largest = (v[0] >> 15) | ((v[1] >> 15) << 1);
+
+        float c[4];
+        float sum = 0.0f;
+
+        int n = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+                continue;
+
+            float f = (float)(v[n++] & 0x7FFF) / 32767.0f;
+            c[i] = (f * 2.0f - 1.0f) / SQRT_2;
+            sum += c[i] * c[i];
+        }
+
+        c[largest] = sqrt(std::max(1.0f - sum, 0.0f));
+
+        return glm::highp_quat(c[3], c[0], c[1], c[2]);
+    }
+
+    void CompressedTrack::clear()
+    {
+        std::vector<float>().swap(times);
+        std::vector<uint16_t>().swap(values);
+
+        rangeMin = glm::vec3(0.0f);
+        rangeSize = glm::vec3(0.0f);
+    }
+
+    void CompressedTrack::compress(std::vector<TimeVector3>& keys, float duration)
+    {
+        clear();
+
+        if (keys.empty())
+            return;
+
+        glm::vec3 vmin = keys[0].value;
+        glm::vec3 vmax = keys[0].value;
+
+        for (auto& key : keys)
+        {
+            vmin = glm::min(vmin, key.value);
+            vmax = glm::max(vmax, key.value);
+        }
+
+        rangeMin = vmin;
+        rangeSize = vmax - vmin;
+
+        //Same value over the whole clip
+        bool coversClip = keys.front().time <= 0.0 && keys.back().time >= duration - 1.0f;
+        if (coversClip && std::max(rangeSize.x, std::max(rangeSize.y, rangeSize.z)) < CONSTANT_TRACK_EPSILON)
+        {
+            rangeSize = glm::vec3(0.0f);
+            values.resize(3, 0);
+            return;
+        }
+
+        times.reserve(keys.size());
+        values.reserve(keys.size() * 3);
+
+        for (auto& key : keys)
+        {
+            times.push_back((float)key.time);
+
+            for (int c = 0; c < 3; ++c)
+            {
+                float f = rangeSize[c] > 0.0f ? (key.value[c] - rangeMin[c]) / rangeSize[c] : 0.0f;
+                values.push_back((uint16_t)std::round(std::min(std::max(f, 0.0f), 1.0f) * 65535.0f));
+            }
+        }
+    }
+
+    void CompressedTrack::compress(std::vector<TimeQuaternion>& keys, float duration)
+    {
+        clear();
+
+        if (keys.empty())
+            return;
+
+        bool constant = keys.front().time <= 0.0 && keys.back().time >= duration - 1.0f;
+        for (size_t i = 1; i < keys.size() && constant; ++i)
+            constant = rotationDistance(keys[0].value, keys[i].value) < CONSTANT_TRACK_EPSILON;
+
+        if (constant)
+        {
+            values.resize(3);
+            packQuaternion(keys[0].value, &values[0]);
+            return;
+        }
+
+        times.reserve(keys.size());
+        values.resize(keys.size() * 3);
+
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            times.push_back((float)keys[i].time);
+            packQuaternion(keys[i].value, &values[i * 3]);
+        }
+    }
+
+    glm::vec3 CompressedTrack::getVector(size_t key)
+    {
+        const uint16_t* v = &values[key * 3];
+        return rangeMin + glm::vec3(v[0], v[1], v[2]) / 65535.0f * rangeSize;
+    }
+
+    glm::highp_quat CompressedTrack::getQuaternion(size_t key)
+    {
+        return unpackQuaternion(&values[key * 3]);
+    }
+
     AnimationClip::AnimationClip() : Asset(APIManager::getSingleton()->animationclip_class)
     {
     }
@@ -111,6 +372,15 @@ namespace GX
 
     void AnimationClip::save(std::string path)
     {
+        for (auto& node : animationClipNodes)
+        {
+            if (node->isCompressed())
+            {
+                Debug::logWarning("[" + name + "] Compressed animation clip can not be saved");
+                return;
+            }
+        }
+
         SAnimationClip sAnimClip;
         sAnimClip.duration = duration;
         sAnimClip.framesPerSecond = framesPerSecond;
@@ -155,6 +425,7 @@ namespace GX
     {
         value->parent = this;
         animationClipNodes.push_back(value);
+        ++nodesVersion;
     }
 
     void AnimationClip::deleteAnimationClipNode(AnimationClipNode* value)
@@ -165,6 +436,7 @@ namespace GX
             animationClipNodes.erase(it);
             delete value;
             value = nullptr;
+            ++nodesVersion;
         }
     }
 
@@ -268,9 +540,15 @@ namespace GX
             for (auto kt = sAnimClipNode.rotationKeys.begin(); kt != sAnimClipNode.rotationKeys.end(); ++kt)
                 animClipNode->addRotationKey(kt->time, kt->value.getValue());
 
+            //Keys were saved in edit order by older editor versions
+            animClipNode->sortKeys();
+
             animClip->addAnimationClipNode(animClipNode);
         }
 
+        if (compressOnLoad)
+            animClip->compress();
+
         animClip->load();
 
         sAnimClip.animationNodes.clear();
@@ -278,12 +556,34 @@ namespace GX
         return animClip;
     }
 
+    //Copies keys between start and end shifted to start. Keys may be sparse, so values at both ends are sampled
+    template<typename T, typename V>
+    static void cropKeys(const std::vector<T>& keys, std::vector<T>& out, float start, float end, V startValue, V endValue)
+    {
+        if (keys.empty() || end < start)
+            return;
+
+        out.push_back(T(0, startValue));
+
+        for (auto& key : keys)
+        {
+            if (key.time > start && key.time < end)
+                out.push_back(T(key.time - start, key.value));
+        }
+
+        if (end > start)
+            out.push_back(T(end - start, endValue));
+    }
+
     AnimationClip* AnimationClip::crop(int startFrame, int endFrame, std::string name)
     {
         AnimationClip* animClip = AnimationClip::create(getLocation(), name);
         animClip->setDuration(endFrame - startFrame);
         animClip->setFramesPerSecond(framesPerSecond);
 
+        float start = (float)std::max(startFrame, 0);
+        float end = (float)std::min(endFrame, (int)duration) - 1.0f;
+
         for (auto it = animationClipNodes.begin(); it != animationClipNodes.end(); ++it)
         {
             AnimationClipNode* clipNode = *it;
@@ -291,40 +591,45 @@ namespace GX
 
             newClipNode->setName(clipNode->getName());
 
-            int start = startFrame;
-            int end = endFrame;
+            glm::vec3 startPos = glm::vec3(0.0f);
+            glm::vec3 endPos = glm::vec3(0.0f);
+            glm::highp_quat startRot = glm::identity<glm::highp_quat>();
+            glm::highp_quat endRot = glm::identity<glm::highp_quat>();
+            glm::vec3 startScale = glm::vec3(1.0f);
+            glm::vec3 endScale = glm::vec3(1.0f);
 
-            if (start < 0)
-                start = 0;
+            clipNode->sample(start, startPos, startRot, startScale);
+            clipNode->sample(end, endPos, endRot, endScale);
 
-            if (end > clipNode->getPositionKeys().size())
-                end = clipNode->getPositionKeys().size();
+            cropKeys(clipNode->positionKeys, newClipNode->positionKeys, start, end, startPos, endPos);
+            cropKeys(clipNode->scalingKeys, newClipNode->scalingKeys, start, end, startScale, endScale);
+            cropKeys(clipNode->rotationKeys, newClipNode->rotationKeys, start, end, startRot, endRot);
 
-            if (start > end)
-                start = end;
+            animClip->addAnimationClipNode(newClipNode);
+        }
 
-            for (int k = start; k < end; ++k)
-            {
-                TimeVector3& val = clipNode->getPositionKeys()[k];
-                newClipNode->addPositionKey(val.time - start, val.value);
-            }
+        return animClip;
+    }
 
-            for (int k = start; k < end; ++k)
-            {
-                TimeVector3& val = clipNode->getScalingKeys()[k];
-                newClipNode->addScalingKey(val.time - start, val.value);
-            }
+    void AnimationClip::reduceKeys(float positionError, float rotationError, float scaleError)
+    {
+        for (auto& node : animationClipNodes)
+            node->reduceKeys(positionError, rotationError, scaleError);
+    }
 
-            for (int k = start; k < end; ++k)
-            {
-                TimeQuaternion& val = clipNode->getRotationKeys()[k];
-                newClipNode->addRotationKey(val.time - start, val.value);
-            }
+    void AnimationClip::compress()
+    {
+        for (auto& node : animationClipNodes)
+            node->compress();
+    }
 
-            animClip->addAnimationClipNode(newClipNode);
-        }
+    size_t AnimationClip::getMemorySize()
+    {
+        size_t size = 0;
+        for (auto& node : animationClipNodes)
+            size += node->getMemorySize();
 
-        return animClip;
+        return size;
     }
 
     void AnimationClip::clear()
@@ -333,171 +638,156 @@ namespace GX
             delete* it;
 
         animationClipNodes.clear();
+        ++nodesVersion;
 
         duration = 0.0f;
         framesPerSecond = 25.0f;
     }
 
-    glm::mat4x4 AnimationClipNode::getTransformAtTime(float time, Transform* transform)
+    //Finds keys around time with a binary search. Keys are sorted by time on import.
+    //k1 or k2 is -1 where the value is blended with the current one, before the first and after the last key
+    template<typename GetTime>
+    static bool findKeyRange(int count, GetTime getTime, float time, float duration, int& k1, int& k2, float& factor)
     {
-        if (parent->getDuration() <= 0)
-            return transform->getLocalTransformMatrix();
+        if (count == 0)
+            return false;
 
-        glm::mat4x4 matrix = glm::identity<glm::mat4x4>();
-        glm::mat4x4 rotMat = glm::identity<glm::mat4x4>();
-        glm::mat4x4 invRotMat = glm::identity<glm::mat4x4>();
+        //First key after time
+        int lo = 0;
+        int hi = count;
+        while (lo < hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (time < getTime(mid))
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
 
-        //Rotation
-        glm::quat r1 = transform->getLocalRotation();
-        glm::quat r2 = transform->getLocalRotation();
+        int i = lo - 1;
 
         float t1 = 0.0f;
-        float t2 = parent->getDuration();
+        float t2 = duration;
+
+        k1 = -1;
+        k2 = -1;
 
-        if (rotationKeys.size() > 0)
+        if (i >= 0 && getTime(i) >= 0.0f)
         {
-            for (int i = rotationKeys.size() - 1; i >= 0; --i)
-            {
-                if (time >= rotationKeys[i].time)
-                {
-                    if (rotationKeys[i].time >= t1)
-                    {
-                        t1 = rotationKeys[i].time;
-                        r1 = rotationKeys[i].value;
-                    }
-                }
-            }
+            t1 = getTime(i);
+            k1 = i;
+        }
 
-            for (int i = 0; i < rotationKeys.size(); ++i)
-            {
-                if (rotationKeys[i].time > time)
-                {
-                    if (rotationKeys[i].time <= t2)
-                    {
-                        t2 = rotationKeys[i].time;
-                        r2 = rotationKeys[i].value;
-                    }
-                }
-            }
+        if (i + 1 < count && getTime(i + 1) <= duration)
+        {
+            t2 = getTime(i + 1);
+            k2 = i + 1;
         }
 
-        glm::quat r;
+        factor = 0.0f;
+
         float t = t2 - t1;
         if (t > 0)
-        {
-            float tt = time - t1;
-            t = 1.0f - ((t - tt) / t);
-            if (t < 0.0f) t = 0.0f;
-            if (t > 1.0f) t = 1.0f;
-            r = glm::slerp(r1, r2, t);
-        }
-        else
-        {
-            r = r1;
-        }
+            factor = std::min(std::max((time - t1) / t, 0.0f), 1.0f);
 
-        rotMat = glm::mat4_cast(r);
-        invRotMat = glm::inverse(rotMat);
+        return true;
+    }
 
-        //Position
-        glm::vec3 p1 = transform->getLocalPosition();
-        glm::vec3 p2 = transform->getLocalPosition();
+    template<typename T, typename V>
+    static bool findKeyPair(const std::vector<T>& keys, float time, float duration, V& v1, V& v2, float& factor)
+    {
+        int k1 = -1;
+        int k2 = -1;
 
-        t1 = 0.0f;
-        t2 = parent->getDuration();
+        if (!findKeyRange((int)keys.size(), [&](int i) -> float { return (float)keys[i].time; }, time, duration, k1, k2, factor))
+            return false;
 
-        if (positionKeys.size() > 0)
-        {
-            for (int i = positionKeys.size() - 1; i >= 0; --i)
-            {
-                if (time >= positionKeys[i].time)
-                {
-                    if (positionKeys[i].time >= t1)
-                    {
-                        t1 = positionKeys[i].time;
-                        p1 = positionKeys[i].value;
-                    }
-                }
-            }
+        if (k1 >= 0) v1 = keys[k1].value;
+        if (k2 >= 0) v2 = keys[k2].value;
 
-            for (int i = 0; i < positionKeys.size(); ++i)
-            {
-                if (positionKeys[i].time > time)
-                {
-                    if (positionKeys[i].time <= t2)
-                    {
-                        t2 = positionKeys[i].time;
-                        p2 = positionKeys[i].value;
-                    }
-                }
-            }
-        }
+        return true;
+    }
 
-        glm::vec3 p;
-        t = t2 - t1;
-        if (t > 0)
+    static bool findKeyPair(CompressedTrack& track, float time, float duration, glm::vec3& v1, glm::vec3& v2, float& factor)
+    {
+        if (track.isConstant())
         {
-            float tt = time - t1;
-            t = 1.0f - ((t - tt) / t);
-            if (t < 0.0f) t = 0.0f;
-            if (t > 1.0f) t = 1.0f;
-            p = Mathf::lerp(p1, p2, t);
+            v1 = v2 = track.getVector(0);
+            factor = 0.0f;
+            return true;
         }
-        else
-            p = p1;
-
-        matrix = glm::translate(matrix, glm::vec3(invRotMat * glm::vec4(p, 1.0f)));
-        matrix = rotMat * matrix;
 
-        //Scale
-        glm::vec3 s1 = transform->getLocalScale();
-        glm::vec3 s2 = transform->getLocalScale();
+        int k1 = -1;
+        int k2 = -1;
 
-        t1 = 0.0f;
-        t2 = parent->getDuration();
+        if (!findKeyRange((int)track.times.size(), [&](int i) -> float { return track.times[i]; }, time, duration, k1, k2, factor))
+            return false;
 
-        if (scalingKeys.size() > 0)
-        {
-            for (int i = scalingKeys.size() - 1; i >= 0; --i)
-            {
-                if (time >= scalingKeys[i].time)
-                {
-                    if (scalingKeys[i].time >= t1)
-                    {
-                        t1 = scalingKeys[i].time;
-                        s1 = scalingKeys[i].value;
-                    }
-                }
-            }
+        if (k1 >= 0) v1 = track.getVector(k1);
+        if (k2 >= 0) v2 = track.getVector(k2);
 
-            for (int i = 0; i < scalingKeys.size(); ++i)
-            {
-                if (scalingKeys[i].time > time)
-                {
-                    if (scalingKeys[i].time <= t2)
-                    {
-                        t2 = scalingKeys[i].time;
-                        s2 = scalingKeys[i].value;
-                    }
-                }
-            }
-        }
+        return true;
+    }
 
-        glm::vec3 s;
-        t = t2 - t1;
-        if (t > 0)
+    static bool findKeyPair(CompressedTrack& track, float time, float duration, glm::highp_quat& v1, glm::highp_quat& v2, float& factor)
+    {
+        if (track.isConstant())
         {
-            float tt = time - t1;
-            t = 1.0f - ((t - tt) / t);
-            if (t < 0.0f) t = 0.0f;
-            if (t > 1.0f) t = 1.0f;
-            s = Mathf::lerp(s1, s2, t);
+            v1 = v2 = track.getQuaternion(0);
+            factor = 0.0f;
+            return true;
         }
-        else
-            s = s1;
 
-        matrix = glm::scale(matrix, s);
+        int k1 = -1;
+        int k2 = -1;
+
+        if (!findKeyRange((int)track.times.size(), [&](int i) -> float { return track.times[i]; }, time, duration, k1, k2, factor))
+            return false;
+
+        if (k1 >= 0) v1 = track.getQuaternion(k1);
+        if (k2 >= 0) v2 = track.getQuaternion(k2);
+
+        return true;
+    }
+
+    void AnimationClipNode::sample(float time, glm::vec3& position, glm::highp_quat& rotation, glm::vec3& scale)
+    {
+        if (parent->getDuration() <= 0)
+            return;
+
+        float duration = parent->getDuration();
+        float t = 0.0f;
+
+        glm::highp_quat r1 = rotation;
+        glm::highp_quat r2 = rotation;
+        bool found = compressed ? findKeyPair(compressedRotations, time, duration, r1, r2, t) : findKeyPair(rotationKeys, time, duration, r1, r2, t);
+        if (found)
+            rotation = t > 0.0f ? glm::slerp(r1, r2, t) : r1;
+
+        glm::vec3 p1 = position;
+        glm::vec3 p2 = position;
+        found = compressed ? findKeyPair(compressedPositions, time, duration, p1, p2, t) : findKeyPair(positionKeys, time, duration, p1, p2, t);
+        if (found)
+            position = t > 0.0f ? Mathf::lerp(p1, p2, t) : p1;
+
+        glm::vec3 s1 = scale;
+        glm::vec3 s2 = scale;
+        found = compressed ? findKeyPair(compressedScalings, time, duration, s1, s2, t) : findKeyPair(scalingKeys, time, duration, s1, s2, t);
+        if (found)
+            scale = t > 0.0f ? Mathf::lerp(s1, s2, t) : s1;
+    }
+
+    glm::mat4x4 AnimationClipNode::getTransformAtTime(float time, Transform* transform)
+    {
+        if (parent->getDuration() <= 0)
+            return transform->getLocalTransformMatrix();
+
+        glm::vec3 position = transform->getLocalPosition();
+        glm::highp_quat rotation = transform->getLocalRotation();
+        glm::vec3 scale = transform->getLocalScale();
+
+        sample(time, position, rotation, scale);
 
-        return matrix;
+        return Transform::makeTransformMatrix(position, rotation, scale);
     }
 }
\ No newline at end of file
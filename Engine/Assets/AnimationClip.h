@@ -40,6 +40,29 @@ namespace GX
         glm::highp_quat value = glm::identity<glm::highp_quat>();
     };
 
+    //Runtime track format. Key times are floats and values are quantized to 3 x 16 bits per key.
+    //Vectors are stored within the range of their keys, rotations as the three smallest components.
+    //Constant tracks keep a single value without times
+    struct CompressedTrack
+    {
+    public:
+        std::vector<float> times;
+        std::vector<uint16_t> values;
+        glm::vec3 rangeMin = glm::vec3(0.0f);
+        glm::vec3 rangeSize = glm::vec3(0.0f);
+
+        bool isEmpty() { return values.empty(); }
+        bool isConstant() { return times.empty() && !values.empty(); }
+        size_t getMemorySize() { return times.capacity() * sizeof(float) + values.capacity() * sizeof(uint16_t); }
+
+        void compress(std::vector<TimeVector3>& keys, float duration);
+        void compress(std::vector<TimeQuaternion>& keys, float duration);
+        void clear();
+
+        glm::vec3 getVector(size_t key);
+        glm::highp_quat getQuaternion(size_t key);
+    };
+
     class AnimationClipNode
     {
         friend class AnimationClip;
@@ -51,6 +74,11 @@ namespace GX
         std::vector<TimeVector3> positionKeys;
         std::vector<TimeVector3> scalingKeys;
         std::vector<TimeQuaternion> rotationKeys;
+
+        CompressedTrack compressedPositions;
+        CompressedTrack compressedScalings;
+        CompressedTrack compressedRotations;
+        bool compressed = false;
         
         AnimationClip* parent = nullptr;
 
@@ -66,8 +94,25 @@ namespace GX
         void addScalingKey(float time, glm::vec3 value) { scalingKeys.push_back(TimeVector3(time, value)); }
         void addRotationKey(float time, glm::highp_quat value) { rotationKeys.push_back(TimeQuaternion(time, value)); }
 
+        //Key lookup expects keys ordered by time. Call after keys are added or moved out of order
+        void sortKeys();
+
         glm::mat4x4 getTransformAtTime(float time, Transform* transform);
 
+        //Interpolates keys at time. Channels without keys keep the passed values
+        void sample(float time, glm::vec3& position, glm::highp_quat& rotation, glm::vec3& scale);
+
+        //Removes keys which interpolation of the neighbour keys reproduces within the given error.
+        //First and last keys are kept. Rotation error is in radians
+        void reduceKeys(float positionError, float rotationError, float scaleError);
+
+        //Moves keys into compressed tracks. Compressed nodes have no editable keys
+        void compress();
+        bool isCompressed() { return compressed; }
+
+        //Bytes used by keys of this node
+        size_t getMemorySize();
+
         std::string getName() { return name; }
         size_t getNameHash() { return nameHash; }
         void setName(std::string value);
@@ -79,6 +124,9 @@ namespace GX
         std::vector<AnimationClipNode*> animationClipNodes;
         float duration = 0.0f;
         float framesPerSecond = 25.0f;
+        uint32_t nodesVersion = 0;
+
+        static bool compressOnLoad;
 
     public:
         AnimationClip();
@@ -100,6 +148,9 @@ namespace GX
         void addAnimationClipNode(AnimationClipNode* value);
         void deleteAnimationClipNode(AnimationClipNode* value);
 
+        //Changes when nodes are added or removed, so cached bone bindings can be rebuilt
+        uint32_t getNodesVersion() { return nodesVersion; }
+
         float getDuration() { return duration; }
         void setDuration(float value) { duration = value; }
 
@@ -108,5 +159,16 @@ namespace GX
 
         AnimationClip* crop(int startFrame, int endFrame, std::string name);
         void clear();
+
+        //Applied to imported clips. Default errors are small enough to be invisible
+        void reduceKeys(float positionError = 0.0001f, float rotationError = 0.0002f, float scaleError = 0.0001f);
+        void compress();
+
+        //Bytes used by keys of all nodes
+        size_t getMemorySize();
+
+        //Clips loaded while this is set are compressed and can not be edited or saved. Used by the player
+        static bool getCompressOnLoad() { return compressOnLoad; }
+        static void setCompressOnLoad(bool value) { compressOnLoad = value; }
     };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <map>
 #include <string>
 
@@ -9,8 +10,12 @@ namespace GX
 {
 	class Asset
 	{
+		friend class AsyncLoader;
+
 	protected:
 		bool loaded = false;
+		bool loading = false;
+		std::atomic<bool> loadingCancelled = { false }; //Set by AsyncLoader, polled by long running loaders
 		bool persistent = false;
 		static std::map<std::string, Asset*> loadedInstances;
 
@@ -32,6 +37,8 @@ namespace GX
 		virtual void reload();
 
 		bool isLoaded() { return loaded; }
+		bool isLoading() { return loading; }
+		bool isLoadingCancelled() { return loadingCancelled; }
 
 		//void createManagedObject(MonoObject* obj);
 		void createManagedObject();
@@ -1,12 +1,16 @@
 #include "Cubemap.h"
 
 #include <boost/iostreams/stream.hpp>
+#include <cmath>
+#include <bx/allocator.h>
+#include <bimg/bimg.h>
 
 #include "../Core/Engine.h"
 #include "../Core/APIManager.h"
 #include "../Classes/IO.h"
 #include "../Core/Debug.h"
 #include "../Classes/ZipHelper.h"
+#include "../Classes/bc7compressor.h"
 
 #include "Texture.h"
 
@@ -18,6 +22,81 @@ namespace GX
 
 	std::string Cubemap::ASSET_TYPE = "Cubemap";
 
+	static bool getBcFormat(bgfx::TextureFormat::Enum format, bc_format& bcFormat)
+	{
+		switch (format)
+		{
+		case bgfx::TextureFormat::BC1: bcFormat = BC_FORMAT_BC1; return true;
+		case bgfx::TextureFormat::BC3: bcFormat = BC_FORMAT_BC3; return true;
+		case bgfx::TextureFormat::BC4: bcFormat = BC_FORMAT_BC4; return true;
+		case bgfx::TextureFormat::BC5: bcFormat = BC_FORMAT_BC5; return true;
+		case bgfx::TextureFormat::BC7: bcFormat = BC_FORMAT_BC7; return true;
+		default: return false;
+		}
+	}
+
+	//Converts face pixels with all mip levels to another format. Compressed data is decoded and encoded again
+	static std::pair<unsigned char*, int> convertFace(std::pair<unsigned char*, int> src, bgfx::TextureFormat::Enum srcFormat, bgfx::TextureFormat::Enum dstFormat, int width, int height, bool hasMips)
+	{
+		static bx::DefaultAllocator allocator;
+
+		bc_format bcFormat = BC_FORMAT_BC7;
+		bool compress = getBcFormat(dstFormat, bcFormat);
+
+		int numLevels = hasMips ? static_cast<int>(std::floor(std::log2(std::max(width, height)))) + 1 : 1;
+
+		std::vector<std::vector<unsigned char>> levels(numLevels);
+		std::vector<bc_image> images(numLevels);
+
+		int srcOffset = 0;
+		int dstSize = 0;
+
+		for (int l = 0; l < numLevels; ++l)
+		{
+			int lw = std::max(1, width >> l);
+			int lh = std::max(1, height >> l);
+
+			int srcSize = bimg::imageGetSize(nullptr, lw, lh, 1, false, false, 1, static_cast<bimg::TextureFormat::Enum>(srcFormat));
+			if (srcOffset + srcSize > src.second)
+				return { nullptr, 0 };
+
+			//Block decoders write whole 4x4 blocks, so small mips are decoded into a padded image and cropped
+			int pw = (lw + 3) & ~3;
+			int ph = (lh + 3) & ~3;
+			std::vector<unsigned char> decoded(pw * ph * 4, 0);
+			bimg::imageDecodeToRgba8(&allocator, decoded.data(), src.first + srcOffset, pw, ph, pw * 4, static_cast<bimg::TextureFormat::Enum>(srcFormat));
+
+			levels[l].resize(lw * lh * 4);
+			for (int y = 0; y < lh; ++y)
+				memcpy(&levels[l][y * lw * 4], &decoded[y * pw * 4], lw * 4);
+
+			images[l].pixels = reinterpret_cast<const color_quad_u8*>(levels[l].data());
+			images[l].width = lw;
+			images[l].height = lh;
+
+			srcOffset += srcSize;
+			dstSize += compress ? bcsize(bcFormat, lw, lh) : lw * lh * 4;
+		}
+
+		unsigned char* dst = new unsigned char[dstSize];
+		int dstOffset = 0;
+
+		for (auto& image : images)
+		{
+			image.output = dst + dstOffset;
+
+			if (!compress)
+				memcpy(image.output, image.pixels, image.width * image.height * 4);
+
+			dstOffset += compress ? bcsize(bcFormat, image.width, image.height) : image.width * image.height * 4;
+		}
+
+		if (compress)
+			bccompress(images, bcFormat, 1);
+
+		return { dst, dstSize };
+	}
+
 	Cubemap::Cubemap() : Asset(APIManager::getSingleton()->cubemap_class)
 	{
 		for (int i = 0; i < 6; ++i)
@@ -155,6 +234,32 @@ namespace GX
 		int size = std::max(_textures[0]->getWidth(), _textures[wIdx]->getHeight());
 		bool hasMips = _textures[wIdx]->getNumMipMaps() > 0;
 		bgfx::TextureFormat::Enum format = _textures[wIdx]->getFormat();
+
+		//All faces must have one format. Texture compression may differ per face, e.g. with Auto
+		bc_format bcFormat;
+		if (format != bgfx::TextureFormat::RGBA8 && !getBcFormat(format, bcFormat))
+			format = bgfx::TextureFormat::RGBA8;
+
+		for (int i = 0; i < 6; ++i)
+		{
+			if (_textures[i]->getFormat() == format)
+				continue;
+
+			//Faces of other size are padded below as before
+			if (_textures[i]->getWidth() != _textures[wIdx]->getWidth() || _textures[i]->getHeight() != _textures[wIdx]->getHeight())
+				continue;
+
+			std::pair<unsigned char*, int> converted = convertFace(datas[i], _textures[i]->getFormat(), format, _textures[i]->getWidth(), _textures[i]->getHeight(), hasMips);
+			if (converted.first == nullptr)
+				continue;
+
+			if (i != wIdx && _textures[i] != Texture::getNullTexture())
+				Debug::logWarning("[" + name + "] Cubemap face " + _textures[i]->getName() + " has a different compression, converted on load. Use the same compression for all faces to avoid this");
+
+			delete[] datas[i].first;
+			datas[i] = converted;
+		}
+
 		size_t texSize = datas[wIdx].second;
 		size_t dataSize = texSize * 6;
 		
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <boost/iostreams/stream.hpp>
 
 #include "../Core/Engine.h"
@@ -12,6 +13,7 @@
 #include "../Renderer/VertexLayouts.h"
 #include "../Core/Debug.h"
 #include "../Core/APIManager.h"
+#include "../Core/AsyncLoader.h"
 
 #include "../Serialization/Assets/SMesh.h"
 #include "../Serialization/Data/SColor.h"
@@ -64,10 +66,7 @@ namespace GX
         if (bgfx::isValid(m_ibh))
             bgfx::destroy(m_ibh);
 
-        m_vbh = bgfx::createVertexBuffer(
-            bgfx::makeRef(vertexBuffer.data(), vertexBuffer.size() * sizeof(VertexBuffer)),
-            VertexLayouts::subMeshVertexLayout
-        );
+        m_vbh = VertexLayouts::createCompactVertexBuffer(vertexBuffer, bones.size() > 0);
 
         m_ibh = bgfx::createIndexBuffer(
             bgfx::makeRef(indexBuffer.data(), indexBuffer.size() * sizeof(uint32_t)), BGFX_BUFFER_INDEX32
@@ -80,10 +79,7 @@ namespace GX
         {
             if (!bgfx::isValid(m_vbh) && vertexBuffer.size() > 0)
             {
-                m_vbh = bgfx::createVertexBuffer(
-                    bgfx::makeRef(vertexBuffer.data(), vertexBuffer.size() * sizeof(VertexBuffer)),
-                    VertexLayouts::subMeshVertexLayout
-                );
+                m_vbh = VertexLayouts::createCompactVertexBuffer(vertexBuffer, bones.size() > 0);
             }
 
             if (!bgfx::isValid(m_ibh) && indexBuffer.size() > 0)
@@ -171,6 +167,8 @@ namespace GX
 
     Mesh::~Mesh()
     {
+        AsyncLoader::getSingleton()->cancel(this);
+
         unload();
     }
 
@@ -267,22 +265,7 @@ namespace GX
             sSubMesh.materialName = subMesh->materialName;
             sSubMesh.useLightmapUVs = subMesh->useLightmapUVs;
             
-            for (auto v = subMesh->vertexBuffer.begin(); v != subMesh->vertexBuffer.end(); ++v)
-            {
-                SVertexBuffer svBuf;
-                svBuf.position = v->position;
-                svBuf.normal = v->normal;
-                svBuf.tangent = v->tangent;
-                svBuf.bitangent = v->bitangent;
-                svBuf.texcoord0 = v->texcoord0;
-                svBuf.texcoord1 = v->texcoord1;
-                svBuf.blendWeights = v->blendWeights;
-                svBuf.blendIndices = v->blendIndices;
-                svBuf.color = SColor(Color::unpackABGR(v->color));
-                
-                sSubMesh.vertexBuffer.push_back(svBuf);
-            }
-
+            sSubMesh.vertices = subMesh->vertexBuffer;
             sSubMesh.indexBuffer = subMesh->indexBuffer;
 
             for (auto& lod : subMesh->lodIndexBuffer)
@@ -353,95 +336,104 @@ namespace GX
         }
     }
 
-    Mesh* Mesh::load(std::string location, std::string name)
+    Mesh* Mesh::getInstanceForLoad(std::string location, std::string name, bool warn)
     {
         std::string fullPath = location + name;
 
         Asset* cachedAsset = getLoadedInstance(location, name);
 
-        if (cachedAsset != nullptr && cachedAsset->isLoaded())
-        {
+        if (cachedAsset != nullptr && (cachedAsset->isLoaded() || cachedAsset->isLoading()))
             return (Mesh*)cachedAsset;
-        }
-        else
+
+        if (IO::isDir(location))
         {
-            if (IO::isDir(location))
+            if (!IO::FileExists(fullPath))
             {
-                if (!IO::FileExists(fullPath))
-                {
+                if (warn)
                     Debug::log("[" + fullPath + "] Error loading mesh: file does not exists", Debug::DbgColorRed);
-                    return nullptr;
-                }
+                return nullptr;
             }
-            else
+        }
+        else
+        {
+            zip_t* arch = Engine::getSingleton()->getZipArchive(location);
+            if (!ZipHelper::isFileInZip(arch, name))
             {
-                zip_t* arch = Engine::getSingleton()->getZipArchive(location);
-                if (!ZipHelper::isFileInZip(arch, name))
-                {
+                if (warn)
                     Debug::log("[" + fullPath + "] Error loading mesh: file does not exists", Debug::DbgColorRed);
-                    return nullptr;
-                }
+                return nullptr;
             }
+        }
+
+        Mesh* mesh = nullptr;
+        if (cachedAsset == nullptr)
+        {
+            mesh = new Mesh();
+            mesh->setLocation(location);
+            mesh->setName(name);
+        }
+        else
+            mesh = (Mesh*)cachedAsset;
 
-            Mesh* mesh = nullptr;
-            if (cachedAsset == nullptr)
+        return mesh;
+    }
+
+    bool Mesh::loadData(std::string location, std::string name, SMesh& sMesh, std::string& error)
+    {
+        std::string fullPath = location + name;
+
+        if (IO::isDir(location))
+        {
+            try
             {
-                mesh = new Mesh();
-                mesh->setLocation(location);
-                mesh->setName(name);
+                std::ifstream ofs(fullPath, std::ios::binary);
+                BinarySerializer s;
+                s.deserialize(&ofs, &sMesh, Mesh::ASSET_TYPE);
+                ofs.close();
             }
-            else
-                mesh = (Mesh*)cachedAsset;
+            catch (std::exception e)
+            {
+                error = "[" + name + "] Error loading model cache: " + e.what();
+            }
+        }
+        else
+        {
+            zip_t* arch = Engine::getSingleton()->getZipArchive(location);
 
-            SMesh sMesh;
+            ZipFileData file = ZipHelper::openFile(arch, name);
 
-            if (IO::isDir(location))
+            try
             {
-                try
-                {
-                    std::ifstream ofs(fullPath, std::ios::binary);
-                    BinarySerializer s;
-                    s.deserialize(&ofs, &sMesh, Mesh::ASSET_TYPE);
-                    ofs.close();
-                }
-                catch (std::exception e)
-                {
-                    Debug::log("[" + name + "] Error loading model cache: " + e.what(), Debug::DbgColorRed);
-                }
+                boost::iostreams::stream<boost::iostreams::array_source> is(file.getData(), file.getSize());
+                BinarySerializer s;
+                s.deserialize(&is, &sMesh, Mesh::ASSET_TYPE);
+                is.close();
             }
-            else
+            catch (std::exception e)
             {
-                zip_t* arch = Engine::getSingleton()->getZipArchive(location);
+                error = "[" + name + "] Error loading model cache: " + e.what();
+            }
+        }
 
-                int sz = 0;
-                char* buffer = ZipHelper::readFileFromZip(arch, name, sz);
+        return error.empty();
+    }
 
-                try
-                {
-                    boost::iostreams::stream<boost::iostreams::array_source> is(buffer, sz);
-                    BinarySerializer s;
-                    s.deserialize(&is, &sMesh, Mesh::ASSET_TYPE);
-                    is.close();
-                }
-                catch (std::exception e)
-                {
-                    Debug::log("[" + name + "] Error loading model cache: " + e.what(), Debug::DbgColorRed);
-                }
+    void Mesh::createSubMeshes(SMesh& sMesh)
+    {
+        setAlias(sMesh.alias);
+        setSourceFile(sMesh.sourceFile);
 
-                delete[] buffer;
-            }
+        for (auto it = sMesh.subMeshes.begin(); it != sMesh.subMeshes.end(); ++it)
+        {
+            SSubMesh& sSubMesh = *it;
+            SubMesh* subMesh = new SubMesh();
 
-            mesh->setAlias(sMesh.alias);
-            mesh->setSourceFile(sMesh.sourceFile);
+            subMesh->materialName = sSubMesh.materialName;
+            subMesh->useLightmapUVs = sSubMesh.useLightmapUVs;
 
-            for (auto it = sMesh.subMeshes.begin(); it != sMesh.subMeshes.end(); ++it)
+            if (!sSubMesh.vertexBuffer.empty())
             {
-                SSubMesh& sSubMesh = *it;
-                SubMesh* subMesh = new SubMesh();
-
-                subMesh->materialName = sSubMesh.materialName;
-                subMesh->useLightmapUVs = sSubMesh.useLightmapUVs;
-
+                //Old cache format with per vertex archives
                 subMesh->vertexBuffer.resize(sSubMesh.vertexBuffer.size());
 
                 int i = 0;
@@ -460,32 +452,99 @@ namespace GX
 
                     subMesh->vertexBuffer[i] = vbuf;
                 }
+            }
+            else
+                subMesh->vertexBuffer.swap(sSubMesh.vertices);
 
-                subMesh->indexBuffer = sSubMesh.indexBuffer;
-
-                for (auto& lodInfo : sSubMesh.lods)
-                    subMesh->lodIndexBuffer.push_back(lodInfo.indexBuffer);
+            subMesh->indexBuffer.swap(sSubMesh.indexBuffer);
 
-                for (auto it = sSubMesh.bones.begin(); it != sSubMesh.bones.end(); ++it)
-                {
-                    SBoneInfo& sBone = *it;
+            for (auto& lodInfo : sSubMesh.lods)
+            {
+                subMesh->lodIndexBuffer.push_back(std::vector<uint32_t>());
+                subMesh->lodIndexBuffer.back().swap(lodInfo.indexBuffer);
+            }
 
-                    BoneInfo* bone = new BoneInfo();
-                    bone->setName(sBone.name);
-                    bone->setOffsetMatrix(sBone.offsetMatrix.getValue());
+            for (auto it = sSubMesh.bones.begin(); it != sSubMesh.bones.end(); ++it)
+            {
+                SBoneInfo& sBone = *it;
 
-                    subMesh->addBone(bone);
-                }
+                BoneInfo* bone = new BoneInfo();
+                bone->setName(sBone.name);
+                bone->setOffsetMatrix(sBone.offsetMatrix.getValue());
 
-                mesh->subMeshes.push_back(subMesh);
+                subMesh->addBone(bone);
             }
 
-            mesh->load();
+            subMeshes.push_back(subMesh);
+        }
+
+        load();
 
-            sMesh.subMeshes.clear();
+        sMesh.subMeshes.clear();
+    }
 
+    Mesh* Mesh::load(std::string location, std::string name)
+    {
+        Mesh* mesh = getInstanceForLoad(location, name, true);
+
+        if (mesh == nullptr || mesh->isLoaded())
             return mesh;
+
+        //Already requested with loadAsync. Finish it now
+        if (mesh->isLoading())
+        {
+            AsyncLoader::getSingleton()->wait(mesh);
+            return mesh->isLoaded() ? mesh : nullptr;
         }
+
+        SMesh sMesh;
+        std::string error = "";
+
+        bool result = loadData(location, name, sMesh, error);
+
+        if (!error.empty())
+            Debug::log(error, Debug::DbgColorRed);
+
+        if (!result)
+            return nullptr;
+
+        mesh->createSubMeshes(sMesh);
+
+        return mesh;
+    }
+
+    Mesh* Mesh::loadAsync(std::string location, std::string name)
+    {
+        Mesh* mesh = getInstanceForLoad(location, name, false);
+
+        if (mesh == nullptr || mesh->isLoaded() || mesh->isLoading())
+            return mesh;
+
+        //Register right away, so following requests for the same mesh get this instance
+        setLoadedInstance(location, name, mesh);
+
+        std::shared_ptr<SMesh> sMesh = std::make_shared<SMesh>();
+        std::shared_ptr<std::string> error = std::make_shared<std::string>();
+        std::shared_ptr<bool> result = std::make_shared<bool>(false);
+
+        AsyncLoader::getSingleton()->schedule(mesh,
+            [=]()
+            {
+                *result = loadData(location, name, *sMesh, *error);
+            },
+            [=]()
+            {
+                if (!error->empty())
+                    Debug::log(*error, Debug::DbgColorRed);
+
+                if (!*result)
+                    return;
+
+                mesh->createSubMeshes(*sMesh);
+            }
+        );
+
+        return mesh;
     }
 
     void Mesh::recalculateBounds()
@@ -14,6 +14,7 @@
 namespace GX
 {
     class Mesh;
+    class SMesh;
 
     class BoneInfo
     {
@@ -102,6 +103,10 @@ namespace GX
 
         AxisAlignedBox boundingBox = AxisAlignedBox::BOX_NULL;
 
+        static Mesh* getInstanceForLoad(std::string location, std::string name, bool warn);
+        static bool loadData(std::string location, std::string name, SMesh& sMesh, std::string& error); //Safe to call from job threads
+        void createSubMeshes(SMesh& sMesh);
+
     public:
         Mesh();
         virtual ~Mesh();
@@ -115,6 +120,7 @@ namespace GX
         virtual std::string getAssetType() { return ASSET_TYPE; }
         static Mesh* create(std::string location, std::string name);
         static Mesh* load(std::string location, std::string name);
+        static Mesh* loadAsync(std::string location, std::string name); //Returned mesh is empty until loading is finished
         void save();
         void save(std::string path);
         void commit();
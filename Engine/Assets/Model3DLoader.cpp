@@ -982,6 +982,9 @@ namespace GX
                     animClip->addAnimationClipNode(clipNode);
                 }
 
+                //Keys are sampled per frame above. Drop the ones interpolation gives back
+                animClip->reduceKeys();
+
                 animClip->save();
             }
         }
@@ -1028,8 +1031,8 @@ namespace GX
             aiQuaternion rot = aiQuaternion(child->getRotation().w, child->getRotation().x, child->getRotation().y, child->getRotation().z);
             nnode->mTransformation = aiMatrix4x4(scl, rot, pos);
 
-            MeshRenderer* renderer = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
-            CSGModel* csgModel = (CSGModel*)obj->getComponent(CSGModel::COMPONENT_TYPE);
+            MeshRenderer* renderer = obj->getComponent<MeshRenderer>();
+            CSGModel* csgModel = obj->getComponent<CSGModel>();
 
             if (renderer != nullptr)
             {
@@ -895,6 +895,8 @@ namespace GX
 					sEmitter.enablePhysics = emitter->getEnablePhysics();
 					sEmitter.friction = emitter->getFriction();
 					sEmitter.bounciness = emitter->getBounciness();
+					sEmitter.collisionMode = static_cast<int>(emitter->getCollisionMode());
+					sEmitter.collisionResponse = static_cast<int>(emitter->getCollisionResponse());
 					sEmitter.animated = emitter->getAnimated();
 					sEmitter.animationGridSize = emitter->getAnimationGridSize();
 					sEmitter.animationTimeMode = static_cast<int>(emitter->getAnimationTimeMode());
@@ -1805,6 +1807,8 @@ namespace GX
 				emitter->setEnablePhysics(sEmitter.enablePhysics);
 				emitter->setFriction(sEmitter.friction);
 				emitter->setBounciness(sEmitter.bounciness);
+				emitter->setCollisionMode(static_cast<ParticleEmitter::CollisionMode>(sEmitter.collisionMode));
+				emitter->setCollisionResponse(static_cast<ParticleEmitter::CollisionResponse>(sEmitter.collisionResponse));
 				emitter->setAnimated(sEmitter.animated);
 				emitter->setAnimationGridSize(sEmitter.animationGridSize.getValue());
 				emitter->setAnimationTimeMode(static_cast<ParticleEmitter::AnimationTimeMode>(sEmitter.animationTimeMode));
@@ -2034,6 +2038,21 @@ namespace GX
 		NavigationManager::getSingleton()->setWalkableRadius(scene->navMeshSettings.walkableRadius);
 		NavigationManager::getSingleton()->setWalkableSlopeAngle(scene->navMeshSettings.walkableSlopeAngle);
 
+		//Start reading meshes and textures in background. Objects below pick them up with regular load calls
+		std::string assetsPath = Engine::getSingleton()->getAssetsPath();
+		std::string libraryPath = Engine::getSingleton()->getLibraryPath();
+		for (auto it = scene->gameObjects.begin(); it != scene->gameObjects.end(); ++it)
+		{
+			for (auto& sComponent : it->meshRenderers)
+				Mesh::loadAsync(libraryPath, sComponent.mesh);
+
+			for (auto& sComponent : it->images)
+			{
+				if (!sComponent.texturePath.empty())
+					Texture::loadAsync(assetsPath, sComponent.texturePath, false, Texture::CompressionMethod::None);
+			}
+		}
+
 		std::vector<std::pair<GameObject*, SGameObject>> objectCache;
 		std::vector<GameObject*> objects;
 
@@ -2127,12 +2146,11 @@ namespace GX
 				return;
 			}
 
-			int sz = 0;
-			char* buffer = ZipHelper::readFileFromZip(arch, name, sz);
+			ZipFileData file = ZipHelper::openFile(arch, name);
 
 			try
 			{
-				boost::iostreams::stream<boost::iostreams::array_source> is(buffer, sz);
+				boost::iostreams::stream<boost::iostreams::array_source> is(file.getData(), file.getSize());
 				BinarySerializer s;
 				s.deserialize(&is, &scene, Scene::ASSET_TYPE);
 				is.close();
@@ -2142,8 +2160,6 @@ namespace GX
 				Debug::log("[" + name + "] Error loading scene: " + e.what(), Debug::DbgColorRed);
 				std::cerr << "[" + name + "] Error loading scene: " << e.what() << '\n';
 			}
-
-			delete[] buffer;
 		}
 
 		loadedScene = name;
@@ -2163,14 +2179,14 @@ namespace GX
 
 		for (auto obj : objects)
 		{
-			CSGBrush* brush = (CSGBrush*)obj->getComponent(CSGBrush::COMPONENT_TYPE);
+			CSGBrush* brush = obj->getComponent<CSGBrush>();
 			if (brush != nullptr)
 				brush->rebuild();
 		}
 
 		for (auto& object : objects)
 		{
-			CSGModel* model = (CSGModel*)object->getComponent(CSGModel::COMPONENT_TYPE);
+			CSGModel* model = object->getComponent<CSGModel>();
 			if (model == nullptr)
 				continue;
 
@@ -17,6 +17,7 @@
 namespace GX
 {
 	std::string Shader::ASSET_TYPE = "Shader";
+	std::string Shader::INSTANCING_DEFINE = "INSTANCING=1;";
 
 	struct PassTag
 	{
@@ -223,6 +224,16 @@ namespace GX
 		return result;
 	}
 
+	ProgramVariant* Pass::getInstancedProgramVariant(std::size_t definesHash)
+	{
+		ProgramVariant* pv = getProgramVariant(definesHash);
+
+		if (pv == nullptr || !pv->instancing)
+			return nullptr;
+
+		return getProgramVariant(pv->instancedDefinesHash);
+	}
+
 	void Pass::setProgramVariantTag(ProgramVariant* pv, std::string name, std::vector<std::string> values)
 	{
 		if (name == "backface_culling")
@@ -243,6 +254,11 @@ namespace GX
 			if (values[0] == "default") pv->iterationMode = (IterationMode::Default);
 			if (values[0] == "per_light") pv->iterationMode = (IterationMode::PerLight);
 		}
+		if (name == "instancing")
+		{
+			if (values[0] == "on") pv->instancing = (true);
+			if (values[0] == "off") pv->instancing = (false);
+		}
 		if (name == "depth_write")
 		{
 			if (values[0] == "on") pv->depthWrite = (true);
@@ -1220,6 +1236,14 @@ namespace GX
 					}
 				}
 
+				if (pp->instancing)
+				{
+					if (definesString.find(INSTANCING_DEFINE) == std::string::npos)
+						pp->instancedDefinesHash = std::hash<std::string>{}(definesString + INSTANCING_DEFINE);
+					else
+						pp->instancedDefinesHash = pp->preprocessorDefinesHash;
+				}
+
 				bgfx::UniformHandle* handles = new bgfx::UniformHandle[64];
 
 				//Vertex uniforms
@@ -1319,5 +1343,23 @@ namespace GX
 				Debug::logWarning("[" + getName() + "] Error parsing shader: syntax error (Pass " + std::to_string(p) + ")");
 			}
 		}
+
+		//Compile instanced variant if any pass requests it
+		if (definesString.find(INSTANCING_DEFINE) == std::string::npos)
+		{
+			bool instancing = false;
+			for (auto it = passes.begin(); it != passes.end(); ++it)
+			{
+				ProgramVariant* pv = (*it)->getProgramVariant(definesString);
+				if (pv != nullptr && pv->instancing)
+				{
+					instancing = true;
+					break;
+				}
+			}
+
+			if (instancing)
+				compile(definesString + INSTANCING_DEFINE);
+		}
 	}
 }
\ No newline at end of file
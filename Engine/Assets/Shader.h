@@ -106,12 +106,17 @@ namespace GX
 		DepthFunction depthFunction = DepthFunction::LessOrEqual;
 		BlendMode blendMode = BlendMode::Replace;
 		IterationMode iterationMode = IterationMode::Default;
+		//"instancing on" tag: INSTANCING=1 variant reads model matrix from i_data0..i_data3.
+		//u_normalMatrix and u_invModel are identity in instanced draws, so the variant has to derive them per instance
+		bool instancing = false;
 		StencilFunction stencilFunction = StencilFunction::None;
 		StencilOpFailS stencilOpFailS = StencilOpFailS::None;
 		StencilOpFailZ stencilOpFailZ = StencilOpFailZ::None;
 		StencilOpPassZ stencilOpPassZ = StencilOpPassZ::None;
 		//
 
+		std::size_t instancedDefinesHash = 0;
+
 		const UniformVariant* getUniform(std::string name);
 		const UniformVariant* getUniform(std::size_t nameHash);
 
@@ -139,10 +144,14 @@ namespace GX
 		bgfx::ProgramHandle getProgramHandle(std::string defines);
 		ProgramVariant * getProgramVariant(std::string defines);
 		ProgramVariant * getProgramVariant(std::size_t definesHash);
+		ProgramVariant * getInstancedProgramVariant(std::size_t definesHash);
 	};
 
 	class Shader : public Asset
 	{
+	public:
+		static std::string INSTANCING_DEFINE;
+
 	private:
 		RenderMode renderMode = RenderMode::Forward;
 
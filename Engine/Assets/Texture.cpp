@@ -4,6 +4,8 @@
 
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <memory>
 #include <bx/bx.h>
 #include "Classes/bc7compressor.h"
 
@@ -19,6 +21,8 @@
 #include "../Classes/md5.h"
 #include "../Core/Debug.h"
 #include "../Core/APIManager.h"
+#include "../Core/AsyncLoader.h"
+#include "../Renderer/TextureStreamer.h"
 #include "../Renderer/NullTextureData.h"
 #include "Cubemap.h"
 
@@ -29,6 +33,7 @@ namespace GX
 {
 	std::string Texture::ASSET_TYPE = "Texture";
 	Texture* Texture::nullTexture = nullptr;
+	bool Texture::logCompressionStatsEnabled = false;
 
 	Texture::Texture() : Asset(APIManager::getSingleton()->texture_class)
 	{
@@ -36,6 +41,8 @@ namespace GX
 
 	Texture::~Texture()
 	{
+		AsyncLoader::getSingleton()->cancel(this);
+
 		if (!persistent)
 		{
 			if (!immutable)
@@ -78,6 +85,9 @@ namespace GX
 			if (persistent)
 				return;
 
+			TextureStreamer::getSingleton()->removeTexture(this);
+			residentMip = 0;
+
 			if (bgfx::isValid(textureHandle))
 				bgfx::destroy(textureHandle);
 
@@ -126,34 +136,46 @@ namespace GX
 		if (getOrigin().empty())
 			return;
 
+		//A previous import of this texture is not needed anymore
+		AsyncLoader::getSingleton()->cancel(this);
+
 		if (isLoaded())
 			unload();
 
 		std::string texName = getCachedFileName();
 
-		if (!Engine::getSingleton()->getIsRuntimeMode())
-		{
-			if (IO::FileExists(texName))
-				IO::FileDelete(texName);
-		}
-
-		load(location, name, genMipMaps, compressionMethod, persistent);
-
-		for (auto& asset : Asset::getLoadedInstances())
+		auto reloadCubemaps = [](Texture* texture)
 		{
-			if (asset.second->getAssetType() == Cubemap::ASSET_TYPE)
+			for (auto& asset : Asset::getLoadedInstances())
 			{
-				Cubemap* cubemap = (Cubemap*)asset.second;
-
-				for (int i = 0; i < 6; ++i)
+				if (asset.second->getAssetType() == Cubemap::ASSET_TYPE)
 				{
-					if (cubemap->getTexture(i) == this)
+					Cubemap* cubemap = (Cubemap*)asset.second;
+
+					for (int i = 0; i < 6; ++i)
 					{
-						cubemap->reload();
-						break;
+						if (cubemap->getTexture(i) == texture)
+						{
+							cubemap->reload();
+							break;
+						}
 					}
 				}
 			}
+		};
+
+		if (!Engine::getSingleton()->getIsRuntimeMode())
+		{
+			if (IO::FileExists(texName))
+				IO::FileDelete(texName);
+
+			//Reimport in the background, the editor shows it in the import queue
+			loadAsync(location, name, genMipMaps, compressionMethod, persistent, reloadCubemaps);
+		}
+		else
+		{
+			load(location, name, genMipMaps, compressionMethod, persistent);
+			reloadCubemaps(this);
 		}
 	}
 
@@ -167,6 +189,60 @@ namespace GX
 		Renderer::getSingleton()->frame();
 	}
 
+	//Copies 32 bit bitmap rows as tightly packed RGBA8
+	static void copyPixels(unsigned char* dst, FIBITMAP* src, int width, int height)
+	{
+		for (int y = 0; y < height; ++y)
+		{
+			BYTE* line = FreeImage_GetScanLine(src, y);
+			unsigned char* out = dst + (size_t)y * width * 4;
+
+			for (int x = 0; x < width; ++x, line += 4, out += 4)
+			{
+				out[0] = line[FI_RGBA_RED];
+				out[1] = line[FI_RGBA_GREEN];
+				out[2] = line[FI_RGBA_BLUE];
+				out[3] = line[FI_RGBA_ALPHA];
+			}
+		}
+	}
+
+	static void copyPixels(color_quad_u8_vec& dst, FIBITMAP* src, int width, int height)
+	{
+		dst.resize(width * height);
+		copyPixels(reinterpret_cast<unsigned char*>(dst.data()), src, width, height);
+	}
+
+	//Reorders 32 bit bitmap to RGBA8 in place
+	static void swizzleToRGBA8(FIBITMAP* bitmap)
+	{
+		if (FI_RGBA_RED == 0)
+			return;
+
+		int width = FreeImage_GetWidth(bitmap);
+		int height = FreeImage_GetHeight(bitmap);
+
+		for (int y = 0; y < height; ++y)
+		{
+			BYTE* line = FreeImage_GetScanLine(bitmap, y);
+
+			for (int x = 0; x < width; ++x, line += 4)
+				std::swap(line[0], line[2]);
+		}
+	}
+
+	static bc_format toBcFormat(Texture::CompressionMethod compression)
+	{
+		switch (compression)
+		{
+		case Texture::CompressionMethod::BC1: return BC_FORMAT_BC1;
+		case Texture::CompressionMethod::BC3: return BC_FORMAT_BC3;
+		case Texture::CompressionMethod::BC4: return BC_FORMAT_BC4;
+		case Texture::CompressionMethod::BC5: return BC_FORMAT_BC5;
+		default: return BC_FORMAT_BC7;
+		}
+	}
+
 	Texture* Texture::loadFromByteArray(std::string location, std::string name, unsigned char* data, size_t size)
 	{
 		Texture* texture = nullptr;
@@ -191,7 +267,13 @@ namespace GX
 		FIMEMORY* fimem = FreeImage_OpenMemory(data, size);
 		FREE_IMAGE_FORMAT formato = FreeImage_GetFileTypeFromMemory(fimem, size);
 		FIBITMAP* imagen = FreeImage_LoadFromMemory(formato, fimem);
-		imagen = FreeImage_ConvertToRGBA16(imagen);
+
+		if (FreeImage_GetBPP(imagen) != 32)
+		{
+			FIBITMAP* convert = FreeImage_ConvertTo32Bits(imagen);
+			FreeImage_Unload(imagen);
+			imagen = convert;
+		}
 
 		texture->width = FreeImage_GetWidth(imagen);
 		texture->height = FreeImage_GetHeight(imagen);
@@ -202,19 +284,17 @@ namespace GX
 		int _size = (texture->bpp / 8) * texture->width * texture->height;
 
 		//delete[] nullTexture->pixels;
-		unsigned char* _data = FreeImage_GetBits(imagen);
 		texture->pixels = new unsigned char[_size];
-		memcpy(texture->pixels, _data, _size);
-		_data = nullptr;
+		copyPixels(texture->pixels, imagen, texture->width, texture->height);
 
 		texture->size = _size;
 
-		texture->format = bgfx::TextureFormat::RGBA16;
+		texture->format = bgfx::TextureFormat::RGBA8;
 
 		const bgfx::Memory* mem = bgfx::makeRef(reinterpret_cast<const void*>(texture->pixels), _size);
 
 		//bgfx::destroy(nullTexture->textureHandle);
-		texture->textureHandle = bgfx::createTexture2D(uint16_t(texture->width), uint16_t(texture->height), false, 1, bgfx::TextureFormat::RGBA16,
+		texture->textureHandle = bgfx::createTexture2D(uint16_t(texture->width), uint16_t(texture->height), false, 1, bgfx::TextureFormat::RGBA8,
 			BGFX_SAMPLER_MIN_ANISOTROPIC
 			| BGFX_SAMPLER_MAG_ANISOTROPIC
 			| BGFX_SAMPLER_MIP_POINT, mem);
@@ -227,38 +307,90 @@ namespace GX
 		return texture;
 	}
 
-	void copyPixels(color_quad_u8_vec& dst, FIBITMAP* src, int width, int height)
+	bgfx::TextureFormat::Enum Texture::getTextureFormat(CompressionMethod compression)
 	{
-		BYTE* pixels = (BYTE*)FreeImage_GetBits(src);
+		switch (compression)
+		{
+		case CompressionMethod::None: return bgfx::TextureFormat::RGBA8;
+		case CompressionMethod::BC1: return bgfx::TextureFormat::BC1;
+		case CompressionMethod::BC3: return bgfx::TextureFormat::BC3;
+		case CompressionMethod::BC4: return bgfx::TextureFormat::BC4;
+		case CompressionMethod::BC5: return bgfx::TextureFormat::BC5;
+		default: return bgfx::TextureFormat::BC7;
+		}
+	}
 
-		FIBITMAP* alphaChannel = FreeImage_GetChannel(src, FREE_IMAGE_COLOR_CHANNEL::FICC_ALPHA);
+	std::string Texture::getCompressionMethodName(CompressionMethod compression)
+	{
+		switch (compression)
+		{
+		case CompressionMethod::Default: return "Default";
+		case CompressionMethod::None: return "None";
+		case CompressionMethod::BC7: return "BC7";
+		case CompressionMethod::BC1: return "BC1";
+		case CompressionMethod::BC3: return "BC3";
+		case CompressionMethod::BC4: return "BC4";
+		case CompressionMethod::BC5: return "BC5";
+		case CompressionMethod::Auto: return "Auto";
+		default: return "";
+		}
+	}
 
-		BYTE* bits = FreeImage_GetBits(alphaChannel);
+	Texture::CompressionMethod Texture::selectCompressionMethod(FIBITMAP* bitmap, std::string name)
+	{
+		int width = FreeImage_GetWidth(bitmap);
+		int height = FreeImage_GetHeight(bitmap);
 
-		int pixelsCount = width * height;
-		dst.resize(pixelsCount);
+		//Every pixel is not needed to classify the image
+		int step = std::max(1, std::max(width, height) / 512);
 
-		int pos = 0;
-		for (int i = 0; i < width; ++i)
+		bool hasAlpha = false;
+		int numSamples = 0;
+		int numNormals = 0;
+
+		for (int y = 0; y < height; y += step)
 		{
-			for (int j = 0; j < height; ++j)
+			BYTE* line = FreeImage_GetScanLine(bitmap, y);
+
+			for (int x = 0; x < width; x += step)
 			{
-				color_quad_u8 pixel;
-				RGBQUAD rgb;
-				FreeImage_GetPixelColor(src, j, i, &rgb);
-				
-				BYTE alpha = 255;
-				if (alphaChannel != nullptr)
-					alpha = pixels[pos * 4 + 3];
-				
-				pixel.set(rgb.rgbRed, rgb.rgbGreen, rgb.rgbBlue, alpha);
-				dst[pos] = pixel;
-				++pos;
+				BYTE* px = line + x * 4;
+				int r = px[FI_RGBA_RED];
+				int g = px[FI_RGBA_GREEN];
+				int b = px[FI_RGBA_BLUE];
+
+				if (px[FI_RGBA_ALPHA] < 250)
+					hasAlpha = true;
+
+				float nx = r / 127.5f - 1.0f;
+				float ny = g / 127.5f - 1.0f;
+				float nz = b / 127.5f - 1.0f;
+				float len = nx * nx + ny * ny + nz * nz;
+
+				if (nz > 0.0f && len > 0.8f && len < 1.2f)
+					++numNormals;
+
+				++numSamples;
 			}
 		}
 
-		if (alphaChannel != nullptr)
-			FreeImage_Unload(alphaChannel);
+		//Unit length vectors facing outwards are not enough, bluish images pass this too. File name has to tell as well
+		std::string lname = IO::GetFileName(name);
+		std::transform(lname.begin(), lname.end(), lname.begin(), ::tolower);
+
+		bool normalName = lname.find("normal") != std::string::npos
+			|| lname.find("_nrm") != std::string::npos
+			|| lname.find("_nor") != std::string::npos
+			|| (lname.size() > 2 && lname.substr(lname.size() - 2) == "_n");
+
+		//BC5 drops Z and shaders sample normal maps as XYZ, so BC7 keeps them intact
+		if (!hasAlpha && normalName && numSamples > 0 && numNormals >= numSamples * 95 / 100)
+			return CompressionMethod::BC7;
+
+		if (hasAlpha)
+			return CompressionMethod::BC3;
+
+		return CompressionMethod::BC1;
 	}
 
 	uint64_t Texture::getState()
@@ -283,13 +415,11 @@ namespace GX
 		return texState;
 	}
 
-	Texture* Texture::load(std::string location, std::string name, bool genMipMaps, CompressionMethod compression, bool setIsPersistent, bool warn, std::function<void(unsigned char* data, size_t size)> cb)
+	Texture* Texture::getInstanceForLoad(std::string location, std::string name, bool genMipMaps, CompressionMethod compression, bool setIsPersistent, bool warn)
 	{
 		if (location.empty() || name.empty())
 			return nullptr;
 
-		ProjectSettings* settings = Engine::getSingleton()->getSettings();
-
 		std::string fullPath = location + name;
 
 		std::string libLocation = Engine::getSingleton()->getLibraryPath();
@@ -324,6 +454,10 @@ namespace GX
 
 			return tex;
 		}
+		else if (cachedAsset != nullptr && cachedAsset->isLoading())
+		{
+			return (Texture*)cachedAsset;
+		}
 		else
 		{
 			if (checkSourceFile)
@@ -367,212 +501,405 @@ namespace GX
 			texture->genMipMaps = genMipMaps;
 			texture->compressionMethod = compression;
 
-			//int size = 0;
-
-			STexture sTexture;
-			bool loadedFromCache = false;
+			return texture;
+		}
+	}
 
-			if (IO::isDir(libLocation) || libLocation.empty())
-			{
-				if (IO::FileExists(texName))
-				{
-					//Load from cache in Library folder
-					try
-					{
-						std::ifstream ofs(texName, std::ios::binary);
-						BinarySerializer s;
-						s.deserialize(&ofs, &sTexture, Texture::ASSET_TYPE);
-						ofs.close();
-					}
-					catch (std::exception e)
-					{
-						Debug::log("[" + name + "] Error loading texture cache: " + e.what());
-					}
+	bool Texture::readCache(std::string texName, std::string name, STexture& sTexture, std::string& error, std::function<void(std::istream& stream)> onRead)
+	{
+		std::string libLocation = Engine::getSingleton()->getLibraryPath();
+		bool loadedFromCache = false;
 
-					loadedFromCache = true;
-				}
-			}
-			else
+		if (IO::isDir(libLocation) || libLocation.empty())
+		{
+			if (IO::FileExists(texName))
 			{
-				std::string _tname = IO::RemovePart(texName, libLocation);
-				zip_t* arch = Engine::getSingleton()->getZipArchive(libLocation);
-
-				int sz = 0;
-				char* buffer = ZipHelper::readFileFromZip(arch, _tname, sz);
-
+				//Load from cache in Library folder
 				try
 				{
-					boost::iostreams::stream<boost::iostreams::array_source> is(buffer, sz);
+					std::ifstream ofs(texName, std::ios::binary);
 					BinarySerializer s;
-					s.deserialize(&is, &sTexture, Texture::ASSET_TYPE);
-					is.close();
+					s.deserialize(&ofs, &sTexture, Texture::ASSET_TYPE);
+					if (onRead != nullptr)
+						onRead(ofs);
+					ofs.close();
 				}
 				catch (std::exception e)
 				{
-					Debug::log("[" + name + "] Error loading texture cache: " + e.what());
+					error = "[" + name + "] Error loading texture cache: " + e.what();
 				}
 
-				delete[] buffer;
 				loadedFromCache = true;
 			}
+		}
+		else
+		{
+			std::string _tname = IO::RemovePart(texName, libLocation);
+			zip_t* arch = Engine::getSingleton()->getZipArchive(libLocation);
 
-			if (loadedFromCache && !setIsPersistent/* && compression != CompressionMethod::None*/)
+			ZipFileData file = ZipHelper::openFile(arch, _tname);
+
+			try
+			{
+				boost::iostreams::stream<boost::iostreams::array_source> is(file.getData(), file.getSize());
+				BinarySerializer s;
+				s.deserialize(&is, &sTexture, Texture::ASSET_TYPE);
+				if (onRead != nullptr)
+					onRead(is);
+				is.close();
+			}
+			catch (std::exception e)
 			{
-				//size = sTexture.size;
-
-				texture->width = sTexture.width;
-				texture->height = sTexture.height;
-				texture->originalWidth = sTexture.originalWidth;
-				texture->originalHeight = sTexture.originalHeight;
-				texture->bpp = sTexture.bpp;
-				texture->numMipMaps = sTexture.numMipMaps;
-				texture->pixels = new unsigned char[sTexture.size];
-				texture->size = sTexture.size;
-				texture->compressionMethod = static_cast<CompressionMethod>(sTexture.compressionMethod);
-				texture->compressionQuality = sTexture.compressionQuality;
-				texture->wrapMode = static_cast<WrapMode>(sTexture.wrapMode);
-				texture->filterMode = static_cast<FilterMode>(sTexture.filterMode);
-				texture->genMipMaps = sTexture.genMipMaps;
-				texture->maxResolution = sTexture.maxResolution;
-				texture->border = sTexture.border.getValue();
-				if (sTexture.pixels.size() > 0)
-					memcpy(texture->pixels, &sTexture.pixels[0], sTexture.size);
-				sTexture.pixels.clear();
+				error = "[" + name + "] Error loading texture cache: " + e.what();
 			}
+
+			loadedFromCache = true;
+		}
+
+		return loadedFromCache;
+	}
+
+	bool Texture::loadData(Texture* texture, bool setIsPersistent, std::string& error)
+	{
+		ProjectSettings* settings = Engine::getSingleton()->getSettings();
+
+		std::string fullPath = texture->getOrigin();
+		std::string texName = texture->getCachedFileName();
+
+		STexture sTexture;
+		bool loadedFromCache = readCache(texName, texture->name, sTexture, error);
+
+		if (loadedFromCache && !setIsPersistent/* && compression != CompressionMethod::None*/)
+		{
+			//size = sTexture.size;
+
+			texture->width = sTexture.width;
+			texture->height = sTexture.height;
+			texture->originalWidth = sTexture.originalWidth;
+			texture->originalHeight = sTexture.originalHeight;
+			texture->bpp = sTexture.bpp;
+			texture->numMipMaps = sTexture.numMipMaps;
+			texture->pixels = new unsigned char[sTexture.size];
+			texture->size = sTexture.size;
+			texture->compressionMethod = static_cast<CompressionMethod>(sTexture.compressionMethod);
+			texture->compressionQuality = sTexture.compressionQuality;
+			texture->wrapMode = static_cast<WrapMode>(sTexture.wrapMode);
+			texture->filterMode = static_cast<FilterMode>(sTexture.filterMode);
+			texture->genMipMaps = sTexture.genMipMaps;
+			texture->maxResolution = sTexture.maxResolution;
+			texture->border = sTexture.border.getValue();
+			if (sTexture.pixels.size() > 0)
+				memcpy(texture->pixels, &sTexture.pixels[0], sTexture.size);
+			sTexture.pixels.clear();
+
+			if (sTexture.textureFormat >= 0)
+				texture->format = static_cast<bgfx::TextureFormat::Enum>(sTexture.textureFormat);
 			else
 			{
-				//Load from source and create cache
-				FREE_IMAGE_FORMAT formato = FreeImage_GetFileType(fullPath.c_str(), 0);
-				FIBITMAP* imagen = FreeImage_Load(formato, fullPath.c_str());
-				if (imagen == nullptr)
-					return nullptr;
+				//Old caches are either RGBA16 or BC7
+				CompressionMethod _compression = texture->compressionMethod;
+				if (_compression == CompressionMethod::Default)
+					_compression = static_cast<CompressionMethod>(settings->getTextureCompression());
 
-				if (FreeImage_GetBPP(imagen) != 32)
-				{
-					FIBITMAP* convert = FreeImage_ConvertTo32Bits(imagen);
-					FreeImage_Unload(imagen);
-					imagen = convert;
-				}
+				texture->format = _compression == CompressionMethod::None ? bgfx::TextureFormat::RGBA16 : bgfx::TextureFormat::BC7;
+			}
+		}
+		else
+		{
+			//Load from source and create cache
+			texture->compressedBlocks = 0;
+			texture->totalBlocks = 0;
 
-				int maxRes = texture->maxResolution;
-				if (maxRes == 0)
-					maxRes = settings->getTextureMaxResolution();
-				if (texture->persistent)
-					maxRes = 4096;
+			FREE_IMAGE_FORMAT formato = FreeImage_GetFileType(fullPath.c_str(), 0);
+			FIBITMAP* imagen = FreeImage_Load(formato, fullPath.c_str());
+			if (imagen == nullptr)
+				return false;
 
-				int w = FreeImage_GetWidth(imagen);
-				int h = FreeImage_GetHeight(imagen);
-				
-				size_t u2 = 1; while (u2 < w) u2 *= 2;
-				size_t v2 = 1; while (v2 < h) v2 *= 2;
+			if (FreeImage_GetBPP(imagen) != 32)
+			{
+				FIBITMAP* convert = FreeImage_ConvertTo32Bits(imagen);
+				FreeImage_Unload(imagen);
+				imagen = convert;
+			}
 
-				if (u2 > 1)
-				{
-					int pw = u2 / 2;
-					if (w - pw < u2 - w)
-						u2 = pw;
-				}
+			int maxRes = texture->maxResolution;
+			if (maxRes == 0)
+				maxRes = settings->getTextureMaxResolution();
+			if (texture->persistent)
+				maxRes = 4096;
 
-				if (v2 > 1)
-				{
-					int ph = v2 / 2;
-					if (h - ph < v2 - h)
-						v2 = ph;
-				}
+			int w = FreeImage_GetWidth(imagen);
+			int h = FreeImage_GetHeight(imagen);
+			
+			size_t u2 = 1; while (u2 < w) u2 *= 2;
+			size_t v2 = 1; while (v2 < h) v2 *= 2;
 
-				int w2 = std::min((int)u2, maxRes);
-				int h2 = std::min((int)v2, maxRes);
+			if (u2 > 1)
+			{
+				int pw = u2 / 2;
+				if (w - pw < u2 - w)
+					u2 = pw;
+			}
 
-				texture->originalWidth = w;
-				texture->originalHeight = h;
+			if (v2 > 1)
+			{
+				int ph = v2 / 2;
+				if (h - ph < v2 - h)
+					v2 = ph;
+			}
 
-				if (w != w2 || h != h2 || w != h)
-				{
-					int s = std::max(w2, h2);
+			int w2 = std::min((int)u2, maxRes);
+			int h2 = std::min((int)v2, maxRes);
 
-					FIBITMAP* scaled = FreeImage_Rescale(imagen, s, s, FREE_IMAGE_FILTER::FILTER_BOX);
-					FreeImage_Unload(imagen);
-					imagen = scaled;
-				}
+			texture->originalWidth = w;
+			texture->originalHeight = h;
+
+			if (w != w2 || h != h2 || w != h)
+			{
+				int s = std::max(w2, h2);
 
-				texture->width = FreeImage_GetWidth(imagen);
-				texture->height = FreeImage_GetHeight(imagen);
-				texture->bpp = FreeImage_GetBPP(imagen);
+				FIBITMAP* scaled = FreeImage_Rescale(imagen, s, s, FREE_IMAGE_FILTER::FILTER_BOX);
+				FreeImage_Unload(imagen);
+				imagen = scaled;
+			}
 
-				int size = 0;
+			texture->width = FreeImage_GetWidth(imagen);
+			texture->height = FreeImage_GetHeight(imagen);
+			texture->bpp = FreeImage_GetBPP(imagen);
 
-				CompressionMethod _compression = texture->compressionMethod;
-				if (_compression == CompressionMethod::Default)
-					_compression = static_cast<CompressionMethod>(settings->getTextureCompression());
+			int size = 0;
 
-				int _compressionQuality = texture->compressionQuality - 1;
-				if (_compressionQuality == -1)
-					_compressionQuality = settings->getTextureCompressionQuality();
+			CompressionMethod _compression = texture->compressionMethod;
+			if (_compression == CompressionMethod::Default)
+				_compression = static_cast<CompressionMethod>(settings->getTextureCompression());
+			if (_compression == CompressionMethod::Auto)
+				_compression = selectCompressionMethod(imagen, texture->name);
 
-				if (texture->genMipMaps)
+			int _compressionQuality = texture->compressionQuality - 1;
+			if (_compressionQuality == -1)
+				_compressionQuality = settings->getTextureCompressionQuality();
+
+			texture->format = getTextureFormat(_compression);
+
+			//Uncompressed data is uploaded as is, so reorder it to RGBA8 once
+			if (_compression == CompressionMethod::None)
+				swizzleToRGBA8(imagen);
+
+			if (texture->genMipMaps)
+				size = texture->generateMipMaps(imagen, _compression, _compressionQuality);
+			else
+			{
+				if (_compression != CompressionMethod::None)
 				{
-					if (_compression == CompressionMethod::None)
-					{
-						FIBITMAP* _imagen = FreeImage_ConvertToRGBA16(imagen);
-						FreeImage_Unload(imagen);
-						imagen = _imagen;
-						texture->bpp = FreeImage_GetBPP(imagen);
-					}
+					color_quad_u8_vec pixels;
+					size = bcsize(toBcFormat(_compression), texture->width, texture->height);
+					texture->pixels = new unsigned char[size];
+					copyPixels(pixels, imagen, texture->width, texture->height);
+
+					std::vector<bc_image> images(1);
+					images[0].pixels = pixels.data();
+					images[0].width = texture->width;
+					images[0].height = texture->height;
+					images[0].output = texture->pixels;
 
-					size = texture->generateMipMaps(imagen);
+					texture->compressBlocks(images, _compression, _compressionQuality);
+					pixels.clear();
 				}
 				else
 				{
-					if (_compression == CompressionMethod::BC7)
-					{
-						color_quad_u8_vec pixels;
-						uint32_t imageSize = (((texture->width + 3) & ~3) * ((texture->height + 3) & ~3) * 8) >> 3;
-						texture->pixels = new unsigned char[imageSize];
-						copyPixels(pixels, imagen, texture->width, texture->height);
-						bc7compress(pixels, texture->width, texture->height, texture->pixels, size, _compressionQuality);
-						pixels.clear();
-					}
-					else
-					{
-						FIBITMAP* _imagen = FreeImage_ConvertToRGBA16(imagen);
-						FreeImage_Unload(imagen);
-						imagen = _imagen;
-						texture->bpp = FreeImage_GetBPP(imagen);
-
-						size = (texture->bpp / 8) * (texture->width * texture->height);
-						texture->pixels = new unsigned char[size];
-						memcpy(texture->pixels, FreeImage_GetBits(imagen), size);
-					}
+					size = (texture->bpp / 8) * (texture->width * texture->height);
+					texture->pixels = new unsigned char[size];
+					memcpy(texture->pixels, FreeImage_GetBits(imagen), size);
 				}
+			}
 
-				texture->size = size;
+			texture->size = size;
 
-				FreeImage_Unload(imagen);
+			FreeImage_Unload(imagen);
 
-				//if (compression != CompressionMethod::None)
-				if (!setIsPersistent)
-					texture->save(texName);
+			//Import was cancelled. Do not leave a broken cache behind
+			if (texture->isLoadingCancelled())
+			{
+				error = "[" + texture->name + "] Texture import cancelled";
+				return false;
 			}
 
-			CompressionMethod _compression = texture->compressionMethod;
-			if (_compression == CompressionMethod::Default)
-				_compression = static_cast<CompressionMethod>(settings->getTextureCompression());
+			//if (compression != CompressionMethod::None)
+			if (!setIsPersistent)
+				texture->save(texName);
+		}
 
-			if (_compression == CompressionMethod::None)
-				texture->format = bgfx::TextureFormat::RGBA16;
-			else if (_compression == CompressionMethod::BC7)
-				texture->format = bgfx::TextureFormat::BC7;
+		//Higher mips can be read back from the cache later, so only a part of the chain has to stay on the GPU
+		int numMips = static_cast<int>(std::floor(std::log2(std::max(texture->width, 1)))) + 1;
+		texture->streamable = !setIsPersistent
+			&& texture->genMipMaps
+			&& texture->width == texture->height
+			&& texture->numMipMaps == numMips
+			&& texture->textureType == TextureType::Texture2D;
 
-			texture->mem = bgfx::makeRef(reinterpret_cast<const void*>(texture->pixels), texture->size, releaseDataCallback, reinterpret_cast<void*>(texture));
-			texture->textureHandle = bgfx::createTexture2D(uint16_t(texture->width), uint16_t(texture->height), texture->genMipMaps, 1, texture->format, texture->getState(), texture->mem);
-			
-			if (cb != nullptr)
-				cb(texture->pixels, texture->size);
+		return true;
+	}
 
-			texture->load();
+	uint32_t Texture::getMipOffset(bgfx::TextureFormat::Enum format, int width, int height, int mip)
+	{
+		uint32_t offset = 0;
+
+		for (int i = 0; i < mip; ++i)
+		{
+			bgfx::TextureInfo info;
+			bgfx::calcTextureSize(info, uint16_t(std::max(width >> i, 1)), uint16_t(std::max(height >> i, 1)), 1, false, false, 1, format);
+			offset += info.storageSize;
+		}
+
+		return offset;
+	}
+
+	unsigned char* Texture::readMipLevels(std::string texName, uint32_t offset, uint32_t size)
+	{
+		STexture sTexture;
+		sTexture.skipPixels = true;
+
+		std::string error = "";
+		unsigned char* data = nullptr;
+
+		//Only the header is deserialized, then the requested range is read directly
+		bool result = readCache(texName, "", sTexture, error, [&](std::istream& stream)
+			{
+				//Cache was rebuilt with different settings since the texture was loaded
+				if ((uint32_t)sTexture.size != size || (uint32_t)sTexture.pixelsSize < size || offset >= size)
+					return;
+
+				stream.seekg(offset, std::ios_base::cur);
+
+				data = new unsigned char[size - offset];
+				stream.read(reinterpret_cast<char*>(data), size - offset);
+
+				if (!stream)
+				{
+					delete[] data;
+					data = nullptr;
+				}
+			}
+		);
 
+		if (!result || !error.empty())
+		{
+			delete[] data;
+			return nullptr;
+		}
+
+		return data;
+	}
+
+	void Texture::createTextureHandle()
+	{
+		int startMip = 0;
+		if (streamable && !keepData)
+			startMip = TextureStreamer::getSingleton()->getStartMip(this);
+
+		if (startMip > 0)
+		{
+			//Only the tail of the mip chain is uploaded. Finer levels are streamed in when they become visible
+			uint32_t offset = getMipOffset(format, width, height, startMip);
+			const bgfx::Memory* tail = bgfx::copy(pixels + offset, size - offset);
+			textureHandle = bgfx::createTexture2D(uint16_t(width >> startMip), uint16_t(height >> startMip), true, 1, format, getState(), tail);
+
+			delete[] pixels;
+			pixels = nullptr;
+			mem = nullptr;
+
+			residentMip = startMip;
+			TextureStreamer::getSingleton()->addTexture(this);
+
+			return;
+		}
+
+		residentMip = 0;
+
+		mem = bgfx::makeRef(reinterpret_cast<const void*>(pixels), size, releaseDataCallback, reinterpret_cast<void*>(this));
+		textureHandle = bgfx::createTexture2D(uint16_t(width), uint16_t(height), genMipMaps, 1, format, getState(), mem);
+	}
+
+	Texture* Texture::load(std::string location, std::string name, bool genMipMaps, CompressionMethod compression, bool setIsPersistent, bool warn, std::function<void(unsigned char* data, size_t size)> cb)
+	{
+		Texture* texture = getInstanceForLoad(location, name, genMipMaps, compression, setIsPersistent, warn);
+
+		if (texture == nullptr || texture->isLoaded())
 			return texture;
+
+		//Already requested with loadAsync. Finish it now
+		if (texture->isLoading())
+		{
+			AsyncLoader::getSingleton()->wait(texture);
+			return texture->isLoaded() ? texture : nullptr;
 		}
+
+		std::string error = "";
+		bool result = loadData(texture, setIsPersistent, error);
+
+		if (!error.empty())
+			Debug::log(error);
+
+		texture->logCompressionStats();
+
+		if (!result)
+			return nullptr;
+
+		//Callback needs the whole mip chain
+		if (cb != nullptr)
+			texture->streamable = false;
+
+		texture->createTextureHandle();
+
+		if (cb != nullptr)
+			cb(texture->pixels, texture->size);
+
+		texture->load();
+
+		return texture;
+	}
+
+	Texture* Texture::loadAsync(std::string location, std::string name, bool genMipMaps, CompressionMethod compression, bool setIsPersistent, std::function<void(Texture* texture)> onLoaded)
+	{
+		Texture* texture = getInstanceForLoad(location, name, genMipMaps, compression, setIsPersistent, false);
+
+		if (texture == nullptr || texture->isLoaded() || texture->isLoading())
+			return texture;
+
+		//Register right away, so following requests for the same texture get this instance
+		setLoadedInstance(location, name, texture);
+
+		texture->importing = !setIsPersistent && !IO::FileExists(texture->getCachedFileName());
+
+		std::shared_ptr<std::string> error = std::make_shared<std::string>();
+		std::shared_ptr<bool> result = std::make_shared<bool>(false);
+
+		AsyncLoader::getSingleton()->schedule(texture,
+			[=]()
+			{
+				*result = loadData(texture, setIsPersistent, *error);
+			},
+			[=]()
+			{
+				if (!error->empty())
+					Debug::log(*error);
+
+				texture->logCompressionStats();
+
+				texture->importing = false;
+
+				if (!*result)
+					return;
+
+				texture->createTextureHandle();
+				texture->Asset::load();
+
+				if (onLoaded != nullptr)
+					onLoaded(texture);
+			}
+		);
+
+		return texture;
 	}
 
 	Texture* Texture::create(std::string location, std::string name, int w, int h, int numLayers, TextureType type, bgfx::TextureFormat::Enum format, unsigned char* data, size_t size, bool genMipMaps, bool keepTexData)
@@ -610,7 +937,7 @@ namespace GX
 					texture->bpp = 32;
 					texture->compressionMethod = Texture::CompressionMethod::None;
 
-					int sz = texture->generateMipMaps(imagen);
+					int sz = texture->generateMipMaps(imagen, Texture::CompressionMethod::None, 0);
 					texture->size = sz;
 
 					FreeImage_Unload(imagen);
@@ -694,6 +1021,7 @@ namespace GX
 		sTexture.genMipMaps = genMipMaps;
 		sTexture.maxResolution = maxResolution;
 		sTexture.border = border;
+		sTexture.textureFormat = static_cast<int>(format);
 		sTexture.pixels.resize(size);
 		memcpy(&sTexture.pixels[0], pixels, size);
 
@@ -734,6 +1062,28 @@ namespace GX
 		updateTextureCb(false);
 	}
 
+	void Texture::updateTextureRegion(int x, int y, int w, int h)
+	{
+		if (immutable || pixels == nullptr)
+			return;
+
+		x = std::max(x, 0);
+		y = std::max(y, 0);
+		w = std::min(w, width - x);
+		h = std::min(h, height - y);
+
+		if (w <= 0 || h <= 0)
+			return;
+
+		//Rows are read from the full size data
+		uint32_t pixelSize = size / (width * height);
+		uint32_t pitch = width * pixelSize;
+		uint32_t offset = y * pitch + x * pixelSize;
+
+		mem = bgfx::makeRef(reinterpret_cast<const void*>(pixels + offset), (h - 1) * pitch + w * pixelSize);
+		bgfx::updateTexture2D(textureHandle, 0, 0, x, y, w, h, mem, pitch);
+	}
+
 	void Texture::updateTextureCb(bool cb)
 	{
 		if (cb)
@@ -817,26 +1167,70 @@ namespace GX
 		}
 	}
 
-	int Texture::generateMipMaps(FIBITMAP* bitmap)
+	bool Texture::compressBlocks(std::vector<bc_image>& images, CompressionMethod compression, int quality)
+	{
+		bc_format format = toBcFormat(compression);
+
+		uint64_t total = 0;
+		for (auto& image : images)
+			total += bcsize(format, image.width, image.height) / bcblocksize(format);
+
+		compressedBlocks = 0;
+		totalBlocks = total;
+
+		bc_stats stats;
+		bool result = bccompress(images, format, quality, &loadingCancelled, &compressedBlocks, &stats);
+
+		compressionMethodUsed = compression;
+		compressionQualityUsed = quality;
+		compressionTime = stats.seconds;
+
+		return result;
+	}
+
+	void Texture::logCompressionStats()
+	{
+		//Debug log is not thread safe, so stats are reported after loading is done
+		if (compressionTime <= 0.0)
+			return;
+
+		if (!logCompressionStatsEnabled)
+		{
+			compressionTime = 0.0;
+			return;
+		}
+
+		double blocksPerSecond = double(totalBlocks.load()) / compressionTime;
+
+		Debug::log("[" + name + "] " + getCompressionMethodName(compressionMethodUsed) + " quality " + std::to_string(compressionQualityUsed) + ": "
+			+ std::to_string(totalBlocks.load()) + " blocks in " + std::to_string(int(compressionTime * 1000.0)) + " ms ("
+			+ std::to_string(int64_t(blocksPerSecond)) + " blocks/s)");
+
+		compressionTime = 0.0;
+	}
+
+	float Texture::getImportProgress()
+	{
+		uint64_t total = totalBlocks;
+		if (total == 0)
+			return 1.0f;
+
+		return float(double(compressedBlocks.load()) / double(total));
+	}
+
+	int Texture::generateMipMaps(FIBITMAP* bitmap, CompressionMethod compression, int quality)
 	{
 		int width = FreeImage_GetWidth(bitmap);
 		int height = FreeImage_GetHeight(bitmap);
 		int bpp = FreeImage_GetBPP(bitmap);
 
-		int size0 = (bpp / 8) * width * height;
+		bool compressed = compression != CompressionMethod::None;
+		bc_format format = toBcFormat(compression);
 
-		ProjectSettings* settings = Engine::getSingleton()->getSettings();
-
-		CompressionMethod _compression = compressionMethod;
-		if (_compression == CompressionMethod::Default)
-			_compression = static_cast<CompressionMethod>(settings->getTextureCompression());
-
-		int _compressionQuality = compressionQuality - 1;
-		if (_compressionQuality == -1)
-			_compressionQuality = settings->getTextureCompressionQuality();
+		int size0 = (bpp / 8) * width * height;
 
-		if (_compression == CompressionMethod::BC7)
-			size0 = (((width + 3) & ~3) * ((height + 3) & ~3) * 8) >> 3;
+		if (compressed)
+			size0 = bcsize(format, width, height);
 		
 		int size = size0;
 
@@ -850,8 +1244,8 @@ namespace GX
 			int _w = floor(width / div);
 			int _h = floor(height / div);
 
-			if (_compression == CompressionMethod::BC7)
-				size += (((_w + 3) & ~3) * ((_h + 3) & ~3) * 8) >> 3;
+			if (compressed)
+				size += bcsize(format, _w, _h);
 			else
 				size += (bpp / 8) * (_w * _h);
 			
@@ -860,13 +1254,22 @@ namespace GX
 
 		pixels = new unsigned char[size];
 
-		if (_compression == CompressionMethod::BC7)
+		//Compressed levels are collected first and encoded in one batch on job threads
+		std::vector<color_quad_u8_vec> sources;
+		std::vector<bc_image> images;
+
+		if (compressed)
 		{
-			int sz0 = 0;
-			color_quad_u8_vec dst;
-			copyPixels(dst, bitmap, width, height);
-			bc7compress(dst, width, height, pixels, sz0, _compressionQuality);
-			dst.clear();
+			sources.reserve(numMips);
+
+			sources.push_back(color_quad_u8_vec());
+			copyPixels(sources.back(), bitmap, width, height);
+
+			bc_image image;
+			image.width = width;
+			image.height = height;
+			image.output = pixels;
+			images.push_back(image);
 		}
 		else
 			memcpy(pixels, FreeImage_GetBits(bitmap), size0);
@@ -892,18 +1295,18 @@ namespace GX
 
 			int sz = (bpp / 8) * ww * hh;
 
-			if (_compression == CompressionMethod::BC7)
-				sz = (((ww + 3) & ~3) * ((hh + 3) & ~3) * 8) >> 3;
-
-			if (_compression == CompressionMethod::BC7)
+			if (compressed)
 			{
-				color_quad_u8_vec dst;
-				unsigned char* dt = new unsigned char[sz];
-				copyPixels(dst, scaled, ww, hh);
-				bc7compress(dst, ww, hh, dt, sz, _compressionQuality);
-				memcpy(pixels + offset, dt, sz);
-				dst.clear();
-				delete[] dt;
+				sz = bcsize(format, ww, hh);
+
+				sources.push_back(color_quad_u8_vec());
+				copyPixels(sources.back(), scaled, ww, hh);
+
+				bc_image image;
+				image.width = ww;
+				image.height = hh;
+				image.output = pixels + offset;
+				images.push_back(image);
 			}
 			else
 				memcpy(pixels + offset, FreeImage_GetBits(scaled), sz);
@@ -913,6 +1316,14 @@ namespace GX
 			div *= 2;
 		}
 
+		if (!images.empty())
+		{
+			for (size_t i = 0; i < images.size(); ++i)
+				images[i].pixels = sources[i].data();
+
+			compressBlocks(images, compression, quality);
+		}
+
 		if (prevScaled != bitmap)
 			FreeImage_Unload(prevScaled);
 
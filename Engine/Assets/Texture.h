@@ -1,6 +1,8 @@
 #pragma once
 
+#include <atomic>
 #include <string>
+#include <vector>
 #include <functional>
 
 #include "Asset.h"
@@ -13,15 +15,19 @@
 #undef None
 
 struct FIBITMAP;
+struct bc_image;
 
 namespace GX
 {
+	class STexture;
+
 	class Texture : public Asset
 	{
 		friend class Renderer;
 		friend class Asset;
 		friend class RenderTexture;
 		friend class Camera;
+		friend class TextureStreamer;
 
 	public:
 		enum class TextureType
@@ -34,8 +40,13 @@ namespace GX
 		enum class CompressionMethod
 		{
 			Default,
-			None,
-			BC7
+			None, //RGBA8
+			BC7,
+			BC1,
+			BC3,
+			BC4, //Single channel, sampled as red
+			BC5, //Two channels, normal maps. Shader has to restore Z
+			Auto //Picked on import: BC7 for normal maps, BC3 with alpha, BC1 otherwise
 		};
 
 		enum class WrapMode
@@ -80,11 +91,40 @@ namespace GX
 		bgfx::TextureFormat::Enum format = bgfx::TextureFormat::BC7;
 
 		TextureType textureType = TextureType::Texture2D;
-		int generateMipMaps(FIBITMAP * bitmap);
+		int generateMipMaps(FIBITMAP * bitmap, CompressionMethod compression, int quality);
+
+		//Block compression import progress. Updated from job threads
+		std::atomic<uint64_t> compressedBlocks = { 0 };
+		std::atomic<uint64_t> totalBlocks = { 0 };
+		CompressionMethod compressionMethodUsed = CompressionMethod::None;
+		int compressionQualityUsed = 0;
+		double compressionTime = 0.0;
+		bool importing = false; //Source file is decoded because there is no cache yet
+
+		static bool logCompressionStatsEnabled;
+
+		bool compressBlocks(std::vector<bc_image>& images, CompressionMethod compression, int quality);
+		void logCompressionStats();
+
+		static CompressionMethod selectCompressionMethod(FIBITMAP* bitmap, std::string name);
 
 		static void releaseDataCallback(void* _ptr, void* _userData);
 		void updateTextureCb(bool cb);
 
+		static Texture* getInstanceForLoad(std::string location, std::string name, bool genMipMaps, CompressionMethod compression, bool setIsPersistent, bool warn);
+		static bool loadData(Texture* texture, bool setIsPersistent, std::string& error); //Reads cache or decodes source file. Safe to call from job threads
+		//onRead gets the stream right after sTexture is read, before it is closed
+		static bool readCache(std::string texName, std::string name, STexture& sTexture, std::string& error, std::function<void(std::istream& stream)> onRead = nullptr);
+		void createTextureHandle();
+
+		//Streaming. Textures read from cache with a full mip chain are uploaded starting from residentMip
+		bool streamable = false;
+		bool streamed = false; //Set once a renderer requested mips of this texture. Textures nobody requests keep the whole chain
+		int residentMip = 0;
+
+		static uint32_t getMipOffset(bgfx::TextureFormat::Enum format, int width, int height, int mip);
+		static unsigned char* readMipLevels(std::string texName, uint32_t offset, uint32_t size); //Safe to call from job threads
+
 	public:
 		Texture();
 		virtual ~Texture();
@@ -97,6 +137,18 @@ namespace GX
 		virtual void reload();
 		virtual std::string getAssetType() { return ASSET_TYPE; }
 
+		//0..1 while the texture is being compressed on import
+		float getImportProgress();
+		//Loading asynchronously from the source file. Such requests can be cancelled with AsyncLoader::cancel
+		bool isImporting() { return isLoading() && importing; }
+
+		//Logs block count, time and blocks/s of every compressed import
+		static bool getLogCompressionStats() { return logCompressionStatsEnabled; }
+		static void setLogCompressionStats(bool value) { logCompressionStatsEnabled = value; }
+
+		static bgfx::TextureFormat::Enum getTextureFormat(CompressionMethod compression);
+		static std::string getCompressionMethodName(CompressionMethod compression);
+
 		static Texture* load(std::string location,
 			std::string name,
 			bool genMipMaps = true,
@@ -105,6 +157,15 @@ namespace GX
 			bool warn = true,
 			std::function<void(unsigned char* data, size_t size)> cb = nullptr);
 
+		//Decodes on job threads and creates GPU texture later on the main thread. Returned texture is not loaded until then.
+		//onLoaded is called on the main thread after a successful upload
+		static Texture* loadAsync(std::string location,
+			std::string name,
+			bool genMipMaps = true,
+			CompressionMethod compression = CompressionMethod::Default,
+			bool setIsPersistent = false,
+			std::function<void(Texture* texture)> onLoaded = nullptr);
+
 		static Texture* loadFromByteArray(std::string location, std::string name, unsigned char* data, size_t size);
 		static Texture* create(std::string location, std::string name, int w, int h, int numLayers, TextureType type, bgfx::TextureFormat::Enum format = bgfx::TextureFormat::BGRA8, unsigned char* data = nullptr, size_t size = 0, bool genMipMaps = false, bool keepTexData = false);
 		void save();
@@ -114,6 +175,7 @@ namespace GX
 		void freeData();
 		unsigned char*& getData() { return pixels; }
 		void updateTexture();
+		void updateTextureRegion(int x, int y, int w, int h); //Uploads only the given pixels of a dynamic texture
 
 		bgfx::TextureHandle getHandle() { return textureHandle; }
 		TextureType getTextureType() { return textureType; }
@@ -152,6 +214,7 @@ namespace GX
 		int getOriginalHeight() { return originalHeight; }
 		int getBpp() { return bpp; }
 		int getNumMipMaps() { return numMipMaps; }
+		int getResidentMip() { return residentMip; }
 		int getSize() { return size; }
 		bool getImmutable() { return immutable; }
 		Rect getBorder() { return border; }
@@ -1,17 +1,254 @@
 #include "ZipHelper.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 #include "../../LibZip/include/zip.h"
 
 #include "StringConverter.h"
 
-#ifndef _WIN32
-#include <cstring>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 namespace GX
 {
+	struct ZipEntryLocation
+	{
+	public:
+		size_t offset = 0;
+		size_t size = 0;
+	};
+
+	struct MappedZipArchive
+	{
+	public:
+		const char* data = nullptr;
+		size_t size = 0;
+
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+#endif
+
+		//Stored entries only. Compressed entries go through libzip
+		std::unordered_map<std::string, ZipEntryLocation> storedEntries;
+	};
+
+	static std::map<zip_t*, MappedZipArchive*> mappedArchives;
+	static std::mutex mappedArchivesMutex;
+
+	//libzip archive handles are not thread safe. Assets can be loaded from job threads
+	static std::mutex zipMutex;
+
+	//Compressed entries are inflated in blocks of this size
+	static const size_t ZIP_READ_BLOCK_SIZE = 1024 * 1024;
+
+	static inline uint16_t readU16(const char* p)
+	{
+		const unsigned char* b = (const unsigned char*)p;
+		return (uint16_t)(b[0] | (b[1] << 8));
+	}
+
+	static inline uint32_t readU32(const char* p)
+	{
+		const unsigned char* b = (const unsigned char*)p;
+		return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+	}
+
+	//Reads central directory and collects data locations of stored entries
+	static void indexStoredEntries(MappedZipArchive* archive)
+	{
+		const char* data = archive->data;
+		size_t size = archive->size;
+
+		if (size < 22)
+			return;
+
+		//Find end of central directory record
+		size_t eocd = SIZE_MAX;
+		size_t searchEnd = size > 22 + 0xFFFF ? size - 22 - 0xFFFF : 0;
+		for (size_t i = size - 22 + 1; i-- > searchEnd;)
+		{
+			if (readU32(data + i) == 0x06054b50)
+			{
+				eocd = i;
+				break;
+			}
+		}
+
+		if (eocd == SIZE_MAX)
+			return;
+
+		uint16_t numEntries = readU16(data + eocd + 10);
+		size_t cdOffset = readU32(data + eocd + 16);
+		size_t pos = cdOffset;
+
+		for (uint16_t i = 0; i < numEntries; ++i)
+		{
+			if (pos + 46 > size || readU32(data + pos) != 0x02014b50)
+				break;
+
+			uint16_t flags = readU16(data + pos + 8);
+			uint16_t method = readU16(data + pos + 10);
+			uint32_t compSize = readU32(data + pos + 20);
+			uint32_t uncompSize = readU32(data + pos + 24);
+			uint16_t nameLen = readU16(data + pos + 28);
+			uint16_t extraLen = readU16(data + pos + 30);
+			uint16_t commentLen = readU16(data + pos + 32);
+			uint32_t localOffset = readU32(data + pos + 42);
+
+			if (pos + 46 + nameLen > size)
+				break;
+
+			std::string name(data + pos + 46, nameLen);
+
+			//Zip64 and encrypted entries are left to libzip
+			bool stored = method == ZIP_CM_STORE && !(flags & 1) && compSize == uncompSize
+				&& compSize != 0xFFFFFFFF && localOffset != 0xFFFFFFFF;
+
+			if (stored && (size_t)localOffset + 30 <= size && readU32(data + localOffset) == 0x04034b50)
+			{
+				size_t dataOffset = (size_t)localOffset + 30 + readU16(data + localOffset + 26) + readU16(data + localOffset + 28);
+
+				if (dataOffset + compSize <= size)
+				{
+					ZipEntryLocation loc;
+					loc.offset = dataOffset;
+					loc.size = compSize;
+
+					archive->storedEntries[name] = loc;
+				}
+			}
+
+			pos += 46 + nameLen + extraLen + commentLen;
+		}
+	}
+
+	static void unmapArchiveFile(MappedZipArchive* archive)
+	{
+#ifdef _WIN32
+		if (archive->data != nullptr)
+			UnmapViewOfFile(archive->data);
+		if (archive->mapping != NULL)
+			CloseHandle(archive->mapping);
+		if (archive->file != INVALID_HANDLE_VALUE)
+			CloseHandle(archive->file);
+#else
+		if (archive->data != nullptr)
+			munmap((void*)archive->data, archive->size);
+#endif
+
+		archive->data = nullptr;
+		archive->size = 0;
+	}
+
+	static bool mapArchiveFile(MappedZipArchive* archive, std::string path)
+	{
+#ifdef _WIN32
+		archive->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (archive->file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(archive->file, &fileSize) || fileSize.QuadPart == 0)
+		{
+			unmapArchiveFile(archive);
+			return false;
+		}
+
+		archive->mapping = CreateFileMappingA(archive->file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (archive->mapping == NULL)
+		{
+			unmapArchiveFile(archive);
+			return false;
+		}
+
+		archive->data = (const char*)MapViewOfFile(archive->mapping, FILE_MAP_READ, 0, 0, 0);
+		archive->size = (size_t)fileSize.QuadPart;
+#else
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			return false;
+
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		void* ptr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		close(fd);
+
+		if (ptr == MAP_FAILED)
+			return false;
+
+		archive->data = (const char*)ptr;
+		archive->size = (size_t)st.st_size;
+#endif
+
+		if (archive->data == nullptr)
+		{
+			unmapArchiveFile(archive);
+			return false;
+		}
+
+		return true;
+	}
+
+	//ZipFileData
+
+	ZipFileData::~ZipFileData()
+	{
+		if (buffer != nullptr)
+			delete[] buffer;
+	}
+
+	ZipFileData::ZipFileData(ZipFileData&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	ZipFileData& ZipFileData::operator=(ZipFileData&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (buffer != nullptr)
+				delete[] buffer;
+
+			data = other.data;
+			size = other.size;
+			buffer = other.buffer;
+			valid = other.valid;
+
+			other.data = nullptr;
+			other.size = 0;
+			other.buffer = nullptr;
+			other.valid = false;
+		}
+
+		return *this;
+	}
+
+	//ZipHelper
+
 	bool ZipHelper::isFileInZip(zip_t* zip, std::string path)
 	{
+		std::lock_guard<std::mutex> lock(zipMutex);
+
 		int err;
 		struct zip_stat sb;
 
@@ -22,35 +259,84 @@ namespace GX
 
 	char* ZipHelper::readFileFromZip(zip_t* zip, std::string path, int& outBufSize)
 	{
-		struct zip_file* zf;
-		struct zip_stat sb;
-		char buf[100];
-		int err;
-		int i, len;
-		long long sum;
+		ZipFileData file = openFile(zip, path);
+
+		outBufSize = (int)file.size;
+
+		char* _output = file.buffer;
+		if (_output == nullptr)
+		{
+			_output = new char[file.size];
+			if (file.size > 0)
+				memcpy(_output, file.data, file.size);
+		}
+
+		file.buffer = nullptr;
 
-		zip_stat(zip, CP_UNI(path).c_str(), ZIP_FL_ENC_UTF_8, &sb);
-		zf = zip_fopen(zip, CP_UNI(path).c_str(), ZIP_FL_ENC_UTF_8);
+		return _output;
+	}
 
-		char* _output = new char[sb.size];
+	ZipFileData ZipHelper::openFile(zip_t* zip, std::string path)
+	{
+		ZipFileData file;
+		std::string name = CP_UNI(path);
 
-		sum = 0;
-		while (sum != sb.size)
 		{
-			len = zip_fread(zf, buf, 100);
-			memcpy(_output + sum, buf, len);
-			sum += len;
+			std::lock_guard<std::mutex> lock(mappedArchivesMutex);
+
+			auto it = mappedArchives.find(zip);
+			if (it != mappedArchives.end())
+			{
+				MappedZipArchive* archive = it->second;
+
+				auto entry = archive->storedEntries.find(name);
+				if (entry != archive->storedEntries.end())
+				{
+					file.data = archive->data + entry->second.offset;
+					file.size = entry->second.size;
+					file.valid = true;
+
+					return file;
+				}
+			}
 		}
 
-		outBufSize = sb.size;
+		std::lock_guard<std::mutex> lock(zipMutex);
+
+		struct zip_stat sb;
+		if (zip_stat(zip, name.c_str(), ZIP_FL_ENC_UTF_8, &sb) < 0)
+			return file;
+
+		struct zip_file* zf = zip_fopen(zip, name.c_str(), ZIP_FL_ENC_UTF_8);
+		if (zf == nullptr)
+			return file;
+
+		file.buffer = new char[sb.size];
+		file.data = file.buffer;
+		file.size = sb.size;
+
+		size_t sum = 0;
+		while (sum < file.size)
+		{
+			size_t block = std::min(file.size - sum, ZIP_READ_BLOCK_SIZE);
+			zip_int64_t len = zip_fread(zf, file.buffer + sum, block);
+			if (len <= 0)
+				break;
+
+			sum += (size_t)len;
+		}
 
 		zip_fclose(zf);
 
-		return _output;
+		file.valid = sum == file.size;
+
+		return file;
 	}
 
 	std::vector<std::string> ZipHelper::getAllFilesNamesInZip(zip_t* zip)
 	{
+		std::lock_guard<std::mutex> lock(zipMutex);
+
 		struct zip_stat sb;
 
 		std::vector<std::string> outVec;
@@ -64,4 +350,46 @@ namespace GX
 
 		return outVec;
 	}
+
+	void ZipHelper::mapArchive(zip_t* zip, std::string path)
+	{
+		std::lock_guard<std::mutex> lock(mappedArchivesMutex);
+
+		if (mappedArchives.find(zip) != mappedArchives.end())
+			return;
+
+		MappedZipArchive* archive = new MappedZipArchive();
+
+		if (!mapArchiveFile(archive, path))
+		{
+			delete archive;
+			return;
+		}
+
+		indexStoredEntries(archive);
+
+		//Nothing to read directly, so do not keep the mapping
+		if (archive->storedEntries.empty())
+		{
+			unmapArchiveFile(archive);
+			delete archive;
+			return;
+		}
+
+		mappedArchives[zip] = archive;
+	}
+
+	void ZipHelper::unmapArchive(zip_t* zip)
+	{
+		std::lock_guard<std::mutex> lock(mappedArchivesMutex);
+
+		auto it = mappedArchives.find(zip);
+		if (it != mappedArchives.end())
+		{
+			unmapArchiveFile(it->second);
+			delete it->second;
+
+			mappedArchives.erase(it);
+		}
+	}
 }
\ No newline at end of file
@@ -8,6 +8,34 @@ typedef struct zip zip_t;
 
 namespace GX
 {
+	//Contents of a file in zip archive. Stored (uncompressed) entries point directly into the mapped archive,
+	//compressed entries own a decompressed buffer
+	class ZipFileData
+	{
+		friend class ZipHelper;
+
+	private:
+		const char* data = nullptr;
+		size_t size = 0;
+		char* buffer = nullptr;
+		bool valid = false;
+
+	public:
+		ZipFileData() = default;
+		~ZipFileData();
+
+		ZipFileData(const ZipFileData&) = delete;
+		ZipFileData& operator=(const ZipFileData&) = delete;
+
+		ZipFileData(ZipFileData&& other) noexcept;
+		ZipFileData& operator=(ZipFileData&& other) noexcept;
+
+		const char* getData() const { return data; }
+		size_t getSize() const { return size; }
+		bool isValid() const { return valid; }
+		bool isMapped() const { return valid && buffer == nullptr; }
+	};
+
 	class ZipHelper
 	{
 	public:
@@ -15,6 +43,13 @@ namespace GX
 
 		static char* readFileFromZip(zip_t* zip, std::string path, int& outBufSize);
 
+		//Returns file contents without extra copies. Memory stays valid until the archive is unmapped
+		static ZipFileData openFile(zip_t* zip, std::string path);
+
 		static std::vector<std::string> getAllFilesNamesInZip(zip_t* zip);
+
+		//Maps archive file into memory so stored entries can be read directly
+		static void mapArchive(zip_t* zip, std::string path);
+		static void unmapArchive(zip_t* zip);
 	};
 }
\ No newline at end of file
@@ -1,86 +1,148 @@
 #include "bc7compressor.h"
 
-void bc7compress(color_quad_u8_vec data, int _width, int _height, unsigned char*& output, int& outputSize, int quality)
+#include <mutex>
+#include <bx/timer.h>
+#include <bx/error.h>
+#include <bimg/encode.h>
+
+#include "../Core/JobSystem.h"
+
+//Rows of 4x4 blocks handed to a job at once
+static const size_t BC_ROWS_PER_JOB = 4;
+
+static std::once_flag bc7InitFlag;
+
+uint32_t bcblocksize(bc_format format)
 {
-	int uber_level = quality;
-	int max_partitions_to_scan = BC7ENC16_MAX_PARTITIONS1;
-	bool perceptual = false;
-	bool y_flip = false;
+	if (format == BC_FORMAT_BC1 || format == BC_FORMAT_BC4)
+		return 8;
 
-	image_u8 source_image;
-	source_image.init(_width, _height);
-	color_quad_u8_vec& src = source_image.get_pixels();
-	src = data;
+	return 16;
+}
 
-	const uint32_t orig_width = source_image.width();
-	const uint32_t orig_height = source_image.height();
+uint32_t bcsize(bc_format format, uint32_t width, uint32_t height)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * bcblocksize(format);
+}
 
-	if (y_flip)
+//Reads 4x4 block. Pixels outside of the image are black, same as with cropping to block size
+static inline void getBlock(const bc_image& image, uint32_t bx, uint32_t by, color_quad_u8* block)
+{
+	for (uint32_t y = 0; y < 4; ++y)
 	{
-		image_u8 temp;
-		temp.init(orig_width, orig_height);
+		uint32_t py = by * 4 + y;
 
-		for (uint32_t y = 0; y < orig_height; y++)
-			for (uint32_t x = 0; x < orig_width; x++)
-				temp(x, (orig_height - 1) - y) = source_image(x, y);
+		for (uint32_t x = 0; x < 4; ++x)
+		{
+			uint32_t px = bx * 4 + x;
 
-		temp.swap(source_image);
+			if (px < image.width && py < image.height)
+				block[y * 4 + x] = image.pixels[px + image.width * py];
+			else
+				block[y * 4 + x].set(0, 0);
+		}
 	}
+}
 
-	source_image.crop((source_image.width() + 3) & ~3, (source_image.height() + 3) & ~3);
+static void compressRowBC7(const bc_image& image, uint32_t by, const bc7enc16_compress_block_params* params)
+{
+	uint32_t blocksX = (image.width + 3) / 4;
+	bc7_block* rowBlocks = (bc7_block*)image.output + (size_t)by * blocksX;
 
-	const uint32_t blocks_x = source_image.width() / 4;
-	const uint32_t blocks_y = source_image.height() / 4;
+	for (uint32_t bx = 0; bx < blocksX; ++bx)
+	{
+		color_quad_u8 pixels[16];
+		getBlock(image, bx, by, pixels);
 
-	bc7_block_vec packed_image(blocks_x * blocks_y);
+		bc7enc16_compress_block(rowBlocks + bx, pixels, params);
+	}
+}
 
-	bc7enc16_compress_block_params pack_params;
-	bc7enc16_compress_block_params_init(&pack_params);
-	if (!perceptual)
-		bc7enc16_compress_block_params_init_linear_weights(&pack_params);
-	pack_params.m_max_partitions_mode1 = max_partitions_to_scan;
-	pack_params.m_uber_level = uber_level;
+//Row of blocks is a 4 pixel high strip of the image, so it is encoded as a separate small image
+static void compressRowSquish(const bc_image& image, uint32_t by, bc_format format, bimg::Quality::Enum quality)
+{
+	uint32_t blocksX = (image.width + 3) / 4;
+	uint32_t stripHeight = std::min(image.height - by * 4, 4u);
+
+	const color_quad_u8* src = image.pixels + (size_t)by * 4 * image.width;
+	unsigned char* dst = image.output + (size_t)by * blocksX * bcblocksize(format);
 
-	//printf("Max mode 1 partitions: %u, uber level: %u, perceptual: %u\n", pack_params.m_max_partitions_mode1, pack_params.m_uber_level, perceptual);
+	bimg::TextureFormat::Enum dstFormat = bimg::TextureFormat::BC1;
+	if (format == BC_FORMAT_BC3) dstFormat = bimg::TextureFormat::BC3;
+	if (format == BC_FORMAT_BC4) dstFormat = bimg::TextureFormat::BC4;
+	if (format == BC_FORMAT_BC5) dstFormat = bimg::TextureFormat::BC5;
 
-	bc7enc16_compress_block_init();
+	bx::Error err;
+	bimg::imageEncodeFromRgba8(nullptr, dst, src, image.width, stripHeight, 1, dstFormat, quality, &err);
+}
 
-	bool has_alpha = false;
+bool bccompress(std::vector<bc_image>& images, bc_format format, int quality, const std::atomic<bool>* cancel, std::atomic<uint64_t>* blocksDone, bc_stats* stats)
+{
+	bc7enc16_compress_block_params pack_params;
+	bimg::Quality::Enum squishQuality = bimg::Quality::Default;
 
-	//clock_t start_t = clock();
-	for (uint32_t by = 0; by < blocks_y; by++)
+	if (format == BC_FORMAT_BC7)
 	{
-		for (uint32_t bx = 0; bx < blocks_x; bx++)
-		{
-			color_quad_u8 pixels[16];
+		//Builds shared lookup tables. Block compression itself has no global state
+		std::call_once(bc7InitFlag, []() { bc7enc16_compress_block_init(); });
 
-			source_image.get_block(bx, by, 4, 4, pixels);
+		bc7enc16_compress_block_params_init(&pack_params);
+		bc7enc16_compress_block_params_init_linear_weights(&pack_params);
+		pack_params.m_max_partitions_mode1 = BC7ENC16_MAX_PARTITIONS1;
+		pack_params.m_uber_level = quality;
+	}
+	else
+	{
+		//Quality levels are Low, Normal, High, Very High
+		if (quality <= 0)
+			squishQuality = bimg::Quality::Fastest;
+		else if (quality >= 3)
+			squishQuality = bimg::Quality::Highest;
+	}
 
-			bc7_block* pBlock = &packed_image[bx + by * blocks_x];
+	//Flatten block rows of all images, so small mip levels do not leave threads idle
+	std::vector<size_t> firstRow(images.size() + 1, 0);
+	uint64_t totalBlocks = 0;
 
-			if (bc7enc16_compress_block(pBlock, pixels, &pack_params))
-				has_alpha = true;
-		}
+	for (size_t i = 0; i < images.size(); ++i)
+	{
+		uint32_t blocksX = (images[i].width + 3) / 4;
+		uint32_t blocksY = (images[i].height + 3) / 4;
 
-		/*if ((by & 63) == 0)
-		{
-			printf(".");
-			fflush(stdout);
-		}*/
+		firstRow[i + 1] = firstRow[i] + blocksY;
+		totalBlocks += (uint64_t)blocksX * blocksY;
 	}
 
-	//clock_t end_t = clock();
+	int64_t start = bx::getHPCounter();
+
+	GX::JobSystem::getSingleton()->parallelFor(firstRow.back(), BC_ROWS_PER_JOB, [&](size_t begin, size_t end)
+		{
+			if (cancel != nullptr && cancel->load())
+				return;
+
+			for (size_t row = begin; row < end; ++row)
+			{
+				size_t img = std::upper_bound(firstRow.begin(), firstRow.end(), row) - firstRow.begin() - 1;
+				const bc_image& image = images[img];
+
+				uint32_t by = (uint32_t)(row - firstRow[img]);
 
-	//printf("\nTotal time: %f secs\n", (double)(end_t - start_t) / CLOCKS_PER_SEC);
+				if (format == BC_FORMAT_BC7)
+					compressRowBC7(image, by, &pack_params);
+				else
+					compressRowSquish(image, by, format, squishQuality);
 
-	//if (has_alpha)
-	//	printf("Source image had an alpha channel.\n");
+				if (blocksDone != nullptr)
+					blocksDone->fetch_add((image.width + 3) / 4);
+			}
+		}
+	);
+
+	if (stats != nullptr)
+	{
+		stats->blocks = totalBlocks;
+		stats->seconds = double(bx::getHPCounter() - start) / double(bx::getHPFrequency());
+	}
 
-	uint32_t imageSize = (((orig_width + 3) & ~3) * ((orig_height + 3) & ~3) * 8) >> 3;
-	//output = new unsigned char[imageSize];
-	memcpy(output, &packed_image[0], imageSize);
-	outputSize = imageSize;
-	
-	source_image.clear();
-	data.clear();
+	return cancel == nullptr || !cancel->load();
 }
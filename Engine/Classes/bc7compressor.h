@@ -1,4 +1,6 @@
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <vector>
 
 #include "../codecs/textures/bc7enc/bc7enc16.h"
@@ -166,4 +168,34 @@ struct bc7_block
 
 typedef std::vector<bc7_block> bc7_block_vec;
 
-void bc7compress(color_quad_u8_vec data, int _width, int _height, unsigned char*& output, int& outputSize, int quality);
+//Block compressed formats. BC7 is encoded with bc7enc16, the rest with libsquish from bimg
+enum bc_format
+{
+	BC_FORMAT_BC1,
+	BC_FORMAT_BC3,
+	BC_FORMAT_BC4,
+	BC_FORMAT_BC5,
+	BC_FORMAT_BC7
+};
+
+//Source and destination of one image (or mip level) to compress
+struct bc_image
+{
+	const color_quad_u8* pixels = nullptr;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	unsigned char* output = nullptr; //bcsize(format, width, height) bytes
+};
+
+struct bc_stats
+{
+	uint64_t blocks = 0;
+	double seconds = 0.0;
+};
+
+uint32_t bcblocksize(bc_format format);
+uint32_t bcsize(bc_format format, uint32_t width, uint32_t height);
+
+//Compresses all images at once. Block rows of every image are spread over job threads.
+//Returns false if cancelled. blocksDone is increased as rows are finished and may be polled from other threads
+bool bccompress(std::vector<bc_image>& images, bc_format format, int quality, const std::atomic<bool>* cancel = nullptr, std::atomic<uint64_t>* blocksDone = nullptr, bc_stats* stats = nullptr);
\ No newline at end of file
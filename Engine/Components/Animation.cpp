@@ -7,6 +7,7 @@
 #include "../Engine/Components/Transform.h"
 #include "../Assets/AnimationClip.h"
 #include "../Core/APIManager.h"
+#include "../Core/AnimationSystem.h"
 #include "../Core/Time.h"
 #include "../Classes/Hash.h"
 
@@ -16,10 +17,12 @@ namespace GX
 
 	Animation::Animation() : Component(APIManager::getSingleton()->animation_class)
 	{
+		AnimationSystem::getSingleton()->addAnimation(this);
 	}
 
 	Animation::~Animation()
 	{
+		AnimationSystem::getSingleton()->removeAnimation(this);
 	}
 
 	std::string Animation::getComponentType()
@@ -175,7 +178,7 @@ namespace GX
 		return false;
 	}
 
-	void Animation::onUpdate(float deltaTime)
+	void Animation::update(float deltaTime)
 	{
 		updateAnimations(deltaTime);
 
@@ -203,13 +206,82 @@ namespace GX
 		}
 	}
 
+	void Animation::clearBindings()
+	{
+		clipBindings.clear();
+		boneTransforms.clear();
+		boneSlots.clear();
+		pose.clear();
+	}
+
+	Animation::ClipBinding* Animation::getClipBinding(int index)
+	{
+		//Objects below were added, removed or renamed. Bound transforms may be gone
+		uint32_t subtreeVersion = getGameObject()->getTransform()->getSubtreeVersion();
+		if (subtreeVersion != bindingsSubtreeVersion)
+		{
+			clearBindings();
+			bindingsSubtreeVersion = subtreeVersion;
+		}
+
+		if (clipBindings.size() != animationClips.size())
+			clipBindings.resize(animationClips.size());
+
+		AnimationClip* clip = animationClips[index].clip;
+		ClipBinding& binding = clipBindings[index];
+
+		if (binding.clip == clip && binding.nodesVersion == clip->getNodesVersion())
+			return &binding;
+
+		binding.clip = clip;
+		binding.nodesVersion = clip->getNodesVersion();
+		binding.bones.clear();
+
+		std::vector<AnimationClipNode*>& nodes = clip->getAnimationClipNodes();
+		binding.bones.reserve(nodes.size());
+
+		for (auto it = nodes.begin(); it != nodes.end(); ++it)
+		{
+			int slot = -1;
+
+			GameObject* node = Engine::getSingleton()->findGameObject((*it)->getNameHash(), getGameObject());
+			if (node != nullptr)
+			{
+				Transform* bone = node->getTransform();
+
+				auto st = boneSlots.find(bone);
+				if (st != boneSlots.end())
+					slot = st->second;
+				else
+				{
+					slot = (int)boneTransforms.size();
+					boneTransforms.push_back(bone);
+					boneSlots[bone] = slot;
+				}
+			}
+
+			binding.bones.push_back(slot);
+		}
+
+		pose.resize(boneTransforms.size());
+
+		return &binding;
+	}
+
 	void Animation::updateAnimations(float deltaTime)
 	{
 		float timeScale = Time::getTimeScale();
 		bool needClear = false;
 
-		std::vector<std::pair<Transform*, glm::mat4x4>> transforms;
-		std::vector<std::string> endedAnims;
+		//Resolve bindings first, as rebinding may reset the pose buffer
+		for (auto it = blendTree.begin(); it != blendTree.end(); ++it)
+		{
+			if (it->animClip >= 0 && it->weight > 0 && animationClips[it->animClip].clip != nullptr)
+				getClipBinding(it->animClip);
+		}
+
+		for (auto& bp : pose)
+			bp = BonePose();
 
 		for (auto it = blendTree.begin(); it != blendTree.end(); ++it)
 		{
@@ -229,35 +301,33 @@ namespace GX
 
 			if (weight > 0)
 			{
+				ClipBinding* binding = getClipBinding(clip);
 				std::vector<AnimationClipNode*>& currentAnimNodes = currentClip->getAnimationClipNodes();
-				for (auto it = currentAnimNodes.begin(); it != currentAnimNodes.end(); ++it)
+
+				for (size_t i = 0; i < currentAnimNodes.size(); ++i)
 				{
-					AnimationClipNode* currentAnimNode = *it;
-
-					size_t nodeNameHash = currentAnimNode->getNameHash();
-					GameObject* node = Engine::getSingleton()->findGameObject(nodeNameHash, getGameObject());
-
-					if (node != nullptr)
-					{
-						Transform* transfrom = node->getTransform();
-						glm::mat4x4 matrix = currentAnimNode->getTransformAtTime(time, transfrom);
-
-						if (matrix == glm::identity<glm::mat4x4>())
-							matrix = weight * transfrom->getLocalTransformMatrix();
-						else
-							matrix = weight * matrix;
-
-						auto mt = std::find_if(transforms.begin(), transforms.end(), [=](std::pair<Transform*, glm::mat4x4>& trans) -> bool
-							{
-								return trans.first == transfrom;
-							}
-						);
-
-						if (mt != transforms.end())
-							mt->second += matrix;
-						else
-							transforms.push_back(std::make_pair(transfrom, matrix));
-					}
+					int slot = binding->bones[i];
+					if (slot < 0)
+						continue;
+
+					Transform* bone = boneTransforms[slot];
+
+					glm::vec3 position = bone->getLocalPosition();
+					glm::highp_quat rotation = bone->getLocalRotation();
+					glm::vec3 scale = bone->getLocalScale();
+
+					currentAnimNodes[i]->sample(time, position, rotation, scale);
+
+					BonePose& bp = pose[slot];
+
+					//Keep rotations in one hemisphere, so the weighted sum does not cancel out
+					if (bp.weight > 0.0f && glm::dot(bp.rotation, rotation) < 0.0f)
+						rotation = -rotation;
+
+					bp.position += position * weight;
+					bp.rotation += rotation * weight;
+					bp.scale += scale * weight;
+					bp.weight += weight;
 				}
 			}
 
@@ -272,7 +342,7 @@ namespace GX
 			{
 				if (!state.cb)
 				{
-					endedAnims.push_back(currentInfo.name);
+					endedAnimations.push_back(currentInfo.name);
 					state.cb = true;
 				}
 
@@ -284,17 +354,33 @@ namespace GX
 			}
 		}
 
-		for (auto it = transforms.begin(); it != transforms.end(); ++it)
+		bool poseChanged = false;
+
+		for (size_t i = 0; i < pose.size(); ++i)
 		{
-			std::pair<Transform*, glm::mat4x4>& trans = *it;
-			trans.first->setLocalTransformMatrix(trans.second);
+			BonePose& bp = pose[i];
+			if (bp.weight <= 0.0f)
+				continue;
+
+			float invWeight = 1.0f / bp.weight;
+			boneTransforms[i]->setLocalTransform(bp.position * invWeight, glm::normalize(bp.rotation), bp.scale * invWeight, false);
+
+			poseChanged = true;
 		}
 
-		transforms.clear();
+		//World transforms of the whole hierarchy are updated once, parents before children
+		if (poseChanged)
+			getGameObject()->getTransform()->updateChildTransform();
+	}
+
+	void Animation::dispatchEvents()
+	{
+		if (endedAnimations.empty())
+			return;
 
 		if (Engine::getSingleton()->getIsRuntimeMode())
 		{
-			for (auto& n : endedAnims)
+			for (auto& n : endedAnimations)
 			{
 				MonoString* mAnimName = mono_string_new(APIManager::getSingleton()->getDomain(), n.c_str());
 				void* args[2] = { managedObject, mAnimName };
@@ -302,7 +388,7 @@ namespace GX
 			}
 		}
 
-		endedAnims.clear();
+		endedAnimations.clear();
 	}
 
 	Component* Animation::onClone()
@@ -2,10 +2,12 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <functional>
 #include <vector>
 
 #include "../glm/mat4x4.hpp"
+#include "../glm/gtc/quaternion.hpp"
 
 #include "Component.h"
 
@@ -30,6 +32,7 @@ namespace GX
 	class Animation : public Component
 	{
 		friend class MeshRenderer;
+		friend class AnimationSystem;
 
 	private:
 		struct BlendState
@@ -48,6 +51,25 @@ namespace GX
 			bool cb = false;
 		};
 
+		//Bone targets of a clip, resolved once instead of searching the hierarchy every frame
+		struct ClipBinding
+		{
+		public:
+			AnimationClip* clip = nullptr;
+			uint32_t nodesVersion = 0;
+			std::vector<int> bones; //Pose slot per clip node, -1 if there is no such object
+		};
+
+		//Blended local transform of a bone
+		struct BonePose
+		{
+		public:
+			glm::vec3 position = glm::vec3(0.0f);
+			glm::highp_quat rotation = glm::highp_quat(0.0f, 0.0f, 0.0f, 0.0f);
+			glm::vec3 scale = glm::vec3(0.0f);
+			float weight = 0.0f;
+		};
+
 		std::vector<AnimationClipInfo> animationClips;
 		std::map<size_t, glm::mat4x4> initialTransforms; // Guid hash, local transform
 
@@ -55,11 +77,26 @@ namespace GX
 
 		float transitionDuration = 0.0f;
 
+		std::vector<ClipBinding> clipBindings; //Same order as animationClips
+		std::vector<Transform*> boneTransforms;
+		std::unordered_map<Transform*, int> boneSlots;
+		std::vector<BonePose> pose;
+		uint32_t bindingsSubtreeVersion = 0;
+
+		std::vector<std::string> endedAnimations; //Reported to scripts on the main thread
+
 		void saveInitialState();
 		void loadInitialState();
 
+		void clearBindings();
+		ClipBinding* getClipBinding(int index);
+
 		void updateAnimations(float deltaTime);
 
+		//Called by AnimationSystem. May run on a job thread
+		void update(float deltaTime);
+		void dispatchEvents();
+
 	public:
 		Animation();
 		virtual ~Animation();
@@ -67,7 +104,6 @@ namespace GX
 		static std::string COMPONENT_TYPE;
 		virtual std::string getComponentType();
 
-		virtual void onUpdate(float deltaTime);
 		virtual Component* onClone();
 		virtual void onRebindObject(std::string oldObj, std::string newObj);
 		virtual bool isEqualsTo(Component* other);
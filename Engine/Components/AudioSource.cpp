@@ -430,9 +430,8 @@ namespace GX
 		else
 		{
 			zip_t* arch = Engine::getSingleton()->getZipArchive(location);
-			int sz = 0;
-			AudioZipData = ZipHelper::readFileFromZip(arch, Filename, sz);
-			AudioFileZip = new boost::iostreams::stream<boost::iostreams::array_source>(AudioZipData, sz);
+			AudioZipData = ZipHelper::openFile(arch, Filename);
+			AudioFileZip = new boost::iostreams::stream<boost::iostreams::array_source>(AudioZipData.getData(), AudioZipData.getSize());
 			audioData->isZip = true;
 			audioData->data = AudioFileZip;
 
@@ -504,9 +503,8 @@ namespace GX
 		else
 		{
 			zip_t* arch = Engine::getSingleton()->getZipArchive(location);
-			int sz = 0;
-			AudioZipData = ZipHelper::readFileFromZip(arch, Filename, sz);
-			AudioFileZip = new boost::iostreams::stream<boost::iostreams::array_source>(AudioZipData, sz);
+			AudioZipData = ZipHelper::openFile(arch, Filename);
+			AudioFileZip = new boost::iostreams::stream<boost::iostreams::array_source>(AudioZipData.getData(), AudioZipData.getSize());
 			audioData->isZip = true;
 			audioData->data = AudioFileZip;
 
@@ -582,9 +580,8 @@ namespace GX
 		else
 		{
 			zip_t* arch = Engine::getSingleton()->getZipArchive(location);
-			int sz = 0;
-			AudioZipData = ZipHelper::readFileFromZip(arch, Filename, sz);
-			AudioFileZip = new boost::iostreams::stream<boost::iostreams::array_source>(AudioZipData, sz);
+			AudioZipData = ZipHelper::openFile(arch, Filename);
+			AudioFileZip = new boost::iostreams::stream<boost::iostreams::array_source>(AudioZipData.getData(), AudioZipData.getSize());
 			audioData->isZip = true;
 			audioData->data = AudioFileZip;
 
@@ -1046,10 +1043,7 @@ namespace GX
 			delete AudioFileZip;
 		}
 
-		if (AudioZipData != nullptr)
-		{
-			delete[] AudioZipData;
-		}
+		AudioZipData = ZipFileData();
 
 		if (fileFormat == FileFormat::FF_OGG)
 		{
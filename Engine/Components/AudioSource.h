@@ -4,6 +4,7 @@
 #include <fstream>
 
 #include "../Core/SoundManager.h"
+#include "../Classes/ZipHelper.h"
 #include "Component.h"
 
 #include <boost/iostreams/stream.hpp>
@@ -53,7 +54,7 @@ namespace GX
 		vorbis_info *mInfo = nullptr;
 		std::ifstream AudioFile;
 		boost::iostreams::stream<boost::iostreams::array_source>* AudioFileZip = nullptr;
-		char* AudioZipData = nullptr;
+		ZipFileData AudioZipData;
 		AudioData* audioData = nullptr;
 
 		bool mStreamed = true;
@@ -776,11 +776,14 @@ namespace GX
 
 		//----------------Update occlusion data-------------//
 
-		if (getOcclusionCulling())
-		{
-			if (renderer->projectSettings != nullptr)
-				renderer->calculateVisibility(view, proj, getFrustum(), getFar());
-		}
+		bool occlusion = getOcclusionCulling() && renderer->projectSettings != nullptr;
+
+		if (occlusion)
+			renderer->calculateVisibility(view, proj, getFrustum(), getFar());
+
+		//----------------Cull renderables-------------//
+
+		renderer->cullVisibleRenderables(this, viewLayer, occlusion);
 
 		//----------------Render directional shadows-------------//
 
@@ -806,29 +809,23 @@ namespace GX
 
 			glm::mat4x4 invViewProj = glm::inverse(proj * view);
 
-			auto& renderables = renderer->getRenderables();
+			auto& renderables = renderer->visibleRenderables;
+
+			renderer->beginInstancing();
 
 			for (auto it = renderables.begin(); it != renderables.end(); ++it)
 			{
-				Renderable* comp = *it;
-
-				if (comp->getSkipRendering() || comp->isDecal())
-					continue;
-
-				if (!comp->checkCullingMask(getCullingMask()))
-					continue;
-
-				if (!comp->isAlwaysVisible())
-				{
-					if (!isVisible(comp->getBounds()))
-						continue;
-				}
+				Renderable* comp = it->renderable;
 
 				comp->onRender(this, RENDER_GEOMETRY_PASS_ID + viewLayer, renderer->getRenderState(this, renderer->defaultRenderState), { bgfx::kInvalidHandle }, static_cast<int>(RenderMode::Deferred), [=]() {
 					renderer->setSystemUniforms(this);
 					});
 			}
 
+			renderer->endInstancing(this, RENDER_GEOMETRY_PASS_ID + viewLayer, renderer->getRenderState(this, renderer->defaultRenderState), [=]() {
+				renderer->setSystemUniforms(this);
+				});
+
 			if (decalBuffer.idx != bgfx::kInvalidHandle)
 			{
 				bgfx::setViewClear(RENDER_DECAL_PASS_ID + viewLayer, BGFX_CLEAR_NONE, 0x00000000, 1.0f, 0);
@@ -838,22 +835,12 @@ namespace GX
 			}
 
 			//Decals
-			for (auto it = renderables.begin(); it != renderables.end(); ++it)
+			auto& decals = renderer->visibleDecals;
+
+			for (auto it = decals.begin(); it != decals.end(); ++it)
 			{
 				Renderable* comp = *it;
 
-				if (comp->getSkipRendering() || !comp->isDecal())
-					continue;
-
-				if (!comp->checkCullingMask(getCullingMask()))
-					continue;
-
-				if (!comp->isAlwaysVisible())
-				{
-					if (!isVisible(comp->getBounds()))
-						continue;
-				}
-
 				comp->onRender(this, RENDER_DECAL_PASS_ID + viewLayer, 0, { bgfx::kInvalidHandle }, static_cast<int>(RenderMode::Deferred), [=]() {
 					renderer->setSystemUniforms(this);
 
@@ -21,7 +21,7 @@ namespace GX
 		if (getGameObject() == nullptr)
 			return;
 
-		RigidBody* body = (RigidBody*)getGameObject()->getComponent(RigidBody::COMPONENT_TYPE);
+		RigidBody* body = getGameObject()->getComponent<RigidBody>();
 
 		if (body != nullptr)
 		{
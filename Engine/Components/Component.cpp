@@ -1,10 +1,16 @@
 #include "Component.h"
 
+#include <mutex>
+#include <unordered_map>
+
 #include "Transform.h"
 #include "../Core/APIManager.h"
 
 namespace GX
 {
+	static std::unordered_map<std::string, int> componentTypeIds;
+	static std::mutex componentTypeIdsMutex;
+
 	Component::Component(MonoClass* monoClass)
 	{
 		if (monoClass != nullptr)
@@ -63,4 +69,37 @@ namespace GX
 
 		onManagedObjectDestroyed();
 	}
+
+	int Component::getComponentTypeId()
+	{
+		if (typeId == -1)
+			typeId = getTypeId(getComponentType());
+
+		return typeId;
+	}
+
+	int Component::getTypeId(const std::string& type)
+	{
+		std::lock_guard<std::mutex> lock(componentTypeIdsMutex);
+
+		auto it = componentTypeIds.find(type);
+		if (it != componentTypeIds.end())
+			return it->second;
+
+		int id = (int)componentTypeIds.size();
+		componentTypeIds[type] = id;
+
+		return id;
+	}
+
+	int Component::findTypeId(const std::string& type)
+	{
+		std::lock_guard<std::mutex> lock(componentTypeIdsMutex);
+
+		auto it = componentTypeIds.find(type);
+		if (it != componentTypeIds.end())
+			return it->second;
+
+		return -1;
+	}
 }
\ No newline at end of file
@@ -29,6 +29,8 @@ namespace GX
 		bool enabled = true;
 		bool attached = false;
 
+		int typeId = -1; //Set when the component is added to a game object
+
 		void createManagedObject();
 		void destroyManagedObject();
 
@@ -60,5 +62,12 @@ namespace GX
 		uint32_t getManagedGCHandle() { return managedGCHandle; }
 
 		GameObject* getGameObject() { return gameObject; }
+
+		int getComponentTypeId();
+
+		//Returns a compact numeric id for the component type name. Ids are assigned on first use
+		static int getTypeId(const std::string& type);
+		//Same as getTypeId but returns -1 for names that were never registered
+		static int findTypeId(const std::string& type);
 	};
 }
\ No newline at end of file
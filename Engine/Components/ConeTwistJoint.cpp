@@ -75,14 +75,14 @@ namespace GX
 
 		if (Engine::getSingleton()->getIsRuntimeMode())
 		{
-			RigidBody* body = (RigidBody*)getGameObject()->getComponent(RigidBody::COMPONENT_TYPE);
+			RigidBody* body = getGameObject()->getComponent<RigidBody>();
 
 			if (body != nullptr)
 			{
 				GameObject* connectedNode = Engine::getSingleton()->getGameObject(connectedObjectGuid);
 				if (connectedNode != nullptr)
 				{
-					RigidBody* connectedBody = (RigidBody*)connectedNode->getComponent(RigidBody::COMPONENT_TYPE);
+					RigidBody* connectedBody = connectedNode->getComponent<RigidBody>();
 
 					if (connectedBody != nullptr)
 					{
@@ -152,14 +152,14 @@ namespace GX
 
 		if (active)
 		{
-			RigidBody* body = (RigidBody*)getGameObject()->getComponent(RigidBody::COMPONENT_TYPE);
+			RigidBody* body = getGameObject()->getComponent<RigidBody>();
 
 			if (body != nullptr)
 			{
 				GameObject* connectedNode = Engine::getSingleton()->getGameObject(connectedObjectGuid);
 				if (connectedNode != nullptr)
 				{
-					RigidBody* connectedBody = (RigidBody*)connectedNode->getComponent(RigidBody::COMPONENT_TYPE);
+					RigidBody* connectedBody = connectedNode->getComponent<RigidBody>();
 
 					if (connectedBody != nullptr)
 					{
@@ -60,7 +60,7 @@ namespace GX
 		if (getGameObject() == nullptr)
 			return;
 
-		MeshRenderer* rend = (MeshRenderer*)getGameObject()->getComponent(MeshRenderer::COMPONENT_TYPE);
+		MeshRenderer* rend = getGameObject()->getComponent<MeshRenderer>();
 		if (rend != nullptr && rend->getMesh() != nullptr)
 		{
 			Mesh* mesh = rend->getMesh();
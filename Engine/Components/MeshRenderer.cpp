@@ -14,7 +14,9 @@
 #include "../Core/Engine.h"
 #include "../Renderer/Renderer.h"
 #include "../Renderer/Frustum.h"
+#include "../Renderer/TextureStreamer.h"
 #include "../Core/GameObject.h"
+#include "../Core/AnimationSystem.h"
 #include "../Assets/Texture.h"
 #include "../Assets/Material.h"
 #include "../Assets/Mesh.h"
@@ -25,7 +27,6 @@
 #include "../Classes/IO.h"
 #include "../Classes/Hash.h"
 
-#include "../OcclusionCulling/CullingThreadpool.h"
 
 namespace GX
 {
@@ -40,6 +41,8 @@ namespace GX
 
     MeshRenderer::~MeshRenderer()
     {
+        AnimationSystem::getSingleton()->removeMeshRenderer(this);
+
         setMesh(nullptr);
     }
 
@@ -74,6 +77,9 @@ namespace GX
         newComponent->castShadows = castShadows;
         newComponent->is_skinned = is_skinned;
 
+        if (is_skinned)
+            AnimationSystem::getSingleton()->addMeshRenderer(newComponent);
+
         return newComponent;
     }
 
@@ -267,18 +273,6 @@ namespace GX
 
     void MeshRenderer::setMesh(Mesh* meshPtr, bool setMaterials)
     {
-        if (mesh != nullptr)
-        {
-            for (auto& it : lodVertexBuffer)
-                it.clear();
-
-            for (auto& it : lodVertexBufferMtxCache)
-                it.clear();
-
-            lodVertexBuffer.clear();
-            lodVertexBufferMtxCache.clear();
-        }
-
         mesh = meshPtr;
         
         if (setMaterials)
@@ -286,25 +280,6 @@ namespace GX
 
         resetBoneLinks();
         reloadLightmaps();
-
-        for (auto& it : occluded)
-            it.second.clear();
-
-        occluded.clear();
-
-        if (mesh != nullptr)
-        {
-            lodVertexBuffer.resize(mesh->getSubMeshCount());
-            lodVertexBufferMtxCache.resize(mesh->getSubMeshCount());
-
-            for (int i = 0; i < mesh->getSubMeshCount(); ++i)
-            {
-                auto& vbuf = mesh->getSubMesh(i)->getVertexBuffer();
-
-                lodVertexBuffer[i].resize(vbuf.size(), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-                lodVertexBufferMtxCache[i].resize(vbuf.size(), false);
-            }
-        }
     }
 
     void MeshRenderer::resetBoneLinks()
@@ -353,6 +328,14 @@ namespace GX
                 }
             }
         }
+
+        bonePalettes.clear();
+        bonePaletteFrame = UINT32_MAX;
+
+        if (is_skinned)
+            AnimationSystem::getSingleton()->addMeshRenderer(this);
+        else
+            AnimationSystem::getSingleton()->removeMeshRenderer(this);
     }
 
     void MeshRenderer::setRootObject(GameObject* value)
@@ -468,22 +451,39 @@ namespace GX
         }
     }
 
-    void MeshRenderer::calcBoneData(int subMeshIndex, SubMesh* subMesh)
+    void MeshRenderer::updateBonePalette()
     {
-        if (rootObject == nullptr)
+        bonePaletteFrame = AnimationSystem::getSingleton()->getFrame();
+
+        if (rootObject == nullptr || mesh == nullptr)
             return;
 
-        int i = 0;
-        for (auto it = boneLinks[subMeshIndex].begin(); it != boneLinks[subMeshIndex].end(); ++it, ++i)
+        int subMeshCount = std::min(mesh->getSubMeshCount(), (int)boneLinks.size());
+        bonePalettes.resize(subMeshCount);
+
+        glm::mat4x4 invGlobalMtx = transform->getTransformMatrixInverse();
+
+        for (int j = 0; j < subMeshCount; ++j)
         {
-            BoneLink& link = *it;
-            if (link.target == nullptr) continue;
+            SubMesh* subMesh = mesh->getSubMesh(j);
+            std::vector<BoneLink>& links = boneLinks[j];
+            std::vector<glm::mat4x4>& palette = bonePalettes[j];
+
+            //Shader supports up to 128 bones
+            size_t numBones = std::min(std::max(links.size(), (size_t)1), (size_t)128);
+            if (palette.size() != numBones)
+                palette.resize(numBones, glm::identity<glm::mat4x4>());
+
+            for (size_t i = 0; i < links.size() && i < numBones; ++i)
+            {
+                BoneLink& link = links[i];
+                if (link.target == nullptr) continue;
 
-            glm::mat4x4 invGlobalMtx = transform->getTransformMatrixInverse();
-            glm::mat4x4 invBindMtx = subMesh->getBone(link.boneIndex)->getOffsetMatrix();
-            glm::mat4x4 boneMtx = link.target->getTransform()->getTransformMatrix();
+                glm::mat4x4 invBindMtx = subMesh->getBone(link.boneIndex)->getOffsetMatrix();
+                glm::mat4x4 boneMtx = link.target->getTransform()->getTransformMatrix();
 
-            boneMatrices[i] = invGlobalMtx * boneMtx * invBindMtx;
+                palette[i] = invGlobalMtx * boneMtx * invBindMtx;
+            }
         }
     }
 
@@ -508,16 +508,17 @@ namespace GX
         glm::mat4x4 invTrans = transform->getTransformMatrixInverse();
         glm::mat3x3 normalMatrix = trans;
 
-        if (!gameObject->getOcclusionStatic())
-        {
-            if (occluded.size() > 0)
-            {
-                for (auto& it : occluded)
-                    it.second.clear();
+        Renderer* renderer = Renderer::getSingleton();
 
-                occluded.clear();
-            }
-        }
+        //Instancing is only used for regular camera passes of non-skinned, non-lightmapped objects
+        bool instanced = program.idx == bgfx::kInvalidHandle
+            && renderer->getCollectInstances()
+            && !is_skinned
+            && lightmaps.empty();
+
+        //Normally done by AnimationSystem once per frame. Renderers drawn before that or not registered do it here
+        if (is_skinned && bonePaletteFrame != AnimationSystem::getSingleton()->getFrame())
+            updateBonePalette();
 
         float lodDist = 0.0f;
         float aabbRadius = 1.0f;
@@ -589,96 +590,15 @@ namespace GX
             }
             //
 
-            /////-------Occlusion Culling
-            if (gameObject->getOcclusionStatic())
-            {
-                if (program.idx == bgfx::kInvalidHandle)
-                {
-                    if (camera != nullptr)
-                    {
-                        auto& otx = occluded[camera];
-
-                        if (otx.size() != mesh->getSubMeshCount())
-                            otx.resize(mesh->getSubMeshCount());
-
-                        if (camera->getOcclusionCulling())
-                        {
-                            auto* moc = Renderer::getSingleton()->getOcclusionCullingProcessor();
+            //Objects are assumed to have UVs stretched over their bounds
+            if (camera != nullptr && program.idx == bgfx::kInvalidHandle && material != nullptr && material->isLoaded())
+                TextureStreamer::getSingleton()->requestMaterial(camera, material, aabbRadius * 2.0f, lodDist);
 
-                            auto& vbuf = subMesh->getVertexBuffer();
-                            auto& ibuf = subMesh->getIndexBuffer();
-
-                            if (lodVertexBuffer[i].size() == vbuf.size())
-                            {
-                                int maxLod = subMesh->getLodLevelsCount() - 1;
-
-                                MaskedOcclusionCulling::CullingResult result = MaskedOcclusionCulling::CullingResult::VISIBLE;
-
-                                if (maxLod >= 0)
-                                {
-                                    auto& lodIbuf = subMesh->getLodIndexBuffer(maxLod);
-                                    result = moc->TestTriangles(&lodVertexBuffer[i][0].x, lodIbuf.data(), (int)lodIbuf.size() / 3);
-                                }
-                                else
-                                {
-                                    result = moc->TestTriangles(&lodVertexBuffer[i][0].x, ibuf.data(), (int)ibuf.size() / 3);
-                                }
-
-                                otx[i] = false;
-
-                                if (result == MaskedOcclusionCulling::CullingResult::OCCLUDED)
-                                {
-                                    otx[i] = true;
-                                    continue;
-                                }
-                            }
-                        }
-                        else
-                        {
-                            otx[i] = false;
-                        }
-                    }
-                }
-                else
-                {
-                    if (camera == nullptr)
-                    {
-                        bool skip = true;
-
-                        for (auto& it : occluded)
-                        {
-                            if (it.second.size() != mesh->getSubMeshCount())
-                                continue;
-
-                            if (!it.second[i])
-                            {
-                                skip = false;
-                                break;
-                            }
-                        }
-
-                        if (skip)
-                            continue;
-                    }
-                    else
-                    {
-                        if (camera->getOcclusionCulling())
-                        {
-                            auto& otx = occluded[camera];
-
-                            if (otx.size() == mesh->getSubMeshCount())
-                            {
-                                if (otx[i])
-                                    continue;
-                            }
-                        }
-                    }
-                }
+            if (instanced)
+            {
+                if (renderer->addInstance(subMesh, currentLod, material, trans))
+                    continue;
             }
-            /////----------------
-
-            if (is_skinned)
-                calcBoneData(i, subMesh);
 
             int passCount = 1;
 
@@ -804,8 +724,8 @@ namespace GX
                     //Bind system uniforms
                     bgfx::setUniform(Renderer::uNormalMatrix, glm::value_ptr(normalMatrix), 1);
 
-                    if (is_skinned)
-                        bgfx::setUniform(Renderer::uBoneMtx, &boneMatrices, 128);
+                    if (is_skinned && i < bonePalettes.size())
+                        bgfx::setUniform(Renderer::uBoneMtx, glm::value_ptr(bonePalettes[i][0]), (uint16_t)bonePalettes[i].size());
 
                     bgfx::setUniform(Renderer::uGpuSkinning, glm::value_ptr(glm::vec4(is_skinned ? 1.0 : 0.0, 0.0, 0.0, 0.0)), 1);
                     bgfx::setUniform(Renderer::uInvModel, glm::value_ptr(invTrans), 1);
@@ -31,6 +31,8 @@ namespace GX
 
 	class MeshRenderer : public Component, public Renderable
 	{
+		friend class AnimationSystem;
+
 	private:
 		Mesh* mesh = nullptr;
 
@@ -51,16 +53,12 @@ namespace GX
 		std::vector<Texture*> lightmaps;
 		uint8_t lightmapSize = 0; //0 - default
 
-		glm::mat4x4 boneMatrices[128];
-		void calcBoneData(int subMeshIndex, SubMesh * subMesh);
+		std::vector<std::vector<glm::mat4x4>> bonePalettes; //Skinning matrices per submesh
+		uint32_t bonePaletteFrame = UINT32_MAX;
+		void updateBonePalette();
 
 		void applyMaterials();
 
-		std::map<Camera*, std::vector<bool>> occluded;
-
-		std::vector<std::vector<glm::vec4>> lodVertexBuffer;
-		std::vector<std::vector<bool>> lodVertexBufferMtxCache;
-
 		float lodMaxDistance = 50.0f;
 		bool cullOverMaxDistance = false;
 
@@ -74,9 +72,6 @@ namespace GX
 		void setMesh(Mesh * meshPtr, bool setMaterials = true);
 		Mesh* getMesh() { return mesh; }
 
-		std::vector<std::vector<glm::vec4>>& getLodVertexBuffer() { return lodVertexBuffer; }
-		std::vector<std::vector<bool>>& getLodVertexBufferMtxCache() { return lodVertexBufferMtxCache; }
-
 		virtual void onRender(Camera * camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback); // Rendering function
 		virtual void onSceneLoaded();
 		virtual Component* onClone();
@@ -90,6 +85,7 @@ namespace GX
 		virtual bool getSkipRendering();
 		virtual AxisAlignedBox getBounds(bool world = true);
 		virtual bool checkCullingMask(LayerMask& mask);
+		virtual Material* getSortMaterial() { return sharedMaterials.size() > 0 ? sharedMaterials[0] : nullptr; }
 
 		void addSharedMaterial(Material* mat);
 		void removeSharedMaterial(Material* mat);
@@ -97,6 +97,8 @@ namespace GX
 
 	MonoScript::~MonoScript()
 	{
+		APIManager::getSingleton()->unregisterScript(this);
+
 		if (Engine::getSingleton()->getIsRuntimeMode())
 			APIManager::getSingleton()->execute(managedObject, "OnDestroy");
 	}
@@ -131,6 +133,8 @@ namespace GX
 		managedClassName = className;
 		managedClass = APIManager::getSingleton()->findClass(className);
 		createManagedObject();
+
+		APIManager::getSingleton()->updateScriptRegistration(this);
 	}
 
 	std::string MonoScript::getComponentType()
@@ -171,6 +175,8 @@ namespace GX
 	void MonoScript::onManagedObjectDestroyed()
 	{
 		startExecuted = false;
+
+		APIManager::getSingleton()->unregisterScript(this);
 	}
 
 	Component* MonoScript::onClone()
@@ -220,8 +226,30 @@ namespace GX
 		}
 	}
 
+	void MonoScript::onAttach()
+	{
+		Component::onAttach();
+
+		APIManager::getSingleton()->updateScriptRegistration(this);
+	}
+
+	void MonoScript::onDetach()
+	{
+		Component::onDetach();
+
+		APIManager::getSingleton()->unregisterScript(this);
+	}
+
+	void MonoScript::onChangeParent(Transform* prevParent)
+	{
+		//New parent may be inactive or destroyed
+		APIManager::getSingleton()->updateScriptRegistration(this);
+	}
+
 	void MonoScript::onStateChanged()
 	{
+		APIManager::getSingleton()->updateScriptRegistration(this);
+
 		if (Engine::getSingleton()->getIsRuntimeMode())
 		{
 			if (managedObject != nullptr)
@@ -834,7 +862,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Transform::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Transform>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -853,7 +881,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Animation::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Animation>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -872,7 +900,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(AudioListener::COMPONENT_TYPE);
+							Component* comp = node->getComponent<AudioListener>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -891,7 +919,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(AudioSource::COMPONENT_TYPE);
+							Component* comp = node->getComponent<AudioSource>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -910,7 +938,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(VideoPlayer::COMPONENT_TYPE);
+							Component* comp = node->getComponent<VideoPlayer>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -929,7 +957,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(NavMeshAgent::COMPONENT_TYPE);
+							Component* comp = node->getComponent<NavMeshAgent>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -948,7 +976,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(NavMeshObstacle::COMPONENT_TYPE);
+							Component* comp = node->getComponent<NavMeshObstacle>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -967,7 +995,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Spline::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Spline>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -986,7 +1014,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(BoxCollider::COMPONENT_TYPE);
+							Component* comp = node->getComponent<BoxCollider>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1005,7 +1033,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(CapsuleCollider::COMPONENT_TYPE);
+							Component* comp = node->getComponent<CapsuleCollider>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1024,7 +1052,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(MeshCollider::COMPONENT_TYPE);
+							Component* comp = node->getComponent<MeshCollider>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1043,7 +1071,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(SphereCollider::COMPONENT_TYPE);
+							Component* comp = node->getComponent<SphereCollider>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1062,7 +1090,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(TerrainCollider::COMPONENT_TYPE);
+							Component* comp = node->getComponent<TerrainCollider>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1081,7 +1109,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(ConeTwistJoint::COMPONENT_TYPE);
+							Component* comp = node->getComponent<ConeTwistJoint>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1100,7 +1128,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(FixedJoint::COMPONENT_TYPE);
+							Component* comp = node->getComponent<FixedJoint>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1119,7 +1147,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(FreeJoint::COMPONENT_TYPE);
+							Component* comp = node->getComponent<FreeJoint>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1138,7 +1166,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(HingeJoint::COMPONENT_TYPE);
+							Component* comp = node->getComponent<HingeJoint>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1157,7 +1185,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(RigidBody::COMPONENT_TYPE);
+							Component* comp = node->getComponent<RigidBody>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1176,7 +1204,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Vehicle::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Vehicle>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1195,7 +1223,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Camera::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Camera>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1214,7 +1242,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Light::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Light>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1233,7 +1261,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(MeshRenderer::COMPONENT_TYPE);
+							Component* comp = node->getComponent<MeshRenderer>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1252,7 +1280,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(ParticleSystem::COMPONENT_TYPE);
+							Component* comp = node->getComponent<ParticleSystem>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1271,7 +1299,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Terrain::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Terrain>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1290,7 +1318,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Water::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Water>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1309,7 +1337,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Button::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Button>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1328,7 +1356,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Canvas::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Canvas>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1347,7 +1375,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Image::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Image>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1366,7 +1394,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Mask::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Mask>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1385,7 +1413,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(Text::COMPONENT_TYPE);
+							Component* comp = node->getComponent<Text>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -1404,7 +1432,7 @@ namespace GX
 						GameObject* node = Engine::getSingleton()->getGameObject(val.objectVal);
 						if (node != nullptr)
 						{
-							Component* comp = node->getComponent(TextInput::COMPONENT_TYPE);
+							Component* comp = node->getComponent<TextInput>();
 							if (comp != nullptr && comp->getManagedObject() != nullptr)
 								mono_field_set_value((MonoObject*)managedObject, _fld, comp->getManagedObject());
 							else
@@ -100,6 +100,9 @@ namespace GX
 		virtual void onRefresh();
 		virtual void onRebindObject(std::string oldObj, std::string newObj);
 		virtual void onStateChanged();
+		virtual void onChangeParent(Transform* prevParent);
+		virtual void onAttach();
+		virtual void onDetach();
 
 		FieldList getFields();
 		MonoScript::MonoFieldInfo* getField(std::string name); //Delete it after use!
@@ -118,6 +121,9 @@ namespace GX
 	private:
 		std::string managedClassName = "";
 
+		uint64_t registrationOrder = 0; //Position in script callback lists, assigned on first registration
+		uint8_t registeredCallbacks = 0; //Bit mask of APIManager::ScriptCallback
+
 		std::vector<MonoFieldInfo> serializedFields;
 		void addSerializedField(MonoScript::MonoFieldInfo value) { serializedFields.push_back(value); }
 		void sendSerializedFieldsToMono();
@@ -1,5 +1,7 @@
 #include "ParticleSystem.h"
 
+#include <emmintrin.h>
+
 #include "../glm/gtc/type_ptr.hpp"
 
 #include <boost/algorithm/string.hpp>
@@ -11,6 +13,8 @@
 #include "../Core/APIManager.h"
 #include "../Core/Time.h"
 #include "../Core/PhysicsManager.h"
+#include "../Core/ParticleManager.h"
+#include "../Core/JobSystem.h"
 #include "../Renderer/Renderer.h"
 #include "../Renderer/VertexLayouts.h"
 #include "../Math/Mathf.h"
@@ -29,148 +33,361 @@ namespace GX
 {
     std::string ParticleSystem::COMPONENT_TYPE = "ParticleSystem";
 
-    void Particle::reset()
-    {
-        active = false;
-        position = glm::vec3(0.0f);
-        direction = glm::vec3(0.0f);
-        rotation = glm::identity<glm::highp_quat>();
-        size = 1.0f;
-        startSize = 1.0f;
-        color = Color::White;
-        speed = 0.0f;
-        lifeTime = 0.0f;
-        startLifeTime = 0.0f;
-        currentFrame = 0.0f;
-        psPosition = glm::vec3(0.0f);
-        psRotation = glm::identity<glm::highp_quat>();
-        paramsBool.clear();
-        paramsVec3.clear();
-
-        if (collider != nullptr)
-            delete collider;
-
-        if (motionState != nullptr)
-            delete motionState;
-
-        if (rigidbody != nullptr)
+    //***PARTICLE POOL***//
+
+    template<typename T>
+    static void compactColumn(std::vector<T>& column, const std::vector<float>& lifeTime, size_t firstDead)
+    {
+        //Keeps the order of live particles. lifeTime itself may be passed as column as long as it goes last
+        size_t w = firstDead;
+        for (size_t i = firstDead; i < column.size(); ++i)
         {
-            PhysicsManager::getSingleton()->getWorld()->removeRigidBody(rigidbody);
-            delete rigidbody;
+            if (lifeTime[i] < 0.0f)
+                continue;
+
+            if (w != i)
+                column[w] = column[i];
+
+            ++w;
         }
 
-        parent = nullptr;
+        column.erase(column.begin() + w, column.end());
+    }
 
-        collider = nullptr;
-        rigidbody = nullptr;
-        motionState = nullptr;
+    static void compactColumn(ParticleColumn3& column, const std::vector<float>& lifeTime, size_t firstDead)
+    {
+        compactColumn(column.x, lifeTime, firstDead);
+        compactColumn(column.y, lifeTime, firstDead);
+        compactColumn(column.z, lifeTime, firstDead);
     }
 
-    float Particle::getPlaybackTime()
+    size_t ParticlePool::getCountOlderThan(float time)
     {
-        return startLifeTime - lifeTime;
+        if (time <= 0.0f)
+            return getCount();
+
+        //All particles age at the same rate and new ones are appended, so the age only decreases along the pool
+        size_t first = 0;
+        size_t count = getCount();
+
+        while (count > 0)
+        {
+            size_t step = count / 2;
+            size_t mid = first + step;
+
+            if (getPlaybackTime(mid) >= time)
+            {
+                first = mid + 1;
+                count -= step + 1;
+            }
+            else
+                count = step;
+        }
+
+        return first;
     }
 
-    //***PARTICLE MODIFIERS***//
+    size_t ParticlePool::add()
+    {
+        position.push_back(glm::vec3(0.0f));
+        lastPosition.push_back(glm::vec3(0.0f));
+        direction.push_back(glm::vec3(0.0f));
+        speed.push_back(0.0f);
+        size.push_back(1.0f);
+        startSize.push_back(1.0f);
+        lifeTime.push_back(0.0f);
+        startLifeTime.push_back(0.0f);
+        currentFrame.push_back(0.0f);
+        color.push_back(Color::White);
+        rotation.push_back(glm::identity<glm::highp_quat>());
+        psPosition.push_back(glm::vec3(0.0f));
+        psRotation.push_back(glm::identity<glm::highp_quat>());
+
+        collider.push_back(nullptr);
+        rigidbody.push_back(nullptr);
+        motionState.push_back(nullptr);
+
+        for (auto& c : modifierFlags)
+            c.push_back(0);
+
+        for (auto& c : modifierVectors)
+            c.push_back(glm::vec3(0.0f));
+
+        for (auto& c : modifierTimers)
+            c.push_back(0.0f);
+
+        return lifeTime.size() - 1;
+    }
 
-    std::string ParticleGravityModifier::MODIFIER_TYPE = "Gravity modifier";
-    std::string ParticleColorModifier::MODIFIER_TYPE = "Color modifier";
-    std::string ParticleSizeModifier::MODIFIER_TYPE = "Size modifier";
-    std::string ParticleDirectionModifier::MODIFIER_TYPE = "Direction modifier";
-    std::string ParticleRotationModifier::MODIFIER_TYPE = "Rotation modifier";
-    std::string ParticleSpeedModifier::MODIFIER_TYPE = "Speed modifier";
+    void ParticlePool::destroyPhysics(size_t index)
+    {
+        if (collider[index] != nullptr)
+            delete collider[index];
 
-    //#define PARTICLE_POOL_SIZE 256
+        if (motionState[index] != nullptr)
+            delete motionState[index];
 
-    //Gravity modifier
-    void ParticleGravityModifier::onCreateParticle(Particle& particle)
+        if (rigidbody[index] != nullptr)
+        {
+            PhysicsManager::getSingleton()->getWorld()->removeRigidBody(rigidbody[index]);
+            delete rigidbody[index];
+        }
+
+        collider[index] = nullptr;
+        rigidbody[index] = nullptr;
+        motionState[index] = nullptr;
+    }
+
+    void ParticlePool::removeDead()
     {
-        particle.paramsVec3[this] = glm::vec3(0.0f);
+        size_t count = getCount();
+        size_t firstDead = 0;
+
+        while (firstDead < count && lifeTime[firstDead] >= 0.0f)
+            ++firstDead;
+
+        if (firstDead == count)
+            return;
 
-        if (particle.parent->getEnablePhysics())
+        for (size_t i = firstDead; i < count; ++i)
         {
-            if (particle.rigidbody != nullptr)
-                particle.rigidbody->setGravity(btVector3(gravity.x, gravity.y, gravity.z));
+            if (lifeTime[i] < 0.0f)
+                destroyPhysics(i);
         }
+
+        compactColumn(position, lifeTime, firstDead);
+        compactColumn(lastPosition, lifeTime, firstDead);
+        compactColumn(direction, lifeTime, firstDead);
+        compactColumn(speed, lifeTime, firstDead);
+        compactColumn(size, lifeTime, firstDead);
+        compactColumn(startSize, lifeTime, firstDead);
+        compactColumn(startLifeTime, lifeTime, firstDead);
+        compactColumn(currentFrame, lifeTime, firstDead);
+        compactColumn(color, lifeTime, firstDead);
+        compactColumn(rotation, lifeTime, firstDead);
+        compactColumn(psPosition, lifeTime, firstDead);
+        compactColumn(psRotation, lifeTime, firstDead);
+        compactColumn(collider, lifeTime, firstDead);
+        compactColumn(rigidbody, lifeTime, firstDead);
+        compactColumn(motionState, lifeTime, firstDead);
+
+        for (auto& c : modifierFlags)
+            compactColumn(c, lifeTime, firstDead);
+
+        for (auto& c : modifierVectors)
+            compactColumn(c, lifeTime, firstDead);
+
+        for (auto& c : modifierTimers)
+            compactColumn(c, lifeTime, firstDead);
+
+        compactColumn(lifeTime, lifeTime, firstDead);
     }
 
-    void ParticleGravityModifier::update(Particle& particle, float deltaTime)
+    void ParticlePool::clear()
     {
-        if (particle.parent->getEnablePhysics() &&
-            Engine::getSingleton()->getIsRuntimeMode())
+        for (size_t i = 0; i < getCount(); ++i)
+            destroyPhysics(i);
+
+        position.clear();
+        lastPosition.clear();
+        direction.clear();
+        speed.clear();
+        size.clear();
+        startSize.clear();
+        lifeTime.clear();
+        startLifeTime.clear();
+        currentFrame.clear();
+        color.clear();
+        rotation.clear();
+        psPosition.clear();
+        psRotation.clear();
+
+        collider.clear();
+        rigidbody.clear();
+        motionState.clear();
+
+        for (auto& c : modifierFlags)
+            c.clear();
+
+        for (auto& c : modifierVectors)
+            c.clear();
+
+        for (auto& c : modifierTimers)
+            c.clear();
+    }
+
+    void ParticlePool::addModifierColumn()
+    {
+        size_t count = getCount();
+
+        modifierFlags.push_back(std::vector<uint8_t>(count, 0));
+        modifierTimers.push_back(std::vector<float>(count, 0.0f));
+
+        ParticleColumn3 vectors;
+        vectors.x.resize(count, 0.0f);
+        vectors.y.resize(count, 0.0f);
+        vectors.z.resize(count, 0.0f);
+        modifierVectors.push_back(vectors);
+    }
+
+    void ParticlePool::removeModifierColumn(size_t index)
+    {
+        if (index >= modifierFlags.size())
             return;
 
-        glm::vec3 _gravityTo = gravity;
-        if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::Local)
-            _gravityTo = glm::inverse(particle.psRotation) * gravity;
+        modifierFlags.erase(modifierFlags.begin() + index);
+        modifierVectors.erase(modifierVectors.begin() + index);
+        modifierTimers.erase(modifierTimers.begin() + index);
+    }
+
+    //***KERNELS***//
 
-        glm::vec3& _gravity = particle.paramsVec3[this];
-        _gravity = Mathf::lerp(_gravity, _gravityTo, deltaTime * damping);
+    //Unaligned SSE loops over four particles with a scalar tail
+
+    //position += normalize(direction) * speed * deltaTime, lifeTime -= deltaTime
+    static void integrate(ParticlePool& pool, float deltaTime)
+    {
+        size_t count = pool.getCount();
+
+        float* px = pool.position.x.data();
+        float* py = pool.position.y.data();
+        float* pz = pool.position.z.data();
+        const float* dx = pool.direction.x.data();
+        const float* dy = pool.direction.y.data();
+        const float* dz = pool.direction.z.data();
+        const float* speed = pool.speed.data();
+        float* life = pool.lifeTime.data();
+
+        const __m128 dt = _mm_set1_ps(deltaTime);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 x = _mm_loadu_ps(dx + i);
+            __m128 y = _mm_loadu_ps(dy + i);
+            __m128 z = _mm_loadu_ps(dz + i);
+
+            //Zero directions do not move the particle
+            __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+            __m128 invLen = _mm_and_ps(_mm_cmpgt_ps(len2, zero), _mm_div_ps(one, _mm_sqrt_ps(len2)));
+            __m128 step = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(speed + i), dt), invLen);
+
+            _mm_storeu_ps(px + i, _mm_add_ps(_mm_loadu_ps(px + i), _mm_mul_ps(x, step)));
+            _mm_storeu_ps(py + i, _mm_add_ps(_mm_loadu_ps(py + i), _mm_mul_ps(y, step)));
+            _mm_storeu_ps(pz + i, _mm_add_ps(_mm_loadu_ps(pz + i), _mm_mul_ps(z, step)));
+            _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), dt));
+        }
+
+        for (; i < count; ++i)
+        {
+            float len2 = dx[i] * dx[i] + dy[i] * dy[i] + dz[i] * dz[i];
+            float step = len2 > 0.0f ? speed[i] * deltaTime / std::sqrt(len2) : 0.0f;
 
-        particle.position += _gravity * deltaTime;
+            px[i] += dx[i] * step;
+            py[i] += dy[i] * step;
+            pz[i] += dz[i] * step;
+            life[i] -= deltaTime;
+        }
     }
 
-    //Color modifier
-    void ParticleColorModifier::onCreateParticle(Particle& particle)
+    //velocity = lerp(velocity, target, t), position += velocity * deltaTime
+    static void accelerate(float* position, float* velocity, float target, float t, float deltaTime, size_t count)
     {
-        if (colors.size() > 0)
+        const __m128 vt = _mm_set1_ps(t);
+        const __m128 dt = _mm_set1_ps(deltaTime);
+        const __m128 tgt = _mm_set1_ps(target);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
         {
-            if (startTime == 0.0f)
-            {
-                if (colors[0].first >= 0 && colors[0].first <= 0.03f)
-                    particle.color = colors[0].second;
-            }
+            __m128 v = _mm_loadu_ps(velocity + i);
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_sub_ps(tgt, v), vt));
+
+            _mm_storeu_ps(velocity + i, v);
+            _mm_storeu_ps(position + i, _mm_add_ps(_mm_loadu_ps(position + i), _mm_mul_ps(v, dt)));
+        }
+
+        for (; i < count; ++i)
+        {
+            velocity[i] += (target - velocity[i]) * t;
+            position[i] += velocity[i] * deltaTime;
         }
     }
 
-    void ParticleColorModifier::update(Particle& particle, float deltaTime)
+    //value += (target - value) * t
+    static void lerpTowards(float* values, const float* targets, const float* factors, size_t count)
+    {
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_loadu_ps(values + i);
+            v = _mm_add_ps(v, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(targets + i), v), _mm_loadu_ps(factors + i)));
+
+            _mm_storeu_ps(values + i, v);
+        }
+
+        for (; i < count; ++i)
+            values[i] += (targets[i] - values[i]) * factors[i];
+    }
+
+    //RGBA of one particle fits in one register
+    static void lerpColor(Color& color, Color& target, float t)
+    {
+        __m128 c = _mm_loadu_ps(color.ptr());
+        c = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(target.ptr()), c), _mm_set1_ps(t)));
+
+        _mm_storeu_ps(color.ptr(), c);
+    }
+
+    //Finds keyframe the particle at normalized age p moves to. Factor is the lerp amount for this frame, 1 sets the value directly
+    template<typename T>
+    static void findKeyframe(std::vector<std::pair<float, T>>& keys, float p, float startLifeTime, float deltaTime, T& value, float& factor)
     {
-        Color currentColor = particle.color;
         float minTime = 0.0f;
         float maxTime = 1.0f;
 
-        float p = 1.0f - (1.0f / particle.startLifeTime * particle.lifeTime);
-
-        for (size_t i = 0; i < colors.size(); ++i)
+        for (size_t i = 0; i < keys.size(); ++i)
         {
             if (i > 0)
             {
-                if (p >= colors[i - 1].first)
+                if (p >= keys[i - 1].first)
                 {
-                    if (p < colors[i].first)
+                    if (p < keys[i].first)
                     {
-                        if (colors[i].first >= colors[i - 1].first)
+                        if (keys[i].first >= keys[i - 1].first)
                         {
-                            currentColor = colors[i].second;
-                            minTime = colors[i - 1].first;
-                            maxTime = colors[i].first;
+                            value = keys[i].second;
+                            minTime = keys[i - 1].first;
+                            maxTime = keys[i].first;
 
                             break;
                         }
                     }
-                    else if (i == colors.size() - 1)
+                    else if (i == keys.size() - 1)
                     {
-                        currentColor = colors[i].second;
-                        minTime = colors[i].first;
-                        maxTime = colors[i].first;
+                        value = keys[i].second;
+                        minTime = keys[i].first;
+                        maxTime = keys[i].first;
                     }
                 }
             }
             else
             {
-                if (p >= 0 && p <= colors[i].first + 0.03f)
+                if (p >= 0 && p <= keys[i].first + 0.03f)
                 {
-                    currentColor = colors[i].second;
+                    value = keys[i].second;
                     minTime = 0.0f;
-                    maxTime = colors[i].first;
-                    
+                    maxTime = keys[i].first;
+
                     break;
                 }
-                else if (i == colors.size() - 1)
+                else if (i == keys.size() - 1)
                 {
-                    currentColor = colors[i].second;
-                    minTime = colors[i].first;
-                    maxTime = colors[i].first;
+                    value = keys[i].second;
+                    minTime = keys[i].first;
+                    maxTime = keys[i].first;
                 }
             }
         }
@@ -180,271 +397,277 @@ namespace GX
 
         if (minTime == maxTime)
         {
-            particle.color = currentColor;
+            factor = 1.0f;
         }
         else
         {
             float t = (p - minTime) / (maxTime - minTime);
             float dt = deltaTime * 100.0f;
-            particle.color = Color::lerp(particle.color, currentColor, dt * (t / (particle.startLifeTime * (maxTime - minTime)) / 10.0f));
+            factor = dt * (t / (startLifeTime * (maxTime - minTime)) / 10.0f);
         }
     }
 
-    //Size modifier
-    void ParticleSizeModifier::onCreateParticle(Particle& particle)
+    static void applyForce(btRigidBody* rigidbody, glm::vec3 direction, float speed)
     {
-        if (sizes.size() > 0)
-        {
-            if (startTime == 0.0f)
-            {
-                if (sizes[0].first >= 0 && sizes[0].first <= 0.03f)
-                {
-                    particle.size = std::max(sizes[0].second, 0.0f);
-                }
-            }
-        }
+        glm::vec3 dir = glm::normalize(direction) * speed * 10.0f;
+        if (glm::isnan(dir).x) dir.x = 0.0f;
+        if (glm::isnan(dir).y) dir.y = 0.0f;
+        if (glm::isnan(dir).z) dir.z = 0.0f;
+        rigidbody->applyCentralForce(btVector3(dir.x, dir.y, dir.z));
     }
 
-    void ParticleSizeModifier::update(Particle& particle, float deltaTime)
+    //Removes the velocity part that goes into the surface and returns it scaled by bounciness, friction slows down sliding
+    static glm::vec3 bounce(const glm::vec3& velocity, const glm::vec3& normal, float friction, float bounciness)
     {
-        float currentSize = 0.0f;
-        float minTime = 0.0f;
-        float maxTime = 1.0f;
+        float vn = glm::dot(velocity, normal);
+        if (vn >= 0.0f)
+            return velocity;
 
-        float p = 1.0f - (1.0f / particle.startLifeTime * particle.lifeTime);
+        glm::vec3 normalPart = normal * vn;
+        glm::vec3 tangentPart = velocity - normalPart;
 
-        for (size_t i = 0; i < sizes.size(); ++i)
-        {
-            if (i > 0)
-            {
-                if (p >= sizes[i - 1].first)
-                {
-                    if (p < sizes[i].first)
-                    {
-                        if (sizes[i].first >= sizes[i - 1].first)
-                        {
-                            currentSize = sizes[i].second;
-                            minTime = sizes[i - 1].first;
-                            maxTime = sizes[i].first;
+        return tangentPart * Mathf::Clamp01(1.0f - friction) - normalPart * bounciness;
+    }
 
-                            break;
-                        }
-                    }
-                    else if (i == sizes.size() - 1)
-                    {
-                        currentSize = sizes[i].second;
-                        minTime = sizes[i].first;
-                        maxTime = sizes[i].first;
-                    }
-                }
-            }
-            else
-            {
-                if (p >= 0 && p <= sizes[i].first + 0.03f)
-                {
-                    currentSize = sizes[i].second;
-                    minTime = 0.0f;
-                    maxTime = sizes[i].first;
+    //Closest hit with static or kinematic colliders only, particles ignore dynamic bodies and triggers
+    struct ParticleRayResultCallback : public btCollisionWorld::ClosestRayResultCallback
+    {
+        ParticleRayResultCallback(const btVector3& from, const btVector3& to) : btCollisionWorld::ClosestRayResultCallback(from, to) {}
 
-                    break;
-                }
-                else if (i == sizes.size() - 1)
-                {
-                    currentSize = sizes[i].second;
-                    minTime = sizes[i].first;
-                    maxTime = sizes[i].first;
-                }
-            }
+        virtual bool needsCollision(btBroadphaseProxy* proxy0) const
+        {
+            const btCollisionObject* obj = static_cast<const btCollisionObject*>(proxy0->m_clientObject);
+            if (!obj->isStaticOrKinematicObject() || !obj->hasContactResponse())
+                return false;
+
+            return btCollisionWorld::ClosestRayResultCallback::needsCollision(proxy0);
         }
+    };
 
-        if (maxTime < minTime + 0.07f)
-            maxTime = minTime;
+    //***PARTICLE MODIFIERS***//
 
-        if (minTime == maxTime)
+    std::string ParticleGravityModifier::MODIFIER_TYPE = "Gravity modifier";
+    std::string ParticleColorModifier::MODIFIER_TYPE = "Color modifier";
+    std::string ParticleSizeModifier::MODIFIER_TYPE = "Size modifier";
+    std::string ParticleDirectionModifier::MODIFIER_TYPE = "Direction modifier";
+    std::string ParticleRotationModifier::MODIFIER_TYPE = "Rotation modifier";
+    std::string ParticleSpeedModifier::MODIFIER_TYPE = "Speed modifier";
+
+    //Gravity modifier
+    void ParticleGravityModifier::onCreateParticle(ParticlePool& pool, size_t index)
+    {
+        pool.modifierVectors[column].set(index, glm::vec3(0.0f));
+
+        if (parent->usesRigidBodies())
         {
-            float v = particle.startSize + currentSize;
-            if (v < 0.0f)
-                v = 0.0f;
+            if (pool.rigidbody[index] != nullptr)
+                pool.rigidbody[index]->setGravity(btVector3(gravity.x, gravity.y, gravity.z));
+        }
+    }
+
+    void ParticleGravityModifier::update(ParticlePool& pool, size_t count, float deltaTime)
+    {
+        if (parent->usesRigidBodies() &&
+            Engine::getSingleton()->getIsRuntimeMode())
+            return;
 
-            particle.size = v;
+        ParticleColumn3& velocity = pool.modifierVectors[column];
+        float t = Mathf::Clamp01(deltaTime * damping);
+
+        if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::Local)
+        {
+            //Gravity depends on the rotation of the system at emission time
+            for (size_t i = 0; i < count; ++i)
+            {
+                glm::vec3 _gravity = Mathf::lerp(velocity.get(i), glm::inverse(pool.psRotation[i]) * gravity, t);
+                velocity.set(i, _gravity);
+                pool.position.set(i, pool.position.get(i) + _gravity * deltaTime);
+            }
         }
         else
         {
-            float t = (p - minTime) / (maxTime - minTime);
-            float v = particle.startSize + currentSize;
-            if (v < 0.0f)
-                v = 0.0f;
-
-            float dt = deltaTime * 100.0f;
-            particle.size = Mathf::lerp(particle.size, v, dt * (t / (particle.startLifeTime * (maxTime - minTime)) / 10.0f));
+            accelerate(pool.position.x.data(), velocity.x.data(), gravity.x, t, deltaTime, count);
+            accelerate(pool.position.y.data(), velocity.y.data(), gravity.y, t, deltaTime, count);
+            accelerate(pool.position.z.data(), velocity.z.data(), gravity.z, t, deltaTime, count);
         }
     }
 
-    //Direction modifier
-    void ParticleDirectionModifier::onCreateParticle(Particle& particle)
+    void ParticleGravityModifier::onCollideParticle(ParticlePool& pool, size_t index, const glm::vec3& normal)
     {
-        particle.paramsBool[this] = false;
+        ParticleColumn3& velocity = pool.modifierVectors[column];
+        velocity.set(index, bounce(velocity.get(index), normal, parent->getFriction(), parent->getBounciness()));
     }
 
-    void ParticleDirectionModifier::update(Particle& particle, float deltaTime)
+    //Color modifier
+    void ParticleColorModifier::onCreateParticle(ParticlePool& pool, size_t index)
     {
-        if (directionType == DirectionType::Constant)
+        if (colors.size() > 0)
         {
-            particle.direction = constantDirection;
-            if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World)
-                particle.direction = particle.psRotation * constantDirection;
-
-            if (particle.parent->getEnablePhysics() &&
-                particle.parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World &&
-                particle.rigidbody != nullptr &&
-                Engine::getSingleton()->getIsRuntimeMode())
+            if (startTime == 0.0f)
             {
-                glm::vec3 dir = glm::normalize(particle.direction) * particle.speed * 10.0f;
-                if (glm::isnan(dir).x) dir.x = 0.0f;
-                if (glm::isnan(dir).y) dir.y = 0.0f;
-                if (glm::isnan(dir).z) dir.z = 0.0f;
-                particle.rigidbody->applyCentralForce(btVector3(dir.x, dir.y, dir.z));
+                if (colors[0].first >= 0 && colors[0].first <= 0.03f)
+                    pool.color[index] = colors[0].second;
             }
         }
-        if (directionType == DirectionType::OnceAtStart)
+    }
+
+    void ParticleColorModifier::update(ParticlePool& pool, size_t count, float deltaTime)
+    {
+        for (size_t n = 0; n < count; ++n)
         {
-            if (!particle.paramsBool[this])
-            {
-                particle.direction = constantDirection;
-                if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World)
-                    particle.direction = particle.psRotation * constantDirection;
-
-                if (particle.parent->getEnablePhysics() &&
-                    particle.parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World &&
-                    particle.rigidbody != nullptr &&
-                    Engine::getSingleton()->getIsRuntimeMode())
-                {
-                    glm::vec3 dir = glm::normalize(particle.direction) * particle.speed * 10.0f;
-                    if (glm::isnan(dir).x) dir.x = 0.0f;
-                    if (glm::isnan(dir).y) dir.y = 0.0f;
-                    if (glm::isnan(dir).z) dir.z = 0.0f;
-                    particle.rigidbody->applyCentralForce(btVector3(dir.x, dir.y, dir.z));
-                }
+            Color currentColor = pool.color[n];
+            float factor = 1.0f;
 
-                particle.paramsBool[this] = true;
-            }
+            float p = 1.0f - (1.0f / pool.startLifeTime[n] * pool.lifeTime[n]);
+            findKeyframe(colors, p, pool.startLifeTime[n], deltaTime, currentColor, factor);
+
+            lerpColor(pool.color[n], currentColor, Mathf::Clamp01(factor));
         }
-        if (directionType == DirectionType::RandomAtStart)
+    }
+
+    //Size modifier
+    void ParticleSizeModifier::onCreateParticle(ParticlePool& pool, size_t index)
+    {
+        if (sizes.size() > 0)
         {
-            if (!particle.paramsBool[this])
+            if (startTime == 0.0f)
             {
-                float rx = Mathf::RandomFloat(randomDirectionMin.x, randomDirectionMax.x);
-                float ry = Mathf::RandomFloat(randomDirectionMin.y, randomDirectionMax.y);
-                float rz = Mathf::RandomFloat(randomDirectionMin.z, randomDirectionMax.z);
-
-                particle.direction = glm::vec3(rx, ry, rz);
-                if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World)
-                    particle.direction = particle.psRotation * glm::vec3(rx, ry, rz);
-
-                if (particle.parent->getEnablePhysics() &&
-                    particle.parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World &&
-                    particle.rigidbody != nullptr &&
-                    Engine::getSingleton()->getIsRuntimeMode())
+                if (sizes[0].first >= 0 && sizes[0].first <= 0.03f)
                 {
-                    glm::vec3 dir = glm::normalize(particle.direction) * particle.speed * 10.0f;
-                    if (glm::isnan(dir).x) dir.x = 0.0f;
-                    if (glm::isnan(dir).y) dir.y = 0.0f;
-                    if (glm::isnan(dir).z) dir.z = 0.0f;
-                    particle.rigidbody->applyCentralForce(btVector3(dir.x, dir.y, dir.z));
+                    pool.size[index] = std::max(sizes[0].second, 0.0f);
                 }
-
-                particle.paramsBool[this] = true;
             }
         }
-        if (directionType == DirectionType::RandomTimed)
+    }
+
+    void ParticleSizeModifier::update(ParticlePool& pool, size_t count, float deltaTime)
+    {
+        //Keyframes are found per particle, then sizes are blended four at a time
+        const size_t chunkSize = 64;
+        float targets[chunkSize];
+        float factors[chunkSize];
+
+        for (size_t start = 0; start < count; start += chunkSize)
         {
-            timer += deltaTime;
-            if (timer >= changeInterval)
-            {
-                timer = 0.0f;
+            size_t end = std::min(start + chunkSize, count);
 
-                float rx = Mathf::RandomFloat(randomDirectionMin.x, randomDirectionMax.x);
-                float ry = Mathf::RandomFloat(randomDirectionMin.y, randomDirectionMax.y);
-                float rz = Mathf::RandomFloat(randomDirectionMin.z, randomDirectionMax.z);
+            for (size_t n = start; n < end; ++n)
+            {
+                float currentSize = 0.0f;
+                float factor = 1.0f;
 
-                particle.direction = glm::vec3(rx, ry, rz);
-                if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World)
-                    particle.direction = particle.psRotation * glm::vec3(rx, ry, rz);
+                float p = 1.0f - (1.0f / pool.startLifeTime[n] * pool.lifeTime[n]);
+                findKeyframe(sizes, p, pool.startLifeTime[n], deltaTime, currentSize, factor);
 
-                if (particle.parent->getEnablePhysics() &&
-                    particle.parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World &&
-                    particle.rigidbody != nullptr &&
-                    Engine::getSingleton()->getIsRuntimeMode())
-                {
-                    glm::vec3 dir = glm::normalize(particle.direction) * particle.speed * 10.0f;
-                    if (glm::isnan(dir).x) dir.x = 0.0f;
-                    if (glm::isnan(dir).y) dir.y = 0.0f;
-                    if (glm::isnan(dir).z) dir.z = 0.0f;
-                    particle.rigidbody->applyCentralForce(btVector3(dir.x, dir.y, dir.z));
-                }
+                targets[n - start] = std::max(pool.startSize[n] + currentSize, 0.0f);
+                factors[n - start] = factor;
             }
+
+            lerpTowards(pool.size.data() + start, targets, factors, end - start);
         }
     }
 
-    //Rotation modifier
-    void ParticleRotationModifier::onCreateParticle(Particle& particle)
+    //Direction modifier
+    void ParticleDirectionModifier::onCreateParticle(ParticlePool& pool, size_t index)
     {
-        particle.paramsBool[this] = false;
-        particle.paramsVec3[this] = glm::vec3(FLT_MAX);
+        pool.modifierFlags[column][index] = 0;
+        pool.modifierTimers[column][index] = 0.0f;
     }
 
-    void ParticleRotationModifier::update(Particle& particle, float deltaTime)
+    void ParticleDirectionModifier::update(ParticlePool& pool, size_t count, float deltaTime)
     {
-        if (rotationType == RotationType::Constant)
+        bool world = parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::World;
+
+        if (directionType == DirectionType::Constant && !world)
         {
-            particle.rotation = Mathf::toQuaternion(constantRotation);
+            std::fill(pool.direction.x.begin(), pool.direction.x.begin() + count, constantDirection.x);
+            std::fill(pool.direction.y.begin(), pool.direction.y.begin() + count, constantDirection.y);
+            std::fill(pool.direction.z.begin(), pool.direction.z.begin() + count, constantDirection.z);
+
+            return;
         }
-        if (rotationType == RotationType::OnceAtStart)
+
+        bool physics = parent->usesRigidBodies() && world && Engine::getSingleton()->getIsRuntimeMode();
+
+        std::vector<uint8_t>& applied = pool.modifierFlags[column];
+        std::vector<float>& timers = pool.modifierTimers[column];
+
+        for (size_t i = 0; i < count; ++i)
         {
-            if (!particle.paramsBool[this])
+            glm::vec3 direction = constantDirection;
+
+            if (directionType == DirectionType::OnceAtStart)
             {
-                particle.rotation = Mathf::toQuaternion(constantRotation);
-                particle.paramsBool[this] = true;
+                if (applied[i])
+                    continue;
+
+                applied[i] = 1;
             }
-        }
-        if (rotationType == RotationType::RandomAtStart)
-        {
-            if (!particle.paramsBool[this])
+            if (directionType == DirectionType::RandomAtStart)
             {
-                float rx = Mathf::RandomFloat(randomRotationMin.x, randomRotationMax.x);
-                float ry = Mathf::RandomFloat(randomRotationMin.y, randomRotationMax.y);
-                float rz = Mathf::RandomFloat(randomRotationMin.z, randomRotationMax.z);
+                if (applied[i])
+                    continue;
 
-                particle.rotation = Mathf::toQuaternion(glm::vec3(rx, ry, rz));
-                particle.paramsBool[this] = true;
+                direction = parent->randomVector(randomDirectionMin, randomDirectionMax);
+                applied[i] = 1;
             }
-        }
-        if (rotationType == RotationType::RandomTimed)
-        {
-            timer += deltaTime;
-            if (timer >= changeInterval)
+            if (directionType == DirectionType::RandomTimed)
             {
-                timer = 0.0f;
-
-                float rx = Mathf::RandomFloat(randomRotationMin.x, randomRotationMax.x);
-                float ry = Mathf::RandomFloat(randomRotationMin.y, randomRotationMax.y);
-                float rz = Mathf::RandomFloat(randomRotationMin.z, randomRotationMax.z);
+                timers[i] += deltaTime;
+                if (timers[i] < changeInterval)
+                    continue;
 
-                particle.rotation = Mathf::toQuaternion(glm::vec3(rx, ry, rz));
+                direction = parent->randomVector(randomDirectionMin, randomDirectionMax);
+                timers[i] = 0.0f;
             }
+
+            if (world)
+                direction = pool.psRotation[i] * direction;
+
+            pool.direction.set(i, direction);
+
+            if (physics && pool.rigidbody[i] != nullptr)
+                applyForce(pool.rigidbody[i], direction, pool.speed[i]);
         }
+    }
+
+    //Rotation modifier
+    void ParticleRotationModifier::onCreateParticle(ParticlePool& pool, size_t index)
+    {
+        pool.modifierFlags[column][index] = 0;
+        pool.modifierVectors[column].set(index, glm::vec3(FLT_MAX));
+        pool.modifierTimers[column][index] = 0.0f;
+    }
+
+    void ParticleRotationModifier::update(ParticlePool& pool, size_t count, float deltaTime)
+    {
+        if (rotationType == RotationType::Constant)
+        {
+            std::fill(pool.rotation.begin(), pool.rotation.begin() + count, Mathf::toQuaternion(constantRotation));
+            return;
+        }
+
+        std::vector<uint8_t>& applied = pool.modifierFlags[column];
+        ParticleColumn3& prevPositions = pool.modifierVectors[column];
+        std::vector<float>& timers = pool.modifierTimers[column];
+
         if (rotationType == RotationType::FromDirection)
         {
-            if (Renderer::getSingleton()->getCameras().size() > 0)
+            if (Renderer::getSingleton()->getCameras().size() == 0)
+                return;
+
+            bool local = parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::Local;
+            glm::highp_quat offsetRotation = Mathf::toQuaternion(offset);
+
+            for (size_t i = 0; i < count; ++i)
             {
-                glm::vec3 pwPos = particle.position;
-                glm::vec3 prevPos = particle.paramsVec3[this];
+                glm::vec3 pwPos = pool.position.get(i);
+                glm::vec3 prevPos = prevPositions.get(i);
                 if (prevPos != glm::vec3(FLT_MAX) && prevPos != pwPos)
                 {
-                    Camera* cam = Renderer::getSingleton()->getCameras()[0];
                     glm::vec3 dir = glm::normalize(pwPos - prevPos);
-                    glm::vec3 camDir = glm::normalize(pwPos - particle.psPosition);
-                    if (parent->getSimulationSpace() == ParticleEmitter::SimulationSpace::Local)
+                    glm::vec3 camDir = glm::normalize(pwPos - pool.psPosition[i]);
+                    if (local)
                         camDir = glm::normalize(pwPos);
 
                     glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f);
@@ -452,63 +675,102 @@ namespace GX
                     if (abs(glm::dot(dir, camDir)) < 1.0f)
                         up = glm::normalize(glm::cross(dir, camDir));
 
-                    glm::highp_quat angle = glm::quatLookAtRH(dir, up) * Mathf::toQuaternion(offset);
-                    particle.rotation = angle;
+                    glm::highp_quat angle = glm::quatLookAtRH(dir, up) * offsetRotation;
+                    if (glm::isnan(angle).x || glm::isnan(angle).y || glm::isnan(angle).z || glm::isnan(angle).w)
+                        angle = glm::identity<glm::highp_quat>();
+
+                    pool.rotation[i] = angle;
                 }
 
-                particle.paramsVec3[this] = pwPos;
+                prevPositions.set(i, pwPos);
             }
+
+            return;
         }
 
-        if (glm::isnan(particle.rotation).x || glm::isnan(particle.rotation).y || glm::isnan(particle.rotation).z || glm::isnan(particle.rotation).w)
+        for (size_t i = 0; i < count; ++i)
         {
-            particle.rotation = glm::identity<glm::highp_quat>();
+            if (rotationType == RotationType::OnceAtStart)
+            {
+                if (applied[i])
+                    continue;
+
+                pool.rotation[i] = Mathf::toQuaternion(constantRotation);
+                applied[i] = 1;
+            }
+            if (rotationType == RotationType::RandomAtStart)
+            {
+                if (applied[i])
+                    continue;
+
+                pool.rotation[i] = Mathf::toQuaternion(parent->randomVector(randomRotationMin, randomRotationMax));
+                applied[i] = 1;
+            }
+            if (rotationType == RotationType::RandomTimed)
+            {
+                timers[i] += deltaTime;
+                if (timers[i] < changeInterval)
+                    continue;
+
+                pool.rotation[i] = Mathf::toQuaternion(parent->randomVector(randomRotationMin, randomRotationMax));
+                timers[i] = 0.0f;
+            }
+
+            glm::highp_quat& rotation = pool.rotation[i];
+            if (glm::isnan(rotation).x || glm::isnan(rotation).y || glm::isnan(rotation).z || glm::isnan(rotation).w)
+            {
+                rotation = glm::identity<glm::highp_quat>();
+            }
         }
     }
 
     //Speed modifier
-    void ParticleSpeedModifier::onCreateParticle(Particle& particle)
+    void ParticleSpeedModifier::onCreateParticle(ParticlePool& pool, size_t index)
     {
-        particle.paramsBool[this] = false;
+        pool.modifierFlags[column][index] = 0;
+        pool.modifierTimers[column][index] = 0.0f;
     }
 
-    void ParticleSpeedModifier::update(Particle& particle, float deltaTime)
+    void ParticleSpeedModifier::update(ParticlePool& pool, size_t count, float deltaTime)
     {
-        if (particle.parent->getEnablePhysics())
+        if (parent->usesRigidBodies())
             return;
 
         if (speedType == SpeedType::Constant)
         {
-            particle.speed = constantSpeed;
+            std::fill(pool.speed.begin(), pool.speed.begin() + count, constantSpeed);
+            return;
         }
-        if (speedType == SpeedType::OnceAtStart)
+
+        std::vector<uint8_t>& applied = pool.modifierFlags[column];
+        std::vector<float>& timers = pool.modifierTimers[column];
+
+        for (size_t i = 0; i < count; ++i)
         {
-            if (!particle.paramsBool[this])
+            if (speedType == SpeedType::OnceAtStart)
             {
-                particle.speed = constantSpeed;
-                particle.paramsBool[this] = true;
+                if (applied[i])
+                    continue;
+
+                pool.speed[i] = constantSpeed;
+                applied[i] = 1;
             }
-        }
-        if (speedType == SpeedType::RandomAtStart)
-        {
-            if (!particle.paramsBool[this])
+            if (speedType == SpeedType::RandomAtStart)
             {
-                float val = Mathf::RandomFloat(randomSpeedMin, randomSpeedMax);
+                if (applied[i])
+                    continue;
 
-                particle.speed = val;
-                particle.paramsBool[this] = true;
+                pool.speed[i] = parent->randomFloat(randomSpeedMin, randomSpeedMax);
+                applied[i] = 1;
             }
-        }
-        if (speedType == SpeedType::RandomTimed)
-        {
-            timer += deltaTime;
-            if (timer >= changeInterval)
+            if (speedType == SpeedType::RandomTimed)
             {
-                timer = 0.0f;
-
-                float val = Mathf::RandomFloat(randomSpeedMin, randomSpeedMax);
+                timers[i] += deltaTime;
+                if (timers[i] < changeInterval)
+                    continue;
 
-                particle.speed = val;
+                pool.speed[i] = parent->randomFloat(randomSpeedMin, randomSpeedMax);
+                timers[i] = 0.0f;
             }
         }
     }
@@ -520,6 +782,25 @@ namespace GX
         setRenderQueue(2);
 
         parent = ps;
+
+        //Emitters created in the same frame must not repeat each other
+        random.seed(std::random_device()());
+    }
+
+    float ParticleEmitter::randomFloat(float min, float max)
+    {
+        float r = float(random() - random.min()) / float(random.max() - random.min());
+
+        return (r * (max - min)) + min;
+    }
+
+    glm::vec3 ParticleEmitter::randomVector(const glm::vec3& min, const glm::vec3& max)
+    {
+        float rx = randomFloat(min.x, max.x);
+        float ry = randomFloat(min.y, max.y);
+        float rz = randomFloat(min.z, max.z);
+
+        return glm::vec3(rx, ry, rz);
     }
 
     ParticleEmitter::~ParticleEmitter()
@@ -534,15 +815,28 @@ namespace GX
 
     void ParticleEmitter::create()
     {
-        int particlesCount = particles.size();
+        int particlesCount = particles.getCount();
 
         vertexCount = 4 * particlesCount;
         indexCount = 6 * particlesCount;
         vertices = new VertexBuffer[vertexCount];
         indices = new uint32_t[indexCount];
 
+        //Quads never change their indices
+        int _indexCount = 0;
+        for (uint32_t i = 0; i < vertexCount; i += 4)
+        {
+            indices[_indexCount + 0] = i;
+            indices[_indexCount + 1] = i + 1;
+            indices[_indexCount + 2] = i + 2;
+            indices[_indexCount + 3] = i;
+            indices[_indexCount + 4] = i + 2;
+            indices[_indexCount + 5] = i + 3;
+            _indexCount += 6;
+        }
+
         vbh = bgfx::createDynamicVertexBuffer(vertexCount, VertexLayouts::particleVertexLayout);
-        ibh = bgfx::createDynamicIndexBuffer(indexCount, BGFX_BUFFER_INDEX32);
+        ibh = bgfx::createDynamicIndexBuffer(bgfx::copy(indices, sizeof(uint32_t) * indexCount), BGFX_BUFFER_INDEX32);
     }
 
     void ParticleEmitter::destroy()
@@ -577,226 +871,317 @@ namespace GX
 
     void ParticleEmitter::destroyParticles()
     {
-        for (auto it = particles.begin(); it != particles.end(); ++it)
-            it->reset();
-
         particles.clear();
     }
 
-    void ParticleEmitter::update(float deltaTime)
+    bool ParticleEmitter::usesPhysicsWorld()
     {
-        if (!isPlaying)
-            return;
-
-        if (deltaTime <= 0)
-            return;
+        return enablePhysics && Engine::getSingleton()->getIsRuntimeMode();
+    }
 
-        //1. Update particles
-        //2. Update modifiers
-        //3. Update buffers
+    void ParticleEmitter::emit()
+    {
+        Transform* psTransform = parent->getGameObject()->getTransform();
 
-        if (emissionTime < emissionRate)
+        for (int i = 0; i < emissionCount; ++i)
         {
-            emissionTime += deltaTime;
-        }
-        else
-        {
-            emissionTime = 0.0f;
+            if (particles.getCount() >= maxParticles)
+                break;
 
-            if (emissionCount > 0)
+            float lifeTime = randomFloat(lifeTimeMin, lifeTimeMax);
+            float _size = randomFloat(startSizeMin, startSizeMax);
+            float speed = startSpeed;
+            glm::vec3 position = glm::vec3(0.0f);
+            glm::vec3 direction = startDirection;
+
+            if (simulationSpace == SimulationSpace::World)
+            {
+                position = psTransform->getPosition();
+                direction = psTransform->getRotation() * startDirection;
+                glm::vec3 scl = psTransform->getScale();
+                float sz = std::max(scl.x, scl.y);
+                sz = std::max(sz, scl.z);
+                _size = sz * randomFloat(startSizeMin, startSizeMax);
+                speed = sz * startSpeed;
+            }
+
+            glm::vec3 shapePosition = glm::vec3(0.0f);
+
+            if (shape == ParticleEmitterShape::Box)
+            {
+                shapePosition.x = randomFloat(-size.x, size.x);
+                shapePosition.y = randomFloat(-size.y, size.y);
+                shapePosition.z = randomFloat(-size.z, size.z);
+            }
+
+            if (shape == ParticleEmitterShape::Sphere
+                || shape == ParticleEmitterShape::Circle)
             {
-                for (int i = 0; i < emissionCount; ++i)
+                if (radius != 0.0f)
                 {
-                    if (particles.size() < maxParticles)
-                    {
-                        Transform* psTransform = parent->getGameObject()->getTransform();
+                    shapePosition.x = randomFloat(-radius / 2.0f, radius / 2.0f);
+                    shapePosition.y = randomFloat(-radius / 2.0f, radius / 2.0f);
+                    shapePosition.z = randomFloat(-radius / 2.0f, radius / 2.0f);
 
-                        Particle p;
+                    shapePosition *= glm::vec3(1.0f / std::sqrt(shapePosition.x * shapePosition.x + shapePosition.y * shapePosition.y + shapePosition.z * shapePosition.z));
+                    shapePosition *= glm::vec3(radius);
+                }
+            }
 
-                        p.reset();
-                        p.active = true;
-                        p.lifeTime = Mathf::RandomFloat(lifeTimeMin, lifeTimeMax);
-                        p.startLifeTime = p.lifeTime;
-                        p.size = Mathf::RandomFloat(startSizeMin, startSizeMax);
-                        p.speed = startSpeed;
-                        p.direction = startDirection;
-                        p.parent = this;
+            if (shape == ParticleEmitterShape::Circle)
+            {
+                shapePosition.y = 0.0f;
+            }
 
-                        if (simulationSpace == SimulationSpace::World)
-                        {
-                            p.position = psTransform->getPosition();
-                            p.direction = psTransform->getRotation() * startDirection;
-                            glm::vec3 scl = psTransform->getScale();
-                            float sz = std::max(scl.x, scl.y);
-                            sz = std::max(sz, scl.z);
-                            p.size = sz * Mathf::RandomFloat(startSizeMin, startSizeMax);
-                            p.speed = sz * startSpeed;
-                        }
+            if (simulationSpace == SimulationSpace::World)
+            {
+                shapePosition = psTransform->getRotation() * shapePosition;
+            }
 
-                        p.startSize = p.size;
+            position += shapePosition;
 
-                        glm::vec3 shapePosition = glm::vec3(0.0f);
+            size_t p = particles.add();
 
-                        if (shape == ParticleEmitterShape::Box)
-                        {
-                            shapePosition.x = Mathf::RandomFloat(-size.x, size.x);
-                            shapePosition.y = Mathf::RandomFloat(-size.y, size.y);
-                            shapePosition.z = Mathf::RandomFloat(-size.z, size.z);
-                        }
+            particles.lifeTime[p] = lifeTime;
+            particles.startLifeTime[p] = lifeTime;
+            particles.size[p] = _size;
+            particles.startSize[p] = _size;
+            particles.speed[p] = speed;
+            particles.position.set(p, position);
+            particles.psPosition[p] = psTransform->getPosition();
+            particles.psRotation[p] = psTransform->getRotation();
 
-                        if (shape == ParticleEmitterShape::Sphere
-                            || shape == ParticleEmitterShape::Circle)
-                        {
-                            if (radius != 0.0f)
-                            {
-                                shapePosition.x = Mathf::RandomFloat(-radius / 2.0f, radius / 2.0f);
-                                shapePosition.y = Mathf::RandomFloat(-radius / 2.0f, radius / 2.0f);
-                                shapePosition.z = Mathf::RandomFloat(-radius / 2.0f, radius / 2.0f);
+            //Physics
+            if (usesRigidBodies() &&
+                simulationSpace == SimulationSpace::World)
+            {
+                direction = glm::vec3(0.0f);
 
-                                shapePosition *= glm::vec3(1.0f / std::sqrt(shapePosition.x * shapePosition.x + shapePosition.y * shapePosition.y + shapePosition.z * shapePosition.z));
-                                shapePosition *= glm::vec3(radius);
-                            }
-                        }
+                if (Engine::getSingleton()->getIsRuntimeMode())
+                {
+                    btTransform startTransform;
+                    btVector3 localInertia(0, 0, 0);
+                    startTransform.setOrigin(btVector3(position.x, position.y, position.z));
 
-                        if (shape == ParticleEmitterShape::Circle)
-                        {
-                            shapePosition.y = 0.0f;
-                        }
+                    btSphereShape* collider = new btSphereShape(std::max(_size, 0.1f));
+                    btDefaultMotionState* motionState = new btDefaultMotionState(startTransform);
 
-                        if (simulationSpace == SimulationSpace::World)
-                        {
-                            shapePosition = psTransform->getRotation() * shapePosition;
-                        }
+                    btRigidBody::btRigidBodyConstructionInfo rbInfo(1.0f, motionState, collider);
+                    btRigidBody* rigidbody = new btRigidBody(rbInfo);
 
-                        p.position += shapePosition;
-                        p.psPosition = psTransform->getPosition();
-                        p.psRotation = psTransform->getRotation();
+                    rigidbody->setActivationState(DISABLE_DEACTIVATION);
+                    rigidbody->setMassProps(0.1f, localInertia);
+                    rigidbody->setDamping(0.0f, 0.0f);
+                    rigidbody->updateInertiaTensor();
+                    rigidbody->clearForces();
 
-                        //Physics
-                        if (enablePhysics &&
-                            simulationSpace == SimulationSpace::World)
+                    for (size_t j = 0; j < p; ++j)
+                    {
+                        btRigidBody* other = particles.rigidbody[j];
+                        if (other != nullptr)
                         {
-                            p.direction = glm::vec3(0.0f);
-
-                            if (Engine::getSingleton()->getIsRuntimeMode())
-                            {
-                                btTransform startTransform;
-                                btVector3 localInertia(0, 0, 0);
-                                startTransform.setOrigin(btVector3(p.position.x, p.position.y, p.position.z));
+                            other->setIgnoreCollisionCheck(rigidbody, true);
+                            rigidbody->setIgnoreCollisionCheck(other, true);
+                        }
+                    }
 
-                                p.collider = new btSphereShape(std::max(p.size, 0.1f));
-                                p.motionState = new btDefaultMotionState(startTransform);
+                    PhysicsManager::getSingleton()->getWorld()->addRigidBody(rigidbody);
 
-                                btRigidBody::btRigidBodyConstructionInfo rbInfo(1.0f, p.motionState, p.collider);
-                                p.rigidbody = new btRigidBody(rbInfo);
+                    rigidbody->setGravity(btVector3(0.0f, 0.0f, 0.0f));
+                    rigidbody->setFriction(friction);
+                    rigidbody->setRestitution(bounciness);
 
-                                p.rigidbody->setActivationState(DISABLE_DEACTIVATION);
-                                p.rigidbody->setMassProps(0.1f, localInertia);
-                                p.rigidbody->setDamping(0.0f, 0.0f);
-                                p.rigidbody->updateInertiaTensor();
-                                p.rigidbody->clearForces();
+                    particles.collider[p] = collider;
+                    particles.motionState[p] = motionState;
+                    particles.rigidbody[p] = rigidbody;
+                }
+            }
 
-                                for (auto& it : particles)
-                                {
-                                    if (it.rigidbody != nullptr)
-                                    {
-                                        it.rigidbody->setIgnoreCollisionCheck(p.rigidbody, true);
-                                        p.rigidbody->setIgnoreCollisionCheck(it.rigidbody, true);
-                                    }
-                                }
+            particles.direction.set(p, direction);
 
-                                PhysicsManager::getSingleton()->getWorld()->addRigidBody(p.rigidbody);
+            for (auto jt = modifiers.begin(); jt != modifiers.end(); ++jt)
+            {
+                ParticleModifier* modifier = *jt;
+                modifier->onCreateParticle(particles, p);
+            }
+        }
+    }
 
-                                p.rigidbody->setGravity(btVector3(0.0f, 0.0f, 0.0f));
-                                p.rigidbody->setFriction(friction);
-                                p.rigidbody->setRestitution(bounciness);
-                            }
-                        }
+    void ParticleEmitter::collide()
+    {
+        btDiscreteDynamicsWorld* world = PhysicsManager::getSingleton()->getWorld();
+        if (world == nullptr)
+            return;
 
-                        particles.push_back(p);
+        size_t count = particles.getCount();
 
-                        for (auto jt = modifiers.begin(); jt != modifiers.end(); ++jt)
-                        {
-                            ParticleModifier* modifier = *jt;
-                            modifier->onCreateParticle(p);
-                        }
-                    }
-                }
-            }
+        //Local space particles are traced in world space and the hit is brought back to emitter space
+        bool local = simulationSpace == SimulationSpace::Local;
+        glm::mat4x4 toWorld = glm::identity<glm::mat4x4>();
+        glm::mat4x4 toLocal = glm::identity<glm::mat4x4>();
+        if (local)
+        {
+            Transform* psTransform = parent->getGameObject()->getTransform();
+            toWorld = psTransform->getTransformMatrix();
+            toLocal = psTransform->getTransformMatrixInverse();
         }
 
-        for (auto it = particles.begin(); it != particles.end(); ++it)
+        for (size_t i = 0; i < count; ++i)
         {
-            Particle& particle = *it;
+            glm::vec3 from = particles.lastPosition.get(i);
+            glm::vec3 to = particles.position.get(i);
 
-            if (!particle.active)
+            if (local)
+            {
+                from = glm::vec3(toWorld * glm::vec4(from, 1.0f));
+                to = glm::vec3(toWorld * glm::vec4(to, 1.0f));
+            }
+
+            //Resting particles don't cast rays
+            glm::vec3 delta = to - from;
+            if (glm::dot(delta, delta) < FLT_EPSILON * FLT_EPSILON)
                 continue;
 
-            glm::vec3 dir = glm::normalize(particle.direction);
-            if (glm::isnan(dir).x) dir.x = 0.0f;
-            if (glm::isnan(dir).y) dir.y = 0.0f;
-            if (glm::isnan(dir).z) dir.z = 0.0f;
+            btVector3 btFrom(from.x, from.y, from.z);
+            btVector3 btTo(to.x, to.y, to.z);
+
+            ParticleRayResultCallback res(btFrom, btTo);
+            world->rayTest(btFrom, btTo, res);
+
+            if (!res.hasHit())
+                continue;
 
-            if (enablePhysics &&
-                simulationSpace == SimulationSpace::World &&
-                particle.rigidbody != nullptr &&
-                Engine::getSingleton()->getIsRuntimeMode())
+            if (collisionResponse == CollisionResponse::Kill)
             {
-                btTransform trans;
-                particle.motionState->getWorldTransform(trans);
-                btVector3 pos = trans.getOrigin();
-                particle.position = glm::vec3(pos.x(), pos.y(), pos.z());
+                particles.lifeTime[i] = -1.0f;
+                continue;
             }
-            else
+
+            glm::vec3 normal = glm::vec3(res.m_hitNormalWorld.x(), res.m_hitNormalWorld.y(), res.m_hitNormalWorld.z());
+            glm::vec3 point = glm::vec3(res.m_hitPointWorld.x(), res.m_hitPointWorld.y(), res.m_hitPointWorld.z());
+
+            //Keep the particle slightly above the surface, so the next ray starts outside of it
+            point += normal * 0.01f;
+
+            if (local)
+            {
+                point = glm::vec3(toLocal * glm::vec4(point, 1.0f));
+                normal = glm::normalize(glm::transpose(glm::mat3(toWorld)) * normal);
+            }
+
+            particles.position.set(i, point);
+
+            glm::vec3 velocity = particles.direction.get(i);
+            if (glm::dot(velocity, velocity) > 0.0f)
+                velocity = glm::normalize(velocity) * particles.speed[i];
+
+            velocity = bounce(velocity, normal, friction, bounciness);
+
+            particles.direction.set(i, velocity);
+            particles.speed[i] = glm::length(velocity);
+
+            for (auto jt = modifiers.begin(); jt != modifiers.end(); ++jt)
             {
-                particle.position += (dir * particle.speed) * deltaTime;
+                ParticleModifier* modifier = *jt;
+                modifier->onCollideParticle(particles, i, normal);
             }
+        }
+    }
+
+    void ParticleEmitter::update(float deltaTime)
+    {
+        if (!isPlaying)
+            return;
+
+        if (deltaTime <= 0)
+            return;
+
+        //1. Emit particles
+        //2. Update particles
+        //3. Update modifiers
+        //Buffers are updated in onRender
+
+        if (emissionTime < emissionRate)
+        {
+            emissionTime += deltaTime;
+        }
+        else
+        {
+            emissionTime = 0.0f;
+
+            if (emissionCount > 0)
+                emit();
+        }
+
+        size_t count = particles.getCount();
+
+        bool raycast = enablePhysics &&
+            collisionMode == CollisionMode::Raycast &&
+            Engine::getSingleton()->getIsRuntimeMode();
+
+        if (raycast)
+        {
+            particles.lastPosition.x = particles.position.x;
+            particles.lastPosition.y = particles.position.y;
+            particles.lastPosition.z = particles.position.z;
+        }
+
+        if (animated && animationGridSize.x > 0 && animationGridSize.y > 0)
+        {
+            float maxFrames = animationGridSize.x * animationGridSize.y;
 
-            if (animated && animationGridSize.x > 0 && animationGridSize.y > 0)
+            for (size_t i = 0; i < count; ++i)
             {
-                float maxFrames = animationGridSize.x * animationGridSize.y;
+                float& currentFrame = particles.currentFrame[i];
 
                 if (animationTimeMode == AnimationTimeMode::Speed)
-                    particle.currentFrame += Time::getDeltaTime() * Time::getTimeScale() * particle.speed * (float)animationFps;
+                    currentFrame += Time::getDeltaTime() * Time::getTimeScale() * particles.speed[i] * (float)animationFps;
                 else if (animationTimeMode == AnimationTimeMode::Lifetime)
-                    particle.currentFrame = maxFrames - (maxFrames / particle.startLifeTime * particle.lifeTime);
+                    currentFrame = maxFrames - (maxFrames / particles.startLifeTime[i] * particles.lifeTime[i]);
                 else
-                    particle.currentFrame += (Time::getDeltaTime() * (float)animationFps) * Time::getTimeScale();
+                    currentFrame += (Time::getDeltaTime() * (float)animationFps) * Time::getTimeScale();
 
-                if (particle.currentFrame > maxFrames)
-                    particle.currentFrame = 0;
+                if (currentFrame > maxFrames)
+                    currentFrame = 0;
             }
+        }
 
-            particle.lifeTime -= deltaTime;
+        integrate(particles, deltaTime);
 
-            if (particle.lifeTime < 0.0f)
-            {
-                particle.reset();
-            }
-            else
+        //Bodies are moved by the physics world
+        if (usesRigidBodies() &&
+            simulationSpace == SimulationSpace::World &&
+            Engine::getSingleton()->getIsRuntimeMode())
+        {
+            for (size_t i = 0; i < count; ++i)
             {
-                for (auto jt = modifiers.begin(); jt != modifiers.end(); ++jt)
-                {
-                    ParticleModifier* modifier = *jt;
+                if (particles.rigidbody[i] == nullptr)
+                    continue;
 
-                    float ptime = particle.getPlaybackTime();
-                    if (ptime >= modifier->getStartTime())
-                    {
-                        modifier->update(particle, deltaTime);
-                    }
-                }
+                btTransform trans;
+                particles.motionState[i]->getWorldTransform(trans);
+                btVector3 pos = trans.getOrigin();
+                particles.position.set(i, glm::vec3(pos.x(), pos.y(), pos.z()));
             }
         }
 
-        auto it = std::find_if(particles.begin(), particles.end(), [=](Particle& p) -> bool { return !p.active; });
-        while (it != particles.end())
+        particles.removeDead();
+
+        for (auto jt = modifiers.begin(); jt != modifiers.end(); ++jt)
         {
-            particles.erase(it);
-            it = std::find_if(particles.begin(), particles.end(), [=](Particle& p) -> bool { return !p.active; });
+            ParticleModifier* modifier = *jt;
+
+            size_t modifierCount = particles.getCountOlderThan(modifier->getStartTime());
+            if (modifierCount > 0)
+                modifier->update(particles, modifierCount, deltaTime);
         }
 
-        if (particles.size() == 0)
-            destroy();
+        //After all modifiers, so the traced segment covers the whole movement of this update
+        if (raycast)
+        {
+            collide();
+            particles.removeDead();
+        }
 
         if (playbackTime < duration)
         {
@@ -805,7 +1190,7 @@ namespace GX
         else
         {
             if (!loop)
-                stop();
+                halt();
             else
             {
                 playbackTime = 0.0f;
@@ -831,16 +1216,21 @@ namespace GX
         }
     }
 
-    void ParticleEmitter::stop()
+    void ParticleEmitter::halt()
     {
         isPlaying = false;
         playbackTime = 0.0f;
         emissionTime = 0.0f;
         destroyParticles();
-        destroy();
         bounds = AxisAlignedBox::BOX_INFINITE;
     }
 
+    void ParticleEmitter::stop()
+    {
+        halt();
+        destroy();
+    }
+
     void ParticleEmitter::cloneProperties(ParticleEmitter* to)
     {
         to->setDuration(getDuration());
@@ -862,6 +1252,11 @@ namespace GX
         to->setTimeScale(getTimeScale());
         to->setRadius(getRadius());
         to->setSize(getSize());
+        to->setEnablePhysics(getEnablePhysics());
+        to->setFriction(getFriction());
+        to->setBounciness(getBounciness());
+        to->setCollisionMode(getCollisionMode());
+        to->setCollisionResponse(getCollisionResponse());
         to->setAnimated(getAnimated());
         to->setAnimationGridSize(getAnimationGridSize());
         to->setAnimationTimeMode(getAnimationTimeMode());
@@ -946,7 +1341,9 @@ namespace GX
     ParticleGravityModifier* ParticleEmitter::addModifier()
     {
         ParticleGravityModifier* modifier = new ParticleGravityModifier(this);
+        modifier->column = modifiers.size();
         modifiers.push_back(modifier);
+        particles.addModifierColumn();
 
         return modifier;
     }
@@ -955,7 +1352,9 @@ namespace GX
     ParticleColorModifier* ParticleEmitter::addModifier()
     {
         ParticleColorModifier* modifier = new ParticleColorModifier(this);
+        modifier->column = modifiers.size();
         modifiers.push_back(modifier);
+        particles.addModifierColumn();
 
         return modifier;
     }
@@ -964,7 +1363,9 @@ namespace GX
     ParticleSizeModifier* ParticleEmitter::addModifier()
     {
         ParticleSizeModifier* modifier = new ParticleSizeModifier(this);
+        modifier->column = modifiers.size();
         modifiers.push_back(modifier);
+        particles.addModifierColumn();
 
         return modifier;
     }
@@ -973,7 +1374,9 @@ namespace GX
     ParticleDirectionModifier* ParticleEmitter::addModifier()
     {
         ParticleDirectionModifier* modifier = new ParticleDirectionModifier(this);
+        modifier->column = modifiers.size();
         modifiers.push_back(modifier);
+        particles.addModifierColumn();
 
         return modifier;
     }
@@ -982,7 +1385,9 @@ namespace GX
     ParticleRotationModifier* ParticleEmitter::addModifier()
     {
         ParticleRotationModifier* modifier = new ParticleRotationModifier(this);
+        modifier->column = modifiers.size();
         modifiers.push_back(modifier);
+        particles.addModifierColumn();
 
         return modifier;
     }
@@ -991,7 +1396,9 @@ namespace GX
     ParticleSpeedModifier* ParticleEmitter::addModifier()
     {
         ParticleSpeedModifier* modifier = new ParticleSpeedModifier(this);
+        modifier->column = modifiers.size();
         modifiers.push_back(modifier);
+        particles.addModifierColumn();
 
         return modifier;
     }
@@ -1006,11 +1413,7 @@ namespace GX
     {
         auto it = std::find(modifiers.begin(), modifiers.end(), modifier);
         if (it != modifiers.end())
-        {
-            ParticleModifier* mod = *it;
-            delete mod;
-            modifiers.erase(it);
-        }
+            removeModifier((int)(it - modifiers.begin()));
     }
 
     void ParticleEmitter::removeModifier(int index)
@@ -1021,6 +1424,11 @@ namespace GX
             ParticleModifier* mod = *it;
             delete mod;
             modifiers.erase(it);
+
+            //State columns of the following modifiers move one place back
+            particles.removeModifierColumn(index);
+            for (size_t i = index; i < modifiers.size(); ++i)
+                modifiers[i]->column = i;
         }
     }
 
@@ -1074,7 +1482,7 @@ namespace GX
         if (!parent->getEnabled())
             return;
 
-        if (particles.size() == 0)
+        if (particles.getCount() == 0)
             return;
 
         Transform* psTransform = parent->getGameObject()->getTransform();
@@ -1103,118 +1511,121 @@ namespace GX
             }
         }
 
-        int particlesCount = particles.size();
+        int particlesCount = particles.getCount();
 
         uint32_t _vertexCount = 4 * particlesCount;
-        uint32_t _indexCount = 6 * particlesCount;
 
         if (_vertexCount > 0)
         {
             if (_vertexCount != vertexCount)
                 recreate();
 
-            bounds = AxisAlignedBox::BOX_NULL;
+            bool animate = animated && animationGridSize.x > 0 && animationGridSize.y > 0;
 
-            int curParticle = 0;
-            for (uint32_t i = 0; i < vertexCount; i += 4, ++curParticle)
+            //Vertices of each range are written by one worker, bounds are merged afterwards
+            const size_t grainSize = 4096;
+            std::vector<AxisAlignedBox> rangeBounds((particlesCount + grainSize - 1) / grainSize, AxisAlignedBox::BOX_NULL);
+
+            JobSystem::getSingleton()->parallelFor(particlesCount, grainSize, [=, &rangeBounds](size_t begin, size_t end)
             {
-                Particle& particle = particles[curParticle];
-                
-                float x = particle.position.x;
-                float y = particle.position.y;
-                float z = particle.position.z;
-                float w = particle.size;
-                float h = particle.size;
-
-                if (w < 0.0f) w = 0.0f;
-                if (h < 0.0f) h = 0.0f;
-
-                glm::highp_quat angle = particle.rotation;
-                glm::vec3 center = glm::vec3(x, y, z);
-                
-                glm::vec3 positions[4];
-                float hb = h / 2.0f;
-                float ht = h / 2.0f;
-                    
-                positions[0] = glm::vec3(x, y - hb, z) - glm::vec3((float)w / 2, 0, 0);
-                positions[1] = glm::vec3(x, y + ht, z) - glm::vec3((float)w / 2, 0, 0);
-                positions[2] = glm::vec3(x, y + ht, z) + glm::vec3((float)w / 2, 0, 0);
-                positions[3] = glm::vec3(x, y - hb, z) + glm::vec3((float)w / 2, 0, 0);
-
-                float x1 = 1;
-                float y1 = 1;
-                float x0 = 0;
-                float y0 = 0;
-
-                if (animated && animationGridSize.x > 0 && animationGridSize.y > 0)
+                AxisAlignedBox& box = rangeBounds[begin / grainSize];
+
+                for (size_t curParticle = begin; curParticle < end; ++curParticle)
                 {
-                    int y = std::ceilf(particle.currentFrame / animationGridSize.x);
-                    int x = (int)(particle.currentFrame + 1.0f) - (animationGridSize.x * y);
+                    uint32_t i = curParticle * 4;
 
-                    float w = 1.0f / animationGridSize.x;
-                    float h = 1.0f / animationGridSize.y;
+                    float x = particles.position.x[curParticle];
+                    float y = particles.position.y[curParticle];
+                    float z = particles.position.z[curParticle];
+                    float w = particles.size[curParticle];
+                    float h = particles.size[curParticle];
 
-                    x0 = (w * (float)x);
-                    y0 = 1.0f - (h * (float)y);
-                    x1 = x0 - w;
-                    y1 = y0 + h;
-                }
+                    if (w < 0.0f) w = 0.0f;
+                    if (h < 0.0f) h = 0.0f;
 
-                for (int j = 0; j < 4; ++j)
-                {
-                    glm::vec2 uv = glm::vec2(0, 0);
-                    if (j == 1) uv = glm::vec2(0, 1);
-                    if (j == 2) uv = glm::vec2(1, 1);
-                    if (j == 3) uv = glm::vec2(1, 0);
+                    glm::highp_quat angle = particles.rotation[curParticle];
+                    glm::vec3 center = glm::vec3(x, y, z);
+
+                    glm::vec3 positions[4];
+                    float hb = h / 2.0f;
+                    float ht = h / 2.0f;
+
+                    positions[0] = glm::vec3(x, y - hb, z) - glm::vec3((float)w / 2, 0, 0);
+                    positions[1] = glm::vec3(x, y + ht, z) - glm::vec3((float)w / 2, 0, 0);
+                    positions[2] = glm::vec3(x, y + ht, z) + glm::vec3((float)w / 2, 0, 0);
+                    positions[3] = glm::vec3(x, y - hb, z) + glm::vec3((float)w / 2, 0, 0);
 
-                    if (animated && animationGridSize.x > 0 && animationGridSize.y > 0)
+                    float x1 = 1;
+                    float y1 = 1;
+                    float x0 = 0;
+                    float y0 = 0;
+
+                    if (animate)
                     {
-                        uv = glm::vec2(x0, y0);
-                        if (j == 1) uv = glm::vec2(x0, y1);
-                        if (j == 2) uv = glm::vec2(x1, y1);
-                        if (j == 3) uv = glm::vec2(x1, y0);
-                    }
+                        float currentFrame = particles.currentFrame[curParticle];
+
+                        int y = std::ceilf(currentFrame / animationGridSize.x);
+                        int x = (int)(currentFrame + 1.0f) - (animationGridSize.x * y);
 
-                    VertexBuffer* vert = &vertices[i + j];
+                        float w = 1.0f / animationGridSize.x;
+                        float h = 1.0f / animationGridSize.y;
 
-                    vert->position = ((rot * angle) * (positions[j] - center)) + center;
+                        x0 = (w * (float)x);
+                        y0 = 1.0f - (h * (float)y);
+                        x1 = x0 - w;
+                        y1 = y0 + h;
+                    }
+
+                    glm::vec3 offset = glm::vec3(0.0f);
                     if (origin == Origin::Bottom)
                     {
-                        glm::vec3 dir = particle.direction;
+                        glm::vec3 dir = particles.direction.get(curParticle);
                         dir = glm::normalize(dir);
                         if (glm::isnan(dir).x) dir.x = 0.0f;
                         if (glm::isnan(dir).y) dir.y = 0.0f;
                         if (glm::isnan(dir).z) dir.z = 0.0f;
-                        vert->position += dir * glm::vec3(h / 2.0f);
+                        offset = dir * glm::vec3(h / 2.0f);
                     }
 
-                    if (!glm::isnan(vert->position).x && !glm::isnan(vert->position).y && !glm::isnan(vert->position).z)
+                    uint32_t color = Color::packABGR(particles.color[curParticle]);
+                    glm::highp_quat r = rot * angle;
+
+                    for (int j = 0; j < 4; ++j)
                     {
-                        bounds.merge(vert->position);
-                    }
+                        glm::vec2 uv = glm::vec2(0, 0);
+                        if (j == 1) uv = glm::vec2(0, 1);
+                        if (j == 2) uv = glm::vec2(1, 1);
+                        if (j == 3) uv = glm::vec2(1, 0);
+
+                        if (animate)
+                        {
+                            uv = glm::vec2(x0, y0);
+                            if (j == 1) uv = glm::vec2(x0, y1);
+                            if (j == 2) uv = glm::vec2(x1, y1);
+                            if (j == 3) uv = glm::vec2(x1, y0);
+                        }
 
-                    vert->texcoord0 = uv;
-                    vert->color = Color::packABGR(particle.color);
+                        VertexBuffer* vert = &vertices[i + j];
+
+                        vert->position = (r * (positions[j] - center)) + center + offset;
+
+                        if (!glm::isnan(vert->position).x && !glm::isnan(vert->position).y && !glm::isnan(vert->position).z)
+                        {
+                            box.merge(vert->position);
+                        }
+
+                        vert->texcoord0 = uv;
+                        vert->color = color;
+                    }
                 }
-            }
+            });
 
-            int _indexCount = 0;
-            for (uint32_t i = 0; i < vertexCount; i += 4)
-            {
-                indices[_indexCount + 0] = i;
-                indices[_indexCount + 1] = i + 1;
-                indices[_indexCount + 2] = i + 2;
-                indices[_indexCount + 3] = i;
-                indices[_indexCount + 4] = i + 2;
-                indices[_indexCount + 5] = i + 3;
-                _indexCount += 6;
-            }
+            bounds = AxisAlignedBox::BOX_NULL;
+            for (auto& box : rangeBounds)
+                bounds.merge(box);
 
             const bgfx::Memory* mem = bgfx::makeRef(vertices, sizeof(VertexBuffer) * vertexCount);
             bgfx::update(vbh, 0, mem);
-
-            mem = bgfx::makeRef(indices, sizeof(uint32_t) * indexCount);
-            bgfx::update(ibh, 0, mem);
         }
         else
         {
@@ -1381,10 +1792,13 @@ namespace GX
 
     ParticleSystem::ParticleSystem() : Component(APIManager::getSingleton()->particlesystem_class)
     {
+        ParticleManager::getSingleton()->addParticleSystem(this);
     }
 
     ParticleSystem::~ParticleSystem()
     {
+        ParticleManager::getSingleton()->removeParticleSystem(this);
+
         for (auto it = emitters.begin(); it != emitters.end(); ++it)
             delete* it;
 
@@ -1469,17 +1883,6 @@ namespace GX
             play();
     }
 
-    void ParticleSystem::onUpdate(float deltaTime)
-    {
-        float timeScale = Time::getTimeScale();
-
-        for (auto it = emitters.begin(); it != emitters.end(); ++it)
-        {
-            ParticleEmitter* emitter = *it;
-            emitter->update((deltaTime * emitter->getTimeScale()) * timeScale);
-        }
-    }
-
     Component* ParticleSystem::onClone()
     {
         ParticleSystem* newComponent = new ParticleSystem();
@@ -4,6 +4,7 @@
 #include "Renderable.h"
 
 #include <bgfx/bgfx.h>
+#include <random>
 
 #include "../Math/AxisAlignedBox.h"
 #include "../Renderer/Color.h"
@@ -29,47 +30,85 @@ namespace GX
 		Circle
 	};
 
-	struct Particle
+	//Three float arrays, so vector math can run on four particles at once
+	struct ParticleColumn3
 	{
 	public:
-		bool active = false;
-		glm::vec3 position = glm::vec3(0.0f);
-		glm::vec3 direction = glm::vec3(0.0f);
-		glm::highp_quat rotation = glm::identity<glm::highp_quat>();
-		float size = 1.0f;
-		float startSize = 1.0f;
-		Color color = Color::White;
-		float speed = 0.0f;
-		float lifeTime = 0.0f;
-		float startLifeTime = 0.0f;
-		float currentFrame = 0;
-		glm::vec3 psPosition = glm::vec3(0.0f);
-		glm::highp_quat psRotation = glm::identity<glm::highp_quat>();
-		std::map<ParticleModifier*, bool> paramsBool;
-		std::map<ParticleModifier*, glm::vec3> paramsVec3;
-
-		btSphereShape* collider = nullptr;
-		btRigidBody* rigidbody = nullptr;
-		btDefaultMotionState* motionState = nullptr;
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> z;
+
+		glm::vec3 get(size_t index) { return glm::vec3(x[index], y[index], z[index]); }
+		void set(size_t index, const glm::vec3& value) { x[index] = value.x; y[index] = value.y; z[index] = value.z; }
+		void push_back(const glm::vec3& value) { x.push_back(value.x); y.push_back(value.y); z.push_back(value.z); }
+		void clear() { x.clear(); y.clear(); z.clear(); }
+	};
 
-		ParticleEmitter* parent = nullptr;
+	//Live particles of an emitter, stored as one array per attribute.
+	//Particles are kept in emission order, so the oldest ones are always at the front
+	struct ParticlePool
+	{
+	public:
+		ParticleColumn3 position;
+		//Position at the start of the current update, collision rays are cast from it
+		ParticleColumn3 lastPosition;
+		ParticleColumn3 direction;
+		std::vector<float> speed;
+		std::vector<float> size;
+		std::vector<float> startSize;
+		std::vector<float> lifeTime;
+		std::vector<float> startLifeTime;
+		std::vector<float> currentFrame;
+		std::vector<Color> color;
+		std::vector<glm::highp_quat> rotation;
+		std::vector<glm::vec3> psPosition;
+		std::vector<glm::highp_quat> psRotation;
+
+		std::vector<btSphereShape*> collider;
+		std::vector<btRigidBody*> rigidbody;
+		std::vector<btDefaultMotionState*> motionState;
+
+		//State of each modifier of the emitter, one column per modifier
+		std::vector<std::vector<uint8_t>> modifierFlags;
+		std::vector<ParticleColumn3> modifierVectors;
+		std::vector<std::vector<float>> modifierTimers;
+
+		size_t getCount() { return lifeTime.size(); }
+		float getPlaybackTime(size_t index) { return startLifeTime[index] - lifeTime[index]; }
+
+		//Number of particles at the front of the pool that are at least this old
+		size_t getCountOlderThan(float time);
+
+		size_t add();
+		void removeDead();
+		void clear();
+
+		void addModifierColumn();
+		void removeModifierColumn(size_t index);
 
-		void reset();
-		float getPlaybackTime();
+	private:
+		void destroyPhysics(size_t index);
 	};
 
 	class ParticleModifier
 	{
+		friend class ParticleEmitter;
+
 	protected:
 		float startTime = 0.0f;
 		ParticleEmitter* parent = nullptr;
+		size_t column = 0;
 
 	public:
 		ParticleModifier(ParticleEmitter* _parent) { parent = _parent; }
 		virtual ~ParticleModifier() {}
 
-		virtual void onCreateParticle(Particle& particle) {}
-		virtual void update(Particle& particle, float deltaTime) {}
+		//Called for every emitted particle
+		virtual void onCreateParticle(ParticlePool& pool, size_t index) {}
+		//Called once per update for the first count particles of the pool, which are older than the start time
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime) {}
+		//Called when a particle bounces off a collider without a rigid body
+		virtual void onCollideParticle(ParticlePool& pool, size_t index, const glm::vec3& normal) {}
 		virtual std::string getType() { return "ParticleModifier"; }
 		
 		float getStartTime() { return startTime; }
@@ -96,8 +135,9 @@ namespace GX
 		float getDamping() { return damping; }
 		void setDamping(float value) { damping = value; }
 
-		virtual void onCreateParticle(Particle& particle);
-		virtual void update(Particle& particle, float deltaTime);
+		virtual void onCreateParticle(ParticlePool& pool, size_t index);
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime);
+		virtual void onCollideParticle(ParticlePool& pool, size_t index, const glm::vec3& normal);
 	};
 
 	class ParticleColorModifier : public ParticleModifier
@@ -115,8 +155,8 @@ namespace GX
 
 		std::vector<std::pair<float, Color>>& getColors() { return colors; }
 
-		virtual void onCreateParticle(Particle& particle);
-		virtual void update(Particle& particle, float deltaTime);
+		virtual void onCreateParticle(ParticlePool& pool, size_t index);
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime);
 	};
 
 	class ParticleSizeModifier : public ParticleModifier
@@ -134,8 +174,8 @@ namespace GX
 
 		std::vector<std::pair<float, float>>& getSizes() { return sizes; }
 
-		virtual void onCreateParticle(Particle& particle);
-		virtual void update(Particle& particle, float deltaTime);
+		virtual void onCreateParticle(ParticlePool& pool, size_t index);
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime);
 	};
 
 	class ParticleDirectionModifier : public ParticleModifier
@@ -149,8 +189,6 @@ namespace GX
 			RandomTimed
 		};
 
-		float timer = 0.0f;
-
 	private:
 		glm::vec3 randomDirectionMin = glm::vec3(-1.0f);
 		glm::vec3 randomDirectionMax = glm::vec3(1.0f);
@@ -181,8 +219,8 @@ namespace GX
 		glm::vec3 getConstantDirection() { return constantDirection; }
 		void setConstantDirection(glm::vec3 value) { constantDirection = value; }
 
-		virtual void onCreateParticle(Particle& particle);
-		virtual void update(Particle& particle, float deltaTime);
+		virtual void onCreateParticle(ParticlePool& pool, size_t index);
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime);
 	};
 
 	class ParticleRotationModifier : public ParticleModifier
@@ -197,8 +235,6 @@ namespace GX
 			FromDirection
 		};
 
-		float timer = 0.0f;
-
 	private:
 		glm::vec3 randomRotationMin = glm::vec3(-180.0f);
 		glm::vec3 randomRotationMax = glm::vec3(180.0f);
@@ -233,8 +269,8 @@ namespace GX
 		glm::vec3 getOffset() { return offset; }
 		void setOffset(glm::vec3 value) { offset = value; }
 
-		virtual void onCreateParticle(Particle& particle);
-		virtual void update(Particle& particle, float deltaTime);
+		virtual void onCreateParticle(ParticlePool& pool, size_t index);
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime);
 	};
 
 	class ParticleSpeedModifier : public ParticleModifier
@@ -248,8 +284,6 @@ namespace GX
 			RandomTimed
 		};
 
-		float timer = 0.0f;
-
 	private:
 		float randomSpeedMin = 0.1f;
 		float randomSpeedMax = 0.5f;
@@ -280,13 +314,14 @@ namespace GX
 		float getConstantSpeed() { return constantSpeed; }
 		void setConstantSpeed(float value) { constantSpeed = value; }
 
-		virtual void onCreateParticle(Particle& particle);
-		virtual void update(Particle& particle, float deltaTime);
+		virtual void onCreateParticle(ParticlePool& pool, size_t index);
+		virtual void update(ParticlePool& pool, size_t count, float deltaTime);
 	};
 
 	class ParticleEmitter: public Renderable
 	{
 		friend class ParticleSystem;
+		friend class ParticleManager;
 		friend class ParticleColorModifier;
 
 	public:
@@ -315,6 +350,20 @@ namespace GX
 			FPS
 		};
 
+		//RigidBody adds a physics body per particle to the world.
+		//Raycast traces particle motion against static colliders and creates no bodies
+		enum class CollisionMode
+		{
+			RigidBody,
+			Raycast
+		};
+
+		enum class CollisionResponse
+		{
+			Bounce,
+			Kill
+		};
+
 	private:
 		struct VertexBuffer
 		{
@@ -335,9 +384,12 @@ namespace GX
 		Material* material = nullptr;
 		ParticleSystem* parent = nullptr;
 
-		std::vector<Particle> particles;
+		ParticlePool particles;
 		std::vector<ParticleModifier*> modifiers;
 
+		//Own generator, because emitters are updated on job threads and rand() state is per thread on MSVC
+		std::mt19937 random;
+
 		//Runtime vars
 		float playbackTime = 0.0f;
 		float emissionTime = 0.0f;
@@ -364,6 +416,8 @@ namespace GX
 		bool enablePhysics = false;
 		float friction = 0.85f;
 		float bounciness = 0.25f;
+		CollisionMode collisionMode = CollisionMode::RigidBody;
+		CollisionResponse collisionResponse = CollisionResponse::Bounce;
 		bool animated = false;
 		glm::vec2 animationGridSize = glm::vec2(1, 1);
 		AnimationTimeMode animationTimeMode = AnimationTimeMode::Lifetime;
@@ -375,6 +429,12 @@ namespace GX
 		void recreate();
 
 		void destroyParticles();
+		void emit();
+		void halt();
+		void collide();
+
+		//Such emitters add bodies to the physics world or cast rays against it, so they are not updated on job threads
+		bool usesPhysicsWorld();
 
 	public:
 		ParticleEmitter(ParticleSystem* ps);
@@ -395,8 +455,13 @@ namespace GX
 
 		ParticleSystem* getParent() { return parent; }
 
+		//Not thread safe. Called only from this emitter's update
+		float randomFloat(float min, float max);
+		glm::vec3 randomVector(const glm::vec3& min, const glm::vec3& max);
+
 		bool getIsPlaying() { return isPlaying; }
 		float getPlaybackTime() { return playbackTime; }
+		size_t getParticleCount() { return particles.getCount(); }
 
 		template<typename T>
 		T addModifier() {}
@@ -464,6 +529,14 @@ namespace GX
 		bool getEnablePhysics() { return enablePhysics; }
 		void setEnablePhysics(bool value) { enablePhysics = value; }
 
+		CollisionMode getCollisionMode() { return collisionMode; }
+		void setCollisionMode(CollisionMode value) { collisionMode = value; }
+
+		CollisionResponse getCollisionResponse() { return collisionResponse; }
+		void setCollisionResponse(CollisionResponse value) { collisionResponse = value; }
+
+		bool usesRigidBodies() { return enablePhysics && collisionMode == CollisionMode::RigidBody; }
+
 		float getFriction() { return friction; }
 		void setFriction(float value) { friction = value; }
 		
@@ -506,7 +579,6 @@ namespace GX
 
 		static std::string COMPONENT_TYPE;
 		virtual std::string getComponentType() { return COMPONENT_TYPE; }
-		virtual void onUpdate(float deltaTime);
 		virtual void onSceneLoaded();
 		virtual Component* onClone();
 		virtual bool isEqualsTo(Component* other);
@@ -23,6 +23,8 @@ namespace GX
 
         if (it == renderers.end())
             Renderer::getSingleton()->renderables.push_back(this);
+
+        Renderer::getSingleton()->cullingDataOutdated = true;
     }
 
     void Renderable::detach()
@@ -32,5 +34,7 @@ namespace GX
 
         if (it != renderers.end())
             renderers.erase(it);
+
+        Renderer::getSingleton()->cullingDataOutdated = true;
     }
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ namespace GX
 {
     class Transform;
     class Camera;
+    class Material;
 
     class Renderable
     {
@@ -35,6 +36,7 @@ namespace GX
         virtual bool isStatic() { return false; }
         virtual bool isDecal() { return false; }
         virtual bool getSkipRendering() { return false; }
+        virtual Material* getSortMaterial() { return nullptr; } //Used to group draws by shader and material
 
         int getRenderQueue() { return renderQueue; }
         void setRenderQueue(int value) { renderQueue = value; }
@@ -157,7 +157,7 @@ namespace GX
 
 		if (!isStatic && mass > 0 && mainShape->getNumChildShapes() > 0)
 		{
-			MeshRenderer* rend = (MeshRenderer*)getGameObject()->getComponent(MeshRenderer::COMPONENT_TYPE);
+			MeshRenderer* rend = getGameObject()->getComponent<MeshRenderer>();
 			if (rend != nullptr)
 			{
 				glm::vec3 center = rend->getBounds(false).getCenter();
@@ -230,7 +230,7 @@ namespace GX
 
 		for (auto& obj : objects)
 		{
-			Vehicle* veh = (Vehicle*)obj->getComponent(Vehicle::COMPONENT_TYPE);
+			Vehicle* veh = obj->getComponent<Vehicle>();
 			if (veh == nullptr)
 				continue;
 
@@ -12,6 +12,7 @@
 #include "../Renderer/Renderer.h"
 #include "../Renderer/VertexLayouts.h"
 #include "../Renderer/Frustum.h"
+#include "../Renderer/TextureStreamer.h"
 #include "../Assets/Material.h"
 #include "../Assets/Shader.h"
 #include "../Assets/Texture.h"
@@ -29,6 +30,8 @@
 
 #include "../Classes/ZipHelper.h"
 
+#include <random>
+
 namespace GX
 {
     std::string Terrain::COMPONENT_TYPE = "Terrain";
@@ -40,6 +43,9 @@ namespace GX
     bgfx::UniformHandle Terrain::textureCountHandle = { bgfx::kInvalidHandle };
     bgfx::UniformHandle Terrain::albedoTextureHandle = { bgfx::kInvalidHandle };
 
+    bgfx::IndexBufferHandle Terrain::chunkIndexBuffers[TERRAIN_CHUNK_LODS][16];
+    bool Terrain::chunkIndexBuffersCreated = false;
+
     //----------------------TREES DATA----------------------//
 
     TerrainTreeData::~TerrainTreeData()
@@ -129,7 +135,56 @@ namespace GX
         if (bgfx::isValid(impostorTexture))
             bgfx::destroy(impostorTexture);
 
+        if (bgfx::isValid(impostorVbh))
+            bgfx::destroy(impostorVbh);
+
         impostorTexture = { bgfx::kInvalidHandle };
+        impostorVbh = { bgfx::kInvalidHandle };
+    }
+
+    void TerrainTreeData::addToCell(TreeMesh* mesh)
+    {
+        glm::ivec2 index = glm::ivec2(glm::floor(glm::vec2(mesh->position.x, mesh->position.z) / TERRAIN_VEGETATION_CELL_SIZE));
+
+        auto it = std::find_if(cells.begin(), cells.end(), [=](Cell* c) -> bool { return c->index == index; });
+
+        Cell* cell = nullptr;
+        if (it != cells.end())
+            cell = *it;
+        else
+        {
+            cell = new Cell(this, index);
+            cells.push_back(cell);
+        }
+
+        mesh->cell = cell;
+        cell->meshes.push_back(mesh);
+        cell->setDirty();
+    }
+
+    void TerrainTreeData::removeFromCell(TreeMesh* mesh)
+    {
+        Cell* cell = mesh->cell;
+        if (cell == nullptr)
+            return;
+
+        mesh->cell = nullptr;
+
+        auto it = std::find(cell->meshes.begin(), cell->meshes.end(), mesh);
+        if (it != cell->meshes.end())
+            cell->meshes.erase(it);
+
+        if (cell->meshes.size() > 0)
+        {
+            cell->setDirty();
+            return;
+        }
+
+        auto ct = std::find(cells.begin(), cells.end(), cell);
+        if (ct != cells.end())
+            cells.erase(ct);
+
+        delete cell;
     }
 
     bool TerrainTreeData::addTree(glm::vec2 pos, float density)
@@ -170,6 +225,7 @@ namespace GX
             mesh->scale = Mathf::RandomFloat(minScale, maxScale);
 
             meshes.push_back(mesh);
+            addToCell(mesh);
 
             mesh->updateTransform();
         }
@@ -185,6 +241,7 @@ namespace GX
         mesh->scale = scale;
 
         meshes.push_back(mesh);
+        addToCell(mesh);
 
         mesh->updateTransform();
     }
@@ -204,6 +261,8 @@ namespace GX
 
         if (bb != meshes.end())
         {
+            removeFromCell(*bb);
+
             delete* bb;
             meshes.erase(bb);
 
@@ -219,7 +278,11 @@ namespace GX
         for (auto it = meshes.begin(); it != meshes.end(); ++it)
             delete* it;
 
+        for (auto it = cells.begin(); it != cells.end(); ++it)
+            delete* it;
+
         meshes.clear();
+        cells.clear();
     }
 
     void TerrainTreeData::updateImpostorTexture()
@@ -328,6 +391,27 @@ namespace GX
         bgfx::destroy(frameBufferHandle);
         bgfx::destroy(depthTextureHandle);
         Renderer::getSingleton()->frame();
+
+        //Camera facing quad for instanced impostors
+        Cell::PosTexCoord0Vertex quad[6];
+
+        float szX = aabSize.y * 0.5f;
+        float szY = aabSize.y;
+
+        quad[0].pos = glm::vec3(-szX, 0, 0);
+        quad[0].uv = glm::vec2(0, 0);
+        quad[1].pos = glm::vec3(-szX, szY, 0);
+        quad[1].uv = glm::vec2(0, 1);
+        quad[2].pos = glm::vec3(szX, szY, 0);
+        quad[2].uv = glm::vec2(1, 1);
+        quad[3].pos = glm::vec3(szX, szY, 0);
+        quad[3].uv = glm::vec2(1, 1);
+        quad[4].pos = glm::vec3(szX, 0, 0);
+        quad[4].uv = glm::vec2(1, 0);
+        quad[5].pos = glm::vec3(-szX, 0, 0);
+        quad[5].uv = glm::vec2(0, 0);
+
+        impostorVbh = bgfx::createVertexBuffer(bgfx::copy(quad, sizeof(quad)), VertexLayouts::primitiveVertexLayout);
     }
 
     glm::mat4x4 TerrainTreeData::TreeMesh::getTransform()
@@ -353,9 +437,12 @@ namespace GX
         //Update AAB
         cachedAAB = parent->getBounds();
         cachedAAB.transform(cachedTransform);
+
+        if (cell != nullptr)
+            cell->setDirty();
     }
 
-    TerrainTreeData::TreeMesh::TreeMesh(TerrainTreeData* _parent) : Renderable()
+    TerrainTreeData::TreeMesh::TreeMesh(TerrainTreeData* _parent)
     {
         parent = _parent;
     }
@@ -377,16 +464,65 @@ namespace GX
         }
     }
 
-    bool TerrainTreeData::TreeMesh::getCastShadows()
+    TerrainTreeData::Cell::Cell(TerrainTreeData* _parent, glm::ivec2 _index) : Renderable()
+    {
+        parent = _parent;
+        index = _index;
+    }
+
+    TerrainTreeData::Cell::~Cell()
+    {
+        if (bgfx::isValid(instanceBuffer))
+            bgfx::destroy(instanceBuffer);
+
+        instanceBuffer = { bgfx::kInvalidHandle };
+    }
+
+    AxisAlignedBox TerrainTreeData::Cell::getBounds(bool world)
+    {
+        //Tree bounds are already in world space
+        if (boundsDirty)
+        {
+            bounds = AxisAlignedBox::BOX_NULL;
+            for (auto& m : meshes)
+                bounds.merge(m->cachedAAB);
+
+            boundsDirty = false;
+        }
+
+        return bounds;
+    }
+
+    bool TerrainTreeData::Cell::getCastShadows()
     {
         return parent->terrain->getTreesCastShadows();
     }
 
-    bool TerrainTreeData::TreeMesh::checkCullingMask(LayerMask& mask)
+    bool TerrainTreeData::Cell::checkCullingMask(LayerMask& mask)
     {
         return parent->terrain->checkCullingMask(mask);
     }
 
+    void TerrainTreeData::Cell::updateInstances()
+    {
+        if (bgfx::isValid(instanceBuffer))
+            bgfx::destroy(instanceBuffer);
+
+        instanceBuffer = { bgfx::kInvalidHandle };
+        instancesDirty = false;
+
+        if (meshes.size() == 0)
+            return;
+
+        const bgfx::Memory* mem = bgfx::alloc(sizeof(glm::mat4x4) * (uint32_t)meshes.size());
+        glm::mat4x4* data = (glm::mat4x4*)mem->data;
+
+        for (size_t i = 0; i < meshes.size(); ++i)
+            data[i] = meshes[i]->getTransform();
+
+        instanceBuffer = bgfx::createVertexBuffer(mem, VertexLayouts::instanceMatrixLayout);
+    }
+
     //----------------------DETAIL MESHES DATA----------------------//
 
     TerrainDetailMeshData::Batch::Batch(TerrainDetailMeshData* _parent) : Renderable()
@@ -507,6 +643,10 @@ namespace GX
 
     void TerrainDetailMeshData::Batch::update()
     {
+        //Random order lets a prefix of the index buffer stand for a thinned out batch
+        std::mt19937 rng(1337);
+        std::shuffle(meshes.begin(), meshes.end(), rng);
+
         destroy();
         init();
     }
@@ -671,15 +811,6 @@ namespace GX
             float rotation = Mathf::RandomFloat(0, 180.0f);
             float scale = Mathf::RandomFloat(minScale, maxScale);
 
-            Batch* batch = nullptr;
-            if (batches.size() > 0)
-                batch = batches[batches.size() - 1];
-            if (batch == nullptr || batch->meshes.size() >= batchSize)
-            {
-                batch = new Batch(this);
-                batches.push_back(batch);
-            }
-
             bool found = false;
             for (auto it = batches.begin(); it != batches.end(); ++it)
             {
@@ -705,6 +836,7 @@ namespace GX
                 mesh.rotation = rotation;
                 mesh.scale = scale;
 
+                Batch* batch = getBatch(position);
                 batch->meshes.push_back(mesh);
 
                 auto sb = std::find(updBatches.begin(), updBatches.end(), batch);
@@ -722,19 +854,30 @@ namespace GX
         return ret;
     }
 
-    void TerrainDetailMeshData::addMesh(glm::vec3 position, float rotation, float scale)
+    TerrainDetailMeshData::Batch* TerrainDetailMeshData::getBatch(glm::vec3 position)
     {
-        Transform* terrainTrans = terrain->getGameObject()->getTransform();
+        //Batches are kept per vegetation cell so they can be culled and thinned out by distance
+        glm::ivec2 cell = glm::ivec2(glm::floor(glm::vec2(position.x, position.z) / TERRAIN_VEGETATION_CELL_SIZE));
 
-        Batch* batch = nullptr;
-        if (batches.size() > 0)
-            batch = batches[batches.size() - 1];
-        if (batch == nullptr || batch->meshes.size() >= batchSize)
+        for (auto it = batches.begin(); it != batches.end(); ++it)
         {
-            batch = new Batch(this);
-            batches.push_back(batch);
+            if ((*it)->cell == cell && (*it)->meshes.size() < batchSize)
+                return *it;
         }
 
+        Batch* batch = new Batch(this);
+        batch->cell = cell;
+        batches.push_back(batch);
+
+        return batch;
+    }
+
+    void TerrainDetailMeshData::addMesh(glm::vec3 position, float rotation, float scale)
+    {
+        Transform* terrainTrans = terrain->getGameObject()->getTransform();
+
+        Batch* batch = getBatch(position);
+
         DetailMesh mesh;
         mesh.position = position;
         mesh.rotation = rotation;
@@ -1123,6 +1266,10 @@ namespace GX
 
     void TerrainGrassData::Batch::update()
     {
+        //Random order lets a prefix of the index buffer stand for a thinned out batch
+        std::mt19937 rng(1337);
+        std::shuffle(meshes.begin(), meshes.end(), rng);
+
         destroy();
         init();
     }
@@ -1160,15 +1307,6 @@ namespace GX
             if (_wpos.y < -terrain->getWorldSize() / 2.0f) continue;
             if (_wpos.x > terrain->getWorldSize() / 2.0f) continue;
             if (_wpos.y > (terrain->getWorldSize() - offset) / 2.0f) continue;
-            
-            Batch* batch = nullptr;
-            if (batches.size() > 0)
-                batch = batches[batches.size() - 1];
-            if (batch == nullptr || batch->meshes.size() >= batchSize)
-            {
-                batch = new Batch(this);
-                batches.push_back(batch);
-            }
 
             bool found = false;
             for (auto it = batches.begin(); it != batches.end(); ++it)
@@ -1196,6 +1334,7 @@ namespace GX
                 mesh.width = Mathf::RandomFloat(minSize.x, maxSize.x);
                 mesh.height = Mathf::RandomFloat(minSize.y, maxSize.y);
 
+                Batch* batch = getBatch(mesh.position);
                 batch->meshes.push_back(mesh);
 
                 auto sb = std::find(updBatches.begin(), updBatches.end(), batch);
@@ -1213,19 +1352,30 @@ namespace GX
         return ret;
     }
 
-    void TerrainGrassData::addGrass(glm::vec3 position, float rotation, float width, float height)
+    TerrainGrassData::Batch* TerrainGrassData::getBatch(glm::vec3 position)
     {
-        Transform* terrainTrans = terrain->getGameObject()->getTransform();
+        //Batches are kept per vegetation cell so they can be culled and thinned out by distance
+        glm::ivec2 cell = glm::ivec2(glm::floor(glm::vec2(position.x, position.z) / TERRAIN_VEGETATION_CELL_SIZE));
 
-        Batch* batch = nullptr;
-        if (batches.size() > 0)
-            batch = batches[batches.size() - 1];
-        if (batch == nullptr || batch->meshes.size() >= batchSize)
+        for (auto it = batches.begin(); it != batches.end(); ++it)
         {
-            batch = new Batch(this);
-            batches.push_back(batch);
+            if ((*it)->cell == cell && (*it)->meshes.size() < batchSize)
+                return *it;
         }
 
+        Batch* batch = new Batch(this);
+        batch->cell = cell;
+        batches.push_back(batch);
+
+        return batch;
+    }
+
+    void TerrainGrassData::addGrass(glm::vec3 position, float rotation, float width, float height)
+    {
+        Transform* terrainTrans = terrain->getGameObject()->getTransform();
+
+        Batch* batch = getBatch(position);
+
         GrassMesh mesh;
         mesh.position = position;
         mesh.rotation = rotation;
@@ -1409,6 +1559,9 @@ namespace GX
         textureCountHandle = bgfx::createUniform("u_textureCount", bgfx::UniformType::Vec4, 1);
         textureSizesHandle = bgfx::createUniform("u_textureSizes", bgfx::UniformType::Vec4, MAX_TERRAIN_TEXTURES);
         albedoTextureHandle = bgfx::createUniform("u_albedoMap", bgfx::UniformType::Sampler, 1);
+
+        if (!chunkIndexBuffersCreated)
+            createChunkIndexBuffers();
     }
 
     Terrain::~Terrain()
@@ -1421,6 +1574,63 @@ namespace GX
         
     }
 
+    void Terrain::createChunkIndexBuffers()
+    {
+        const int rowSize = TERRAIN_CHUNK_SIZE + 1;
+
+        for (int lod = 0; lod < TERRAIN_CHUNK_LODS; ++lod)
+        {
+            int step = 1 << lod;
+
+            for (int edges = 0; edges < 16; ++edges)
+            {
+                //Odd vertices on the edges shared with a coarser chunk are moved onto the even ones,
+                //so the edge matches the neighbour and no cracks appear
+                auto vertex = [=](int vx, int vy) -> uint16_t
+                {
+                    if ((edges & CHUNK_EDGE_LEFT) && vx == 0 && (vy / step) % 2 == 1)
+                        vy -= step;
+                    if ((edges & CHUNK_EDGE_RIGHT) && vx == TERRAIN_CHUNK_SIZE && (vy / step) % 2 == 1)
+                        vy -= step;
+                    if ((edges & CHUNK_EDGE_BOTTOM) && vy == 0 && (vx / step) % 2 == 1)
+                        vx -= step;
+                    if ((edges & CHUNK_EDGE_TOP) && vy == TERRAIN_CHUNK_SIZE && (vx / step) % 2 == 1)
+                        vx -= step;
+
+                    return (uint16_t)(vy * rowSize + vx);
+                };
+
+                std::vector<uint16_t> chunkIndices;
+                chunkIndices.reserve((TERRAIN_CHUNK_SIZE / step) * (TERRAIN_CHUNK_SIZE / step) * 6);
+
+                auto addTriangle = [&chunkIndices](uint16_t a, uint16_t b, uint16_t c)
+                {
+                    if (a == b || b == c || a == c)
+                        return;
+
+                    chunkIndices.push_back(a);
+                    chunkIndices.push_back(b);
+                    chunkIndices.push_back(c);
+                };
+
+                //Same winding as the full resolution mesh
+                for (int y = 0; y < TERRAIN_CHUNK_SIZE; y += step)
+                {
+                    for (int x = 0; x < TERRAIN_CHUNK_SIZE; x += step)
+                    {
+                        addTriangle(vertex(x + step, y), vertex(x, y + step), vertex(x, y));
+                        addTriangle(vertex(x + step, y + step), vertex(x, y + step), vertex(x + step, y));
+                    }
+                }
+
+                const bgfx::Memory* mem = bgfx::copy(chunkIndices.data(), sizeof(uint16_t) * chunkIndices.size());
+                chunkIndexBuffers[lod][edges] = bgfx::createIndexBuffer(mem);
+            }
+        }
+
+        chunkIndexBuffersCreated = true;
+    }
+
     void Terrain::create()
     {
         uint32_t num = size * size;
@@ -1433,6 +1643,15 @@ namespace GX
         for (uint32_t i = 0; i < num; ++i)
             vertices[i].normal = glm::vec3(0.0f);
 
+        chunksPerSide = std::max((size - 2) / TERRAIN_CHUNK_SIZE + 1, 1);
+        chunkVertices = new VertexBuffer[chunksPerSide * chunksPerSide * (TERRAIN_CHUNK_SIZE + 1) * (TERRAIN_CHUNK_SIZE + 1)];
+
+        for (int y = 0; y < chunksPerSide; ++y)
+        {
+            for (int x = 0; x < chunksPerSide; ++x)
+                chunks.push_back(new Chunk(this, x, y));
+        }
+
         int splatCount = 0;
         float t = MAX_TERRAIN_TEXTURES % 4;
         if (t > 0)
@@ -1458,15 +1677,25 @@ namespace GX
 
     void Terrain::destroy()
     {
-        if (bgfx::isValid(ibh))
-            bgfx::destroy(ibh);
-
         if (bgfx::isValid(vbh))
             bgfx::destroy(vbh);
 
-        ibh = { bgfx::kInvalidHandle };
         vbh = { bgfx::kInvalidHandle };
 
+        for (auto it = chunks.begin(); it != chunks.end(); ++it)
+            delete* it;
+
+        chunks.clear();
+        chunksPerSide = 0;
+
+        meshDirtyRect.reset();
+        positionsDirtyRect.reset();
+
+        if (chunkVertices != nullptr)
+            delete[] chunkVertices;
+
+        chunkVertices = nullptr;
+
         if (heightMap != nullptr)
             delete[] heightMap;
         if (vertices != nullptr)
@@ -1539,12 +1768,7 @@ namespace GX
         deserialize(data, getFilePath());
 
         for (auto& tree : treeList)
-        {
-            for (auto& mesh : tree->meshes)
-                delete mesh;
-
-            tree->meshes.clear();
-        }
+            tree->destroy();
 
         for (auto& grass : grassList)
         {
@@ -1576,12 +1800,7 @@ namespace GX
         deserialize(data, getFilePath());
 
         for (auto& tree : treeList)
-        {
-            for (auto& mesh : tree->meshes)
-                delete mesh;
-
-            tree->meshes.clear();
-        }
+            tree->destroy();
 
         for (auto& grass : grassList)
         {
@@ -1696,7 +1915,27 @@ namespace GX
         uint32_t heightMapPos0 = (y * (int32_t)size) + x;
         heightMapPos0 = glm::clamp((float)heightMapPos0, 0.0f, ((float)size * (float)size) - 1.0f);
         heightMap[heightMapPos0] = height;
+        setIsDirty(x, y, x, y);
+    }
+
+    void Terrain::setIsDirty()
+    {
         isDirty = true;
+        positionsDirtyRect.merge(0, 0, size - 1, size - 1);
+    }
+
+    void Terrain::setIsDirty(int x0, int y0, int x1, int y1)
+    {
+        x0 = std::max(x0, 0);
+        y0 = std::max(y0, 0);
+        x1 = std::min(x1, size - 1);
+        y1 = std::min(y1, size - 1);
+
+        if (x1 < x0 || y1 < y0)
+            return;
+
+        meshDirtyRect.merge(x0, y0, x1, y1);
+        positionsDirtyRect.merge(x0, y0, x1, y1);
     }
 
     float Terrain::getHeightAtWorldPos(glm::vec3 worldPos)
@@ -1764,6 +2003,19 @@ namespace GX
         return getHeight((uint32_t)pos.x, (uint32_t)pos.z);
     }
 
+    float Terrain::getDensityFalloff(float distance, float drawDistance)
+    {
+        float start = drawDistance * 0.5f;
+
+        if (distance <= start)
+            return 1.0f;
+
+        if (distance >= drawDistance)
+            return 0.0f;
+
+        return 1.0f - (distance - start) / (drawDistance - start);
+    }
+
     void Terrain::setHeightAtWorldPos(glm::vec3 worldPos, float height)
     {
         glm::vec3 tp = transform->getPosition();
@@ -1780,139 +2032,274 @@ namespace GX
         prevTransform = glm::mat4x4(FLT_MAX);
         bounds = AxisAlignedBox::BOX_NULL;
 
+        vertexCount = size * size;
+        updateVertexPositions(0, 0, size - 1, size - 1);
+
+        indexCount = 0;
+        for (uint32_t y = 0; y < (size - 1); y++)
+        {
+            uint32_t y_offset = (y * size);
+            for (uint32_t x = 0; x < (size - 1); x++)
+            {
+                indices[indexCount + 0] = y_offset + x + 1;
+                indices[indexCount + 1] = y_offset + x + size;
+                indices[indexCount + 2] = y_offset + x;
+                indices[indexCount + 3] = y_offset + x + size + 1;
+                indices[indexCount + 4] = y_offset + x + size;
+                indices[indexCount + 5] = y_offset + x + 1;
+
+                indexCount += 6;
+            }
+        }
+
+        updateNormals(0, 0, size - 1, size - 1);
+    }
+
+    void Terrain::updateVertexPositions(int x0, int y0, int x1, int y1)
+    {
         float scale = worldSize / size;
 
-        vertexCount = 0;
-        for (uint32_t y = 0; y < size; y++)
+        for (int y = y0; y <= y1; y++)
         {
-            for (uint32_t x = 0; x < size; x++)
+            for (int x = x0; x <= x1; x++)
             {
                 int h = (y * size) + x;
                 glm::vec3 position = Mathf::toQuaternion(180.0f, 0, 0) * glm::vec3(((float)x - size / 2) * scale, -heightMap[h], ((float)y - size / 2) * scale);
                 glm::vec2 texcoord = glm::vec2((x + 0.5f) / size, (y + 0.5f) / size);
 
-                VertexBuffer* vert = &vertices[vertexCount];
+                VertexBuffer* vert = &vertices[h];
                 vert->position = position;
                 vert->texcoord0 = texcoord;
 
-                vertexCount++;
-
                 bounds.merge(position);
             }
         }
+    }
 
-        indexCount = 0;
-        for (uint32_t y = 0; y < (size - 1); y++)
+    void Terrain::updateNormals(int x0, int y0, int x1, int y1)
+    {
+        //A vertex takes the normal of the last triangle that uses it, so only the quads where
+        //the vertices of the area are the last ones are processed, in the same order as the indices
+        int qx0 = std::min(x0, size - 2);
+        int qy0 = std::min(y0, size - 2);
+        int qx1 = std::min(x1, size - 2);
+        int qy1 = std::min(y1, size - 2);
+
+        auto inside = [=](uint32_t id) -> bool
         {
-            uint32_t y_offset = (y * size);
-            for (uint32_t x = 0; x < (size - 1); x++)
+            int x = id % size;
+            int y = id / size;
+
+            return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+        };
+
+        for (int y = qy0; y <= qy1; y++)
+        {
+            for (int x = qx0; x <= qx1; x++)
             {
-                indices[indexCount + 0] = y_offset + x + 1;
-                indices[indexCount + 1] = y_offset + x + size;
-                indices[indexCount + 2] = y_offset + x;
-                indices[indexCount + 3] = y_offset + x + size + 1;
-                indices[indexCount + 4] = y_offset + x + size;
-                indices[indexCount + 5] = y_offset + x + 1;
+                uint32_t i = ((uint32_t)y * (size - 1) + (uint32_t)x) * 6;
 
-                indexCount += 6;
+                for (uint32_t t = i; t < i + 6; t += 3)
+                {
+                    //Normals
+                    uint32_t id0 = indices[t + 0];
+                    uint32_t id1 = indices[t + 1];
+                    uint32_t id2 = indices[t + 2];
+
+                    glm::vec3 v1 = vertices[id0].position;
+                    glm::vec3 v2 = vertices[id1].position;
+                    glm::vec3 v3 = vertices[id2].position;
+
+                    glm::vec3 normalA = glm::normalize(glm::cross(v2 - v1, v3 - v1));
+
+                    //Tangent space
+                    glm::vec3 deltaPos = glm::vec3(0);
+                    if (v1 == v2)
+                        deltaPos = v3 - v1;
+                    else
+                        deltaPos = v2 - v1;
+
+                    glm::vec2 uv0 = vertices[id0].texcoord0;
+                    glm::vec2 uv1 = vertices[id1].texcoord0;
+                    glm::vec2 uv2 = vertices[id2].texcoord0;
+
+                    glm::vec2 deltaUV1 = uv1 - uv0;
+                    glm::vec2 deltaUV2 = uv2 - uv0;
+
+                    glm::vec3 tan = glm::vec3(0); // tangent
+                    glm::vec3 bin = glm::vec3(0); // binormal
+
+                    // avoid divion with 0
+                    if (deltaUV1.s != 0)
+                        tan = deltaPos / deltaUV1.s;
+                    else
+                        tan = deltaPos / 1.0f;
+
+                    tan = glm::normalize(tan - glm::dot(normalA, tan) * normalA);
+                    bin = glm::normalize(glm::cross(tan, normalA));
+
+                    uint32_t ids[3] = { id0, id1, id2 };
+                    for (auto id : ids)
+                    {
+                        if (!inside(id))
+                            continue;
+
+                        vertices[id].normal = normalA;
+                        vertices[id].tangent = tan;
+                        vertices[id].bitangent = bin;
+                    }
+                }
             }
         }
+    }
 
-        //Calculate normals + tangents + bitangents
-        for (uint32_t i = 0; i < indexCount; i += 3)
+    void Terrain::updateTerrainRegion()
+    {
+        //Normals depend on the neighbour vertices
+        int x0 = std::max(meshDirtyRect.minX - 1, 0);
+        int y0 = std::max(meshDirtyRect.minY - 1, 0);
+        int x1 = std::min(meshDirtyRect.maxX + 1, size - 1);
+        int y1 = std::min(meshDirtyRect.maxY + 1, size - 1);
+
+        prevTransform = glm::mat4x4(FLT_MAX);
+
+        updateVertexPositions(meshDirtyRect.minX, meshDirtyRect.minY, meshDirtyRect.maxX, meshDirtyRect.maxY);
+        updateNormals(x0, y0, x1, y1);
+
+        const int rowSize = TERRAIN_CHUNK_SIZE + 1;
+
+        for (auto& chunk : chunks)
         {
-            //Normals
-            uint32_t id0 = indices[i + 0];
-            uint32_t id1 = indices[i + 1];
-            uint32_t id2 = indices[i + 2];
+            int cx = chunk->x * TERRAIN_CHUNK_SIZE;
+            int cy = chunk->y * TERRAIN_CHUNK_SIZE;
 
-            glm::vec3 v1 = vertices[id0].position;
-            glm::vec3 v2 = vertices[id1].position;
-            glm::vec3 v3 = vertices[id2].position;
+            if (cx > x1 || cx + TERRAIN_CHUNK_SIZE < x0 || cy > y1 || cy + TERRAIN_CHUNK_SIZE < y0)
+                continue;
 
-            glm::vec3 normalA = glm::normalize(glm::cross(v2 - v1, v3 - v1));
+            //Padding rows of the last chunks repeat the last row of the heightmap
+            int firstRow = std::max(y0 - cy, 0);
+            int lastRow = y1 == size - 1 ? TERRAIN_CHUNK_SIZE : std::min(y1 - cy, TERRAIN_CHUNK_SIZE);
 
-            vertices[id0].normal = normalA;
-            vertices[id1].normal = normalA;
-            vertices[id2].normal = normalA;
+            updateChunkRows(chunk, firstRow, lastRow);
 
-            //Tangent space
-            glm::vec3 deltaPos = glm::vec3(0);
-            if (v1 == v2)
-                deltaPos = v3 - v1;
-            else
-                deltaPos = v2 - v1;
+            uint32_t first = chunk->firstVertex + firstRow * rowSize;
+            uint32_t count = (lastRow - firstRow + 1) * rowSize;
 
-            glm::vec2 uv0 = vertices[id0].texcoord0;
-            glm::vec2 uv1 = vertices[id1].texcoord0;
-            glm::vec2 uv2 = vertices[id2].texcoord0;
+            const bgfx::Memory* mem = bgfx::makeRef(&chunkVertices[first], sizeof(VertexBuffer) * count, releaseData);
+            bgfx::update(vbh, first, mem);
+        }
 
-            glm::vec2 deltaUV1 = uv1 - uv0;
-            glm::vec2 deltaUV2 = uv2 - uv0;
+        //Heights may have been lowered, so the bounds can shrink
+        bounds = AxisAlignedBox::BOX_NULL;
+        for (auto& chunk : chunks)
+            bounds.merge(chunk->bounds);
+    }
 
-            glm::vec3 tan = glm::vec3(0); // tangent
-            glm::vec3 bin = glm::vec3(0); // binormal
+    void Terrain::updateChunks()
+    {
+        for (auto& chunk : chunks)
+            updateChunkRows(chunk, 0, TERRAIN_CHUNK_SIZE);
+    }
 
-            // avoid divion with 0
-            if (deltaUV1.s != 0)
-                tan = deltaPos / deltaUV1.s;
-            else
-                tan = deltaPos / 1.0f;
+    void Terrain::updateChunkRows(Chunk* chunk, int firstRow, int lastRow)
+    {
+        const int rowSize = TERRAIN_CHUNK_SIZE + 1;
 
-            tan = glm::normalize(tan - glm::dot(normalA, tan) * normalA);
-            bin = glm::normalize(glm::cross(tan, normalA));
+        chunk->prevTransform = glm::mat4x4(FLT_MAX);
 
-            vertices[id0].tangent = tan;
-            vertices[id0].bitangent = bin;
-            vertices[id1].tangent = tan;
-            vertices[id1].bitangent = bin;
-            vertices[id2].tangent = tan;
-            vertices[id2].bitangent = bin;
+        //Chunks on the far edges are padded with the last row and column, which gives degenerate triangles
+        for (int vy = firstRow; vy <= lastRow; ++vy)
+        {
+            int gy = std::min(chunk->y * TERRAIN_CHUNK_SIZE + vy, size - 1);
+
+            for (int vx = 0; vx < rowSize; ++vx)
+            {
+                int gx = std::min(chunk->x * TERRAIN_CHUNK_SIZE + vx, size - 1);
+
+                chunkVertices[chunk->firstVertex + vy * rowSize + vx] = vertices[gy * size + gx];
+            }
         }
+
+        //Bounds are rebuilt from all rows, not only the updated ones
+        chunk->bounds = AxisAlignedBox::BOX_NULL;
+
+        uint32_t chunkVertexCount = rowSize * rowSize;
+        for (uint32_t i = 0; i < chunkVertexCount; ++i)
+            chunk->bounds.merge(chunkVertices[chunk->firstVertex + i].position);
     }
 
     void Terrain::updateTerrain()
     {
         updateTerrainMesh();
+        updateChunks();
 
-        if (!bgfx::isValid(vbh))
-            vbh = bgfx::createDynamicVertexBuffer(vertexCount, VertexLayouts::terrainVertexLayout);
+        uint32_t chunkVertexCount = chunks.size() * (TERRAIN_CHUNK_SIZE + 1) * (TERRAIN_CHUNK_SIZE + 1);
 
-        if (!bgfx::isValid(ibh))
-            ibh = bgfx::createDynamicIndexBuffer(indexCount, BGFX_BUFFER_INDEX32);
+        if (!bgfx::isValid(vbh))
+            vbh = bgfx::createDynamicVertexBuffer(chunkVertexCount, VertexLayouts::terrainVertexLayout);
 
-        const bgfx::Memory* mem = bgfx::makeRef(&vertices[0], sizeof(VertexBuffer) * vertexCount, releaseData);
+        const bgfx::Memory* mem = bgfx::makeRef(&chunkVertices[0], sizeof(VertexBuffer) * chunkVertexCount, releaseData);
         bgfx::update(vbh, 0, mem);
+    }
 
-        mem = bgfx::makeRef(&indices[0], sizeof(uint32_t) * indexCount, releaseData);
-        bgfx::update(ibh, 0, mem);
+    void Terrain::updateIfDirty()
+    {
+        if (isDirty || !bgfx::isValid(vbh))
+        {
+            updateTerrain();
+            isDirty = false;
+        }
+        else if (!meshDirtyRect.isEmpty())
+            updateTerrainRegion();
+
+        meshDirtyRect.reset();
     }
 
-    void Terrain::updatePositions(/*glm::vec3 _min, glm::vec3 _max*/)
+    void Terrain::updatePositions()
     {
-        //glm::vec3 _wmin = glm::vec3(_min.x, _min.y, _min.z);// -transform->getPosition());
-        //glm::vec3 _wmax = glm::vec3(_max.x, _max.y, _max.z);// -transform->getPosition());
         Transform* terrainTrans = getGameObject()->getTransform();
 
+        //Nothing tracked means the heightmap was changed directly
+        if (positionsDirtyRect.isEmpty())
+            positionsDirtyRect.merge(0, 0, size - 1, size - 1);
+
+        //Heights are interpolated between the neighbour vertices
+        float scale = getScale();
+        float minX = positionsDirtyRect.minX - 2;
+        float minY = positionsDirtyRect.minY - 2;
+        float maxX = positionsDirtyRect.maxX + 2;
+        float maxY = positionsDirtyRect.maxY + 2;
+
+        positionsDirtyRect.reset();
+
+        auto inside = [=](glm::vec3 position) -> bool
+        {
+            float x = size - (position.x / scale + size / 2.0f);
+            float y = position.z / scale + size / 2.0f;
+
+            return x >= minX && x <= maxX && y >= minY && y <= maxY;
+        };
+
         for (auto g = grassList.begin(); g != grassList.end(); ++g)
         {
             TerrainGrassData* grass = *g;
             for (auto it = grass->batches.begin(); it != grass->batches.end(); ++it)
             {
                 TerrainGrassData::Batch* batch = *it;
+                bool changed = false;
+
                 for (auto m = batch->meshes.begin(); m != batch->meshes.end(); ++m)
                 {
-                    //AxisAlignedBox aab = AxisAlignedBox(_wmin, _wmax);
-                    //if (aab.contains(glm::vec3(m->position.x, (_wmin.y + _wmax.y) / 2.0f, m->position.y)))
-                    //{
-                    //batch->update();
-                    //break;
-                    //}
+                    if (!inside(m->position))
+                        continue;
+
                     float y = getHeightAtWorldPos(glm::vec3(m->position.x, 0, m->position.z) + terrainTrans->getPosition());
                     m->position.y = y;
+                    changed = true;
                 }
 
-                batch->update();
+                if (changed)
+                    batch->update();
             }
         }
 
@@ -1921,6 +2308,9 @@ namespace GX
             const std::vector<TerrainTreeData::TreeMesh*>& meshes = (*t)->getMeshes();
             for (auto m = meshes.begin(); m != meshes.end(); ++m)
             {
+                if (!inside((*m)->position))
+                    continue;
+
                 float y = getHeightAtWorldPos(glm::vec3((*m)->position.x, 0, (*m)->position.z) + terrainTrans->getPosition());
                 (*m)->position.y = y;
                 (*m)->updateTransform(); //prevTransform = glm::mat4x4(FLT_MAX);
@@ -1933,12 +2323,20 @@ namespace GX
             for (auto b = batches.begin(); b != batches.end(); ++b)
             {
                 TerrainDetailMeshData::Batch* batch = *b;
+                bool changed = false;
+
                 for (auto m = batch->meshes.begin(); m != batch->meshes.end(); ++m)
                 {
+                    if (!inside(m->position))
+                        continue;
+
                     float y = getHeightAtWorldPos(glm::vec3(m->position.x, 0, m->position.z) + terrainTrans->getPosition());
                     m->position.y = y;
+                    changed = true;
                 }
-                batch->update();
+
+                if (changed)
+                    batch->update();
             }
         }
     }
@@ -1956,9 +2354,12 @@ namespace GX
         attach();
         updateTreesTransforms();
 
+        for (auto& c : chunks)
+            c->attach();
+
         for (auto& t : treeList)
         {
-            for (auto& m : t->getMeshes())
+            for (auto& m : t->getCells())
                 m->attach();
         }
 
@@ -1983,9 +2384,12 @@ namespace GX
 
         detach();
 
+        for (auto& c : chunks)
+            c->detach();
+
         for (auto& t : treeList)
         {
-            for (auto& m : t->getMeshes())
+            for (auto& m : t->getCells())
                 m->detach();
         }
 
@@ -2504,6 +2908,86 @@ namespace GX
         deserialize(data, path);
     }
 
+    //----------------------CHUNKS----------------------//
+
+    Terrain::Chunk::Chunk(Terrain* _parent, int _x, int _y) : Renderable()
+    {
+        parent = _parent;
+        x = _x;
+        y = _y;
+        firstVertex = (y * parent->chunksPerSide + x) * (TERRAIN_CHUNK_SIZE + 1) * (TERRAIN_CHUNK_SIZE + 1);
+    }
+
+    Terrain::Chunk::~Chunk()
+    {
+
+    }
+
+    AxisAlignedBox Terrain::Chunk::getBounds(bool world)
+    {
+        if (world)
+        {
+            glm::mat4x4 mtx = parent->transform->getTransformMatrix();
+
+            if (mtx != prevTransform)
+            {
+                cachedAAB = bounds;
+                cachedAAB.transform(mtx);
+
+                prevTransform = mtx;
+            }
+
+            return cachedAAB;
+        }
+        else
+        {
+            return bounds;
+        }
+    }
+
+    bool Terrain::Chunk::isStatic()
+    {
+        return parent->isStatic();
+    }
+
+    bool Terrain::Chunk::getCastShadows()
+    {
+        return parent->getCastShadows();
+    }
+
+    bool Terrain::Chunk::checkCullingMask(LayerMask& mask)
+    {
+        return parent->checkCullingMask(mask);
+    }
+
+    Material* Terrain::Chunk::getSortMaterial()
+    {
+        return parent->material;
+    }
+
+    int Terrain::getChunkLod(int x, int y, glm::vec3 eye)
+    {
+        if (x < 0 || y < 0 || x >= chunksPerSide || y >= chunksPerSide)
+            return 0;
+
+        AxisAlignedBox& aab = chunks[y * chunksPerSide + x]->bounds;
+        if (aab.isNull() || aab.isInfinite())
+            return 0;
+
+        //Horizontal distance only, so neighbour chunks never differ by more than one level
+        glm::vec3& _min = aab.getMinimum();
+        glm::vec3& _max = aab.getMaximum();
+
+        float dx = std::max(std::max(_min.x - eye.x, eye.x - _max.x), 0.0f);
+        float dz = std::max(std::max(_min.z - eye.z, eye.z - _max.z), 0.0f);
+        float distance = std::sqrt(dx * dx + dz * dz);
+
+        float chunkWorldSize = TERRAIN_CHUNK_SIZE * getScale() * TERRAIN_CHUNK_LOD_DISTANCE;
+        int lod = (int)std::floor(std::log2(1.0f + distance / chunkWorldSize));
+
+        return std::clamp(lod, 0, TERRAIN_CHUNK_LODS - 1);
+    }
+
     //----------------------RENDER----------------------//
 
     bool Terrain::isStatic()
@@ -2522,12 +3006,32 @@ namespace GX
         if (!getEnabled())
             return;
 
-        if (isDirty)
+        updateIfDirty();
+
+        //Terrain layers repeat every worldSize units, so the nearest point of the terrain defines the mip
+        if (camera != nullptr && program.idx == bgfx::kInvalidHandle)
         {
-            updateTerrain();
-            isDirty = false;
+            TextureStreamer* streamer = TextureStreamer::getSingleton();
+            float distance = getBounds().distance(camera->getTransform()->getPosition());
+
+            for (auto& texData : textureList)
+            {
+                if (texData.diffuseTexture != nullptr)
+                    streamer->requestMip(texData.diffuseTexture, TextureStreamer::calcMip(camera, texData.diffuseTexture, texData.worldSize, distance));
+
+                if (texData.normalTexture != nullptr)
+                    streamer->requestMip(texData.normalTexture, TextureStreamer::calcMip(camera, texData.normalTexture, texData.worldSize, distance));
+            }
         }
 
+        //Geometry is drawn by the chunks
+    }
+
+    void Terrain::submit(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback, uint32_t firstVertex, uint32_t numVertices, bgfx::IndexBufferHandle indexBuffer)
+    {
+        if (!bgfx::isValid(vbh))
+            return;
+
         const bgfx::Caps* caps = bgfx::getCaps();
 
         glm::mat4x4 trans = transform->getTransformMatrix();
@@ -2616,8 +3120,8 @@ namespace GX
                 bgfx::setTransform(glm::value_ptr(trans));
 
                 // Set vertex and index buffer.
-                bgfx::setVertexBuffer(0, vbh);
-                bgfx::setIndexBuffer(ibh);
+                bgfx::setVertexBuffer(0, vbh, firstVertex, numVertices);
+                bgfx::setIndexBuffer(indexBuffer);
 
                 // Set render states.
                 bgfx::setState(passState);
@@ -2713,6 +3217,43 @@ namespace GX
         }
     }
 
+    void Terrain::Chunk::onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback)
+    {
+        if (parent->gameObject == nullptr)
+            return;
+
+        if (!parent->gameObject->getActive())
+            return;
+
+        if (!parent->getEnabled())
+            return;
+
+        parent->updateIfDirty();
+
+        //Shadow passes have no camera and reuse the levels selected for the last rendered view
+        if (camera != nullptr)
+        {
+            glm::mat4x4 invTrans = glm::inverse(parent->transform->getTransformMatrix());
+            parent->lodPosition = invTrans * glm::vec4(camera->getTransform()->getPosition(), 1.0f);
+        }
+
+        glm::vec3 eye = parent->lodPosition;
+        int lod = parent->getChunkLod(x, y, eye);
+
+        int edges = 0;
+        if (x > 0 && parent->getChunkLod(x - 1, y, eye) > lod)
+            edges |= CHUNK_EDGE_LEFT;
+        if (x < parent->chunksPerSide - 1 && parent->getChunkLod(x + 1, y, eye) > lod)
+            edges |= CHUNK_EDGE_RIGHT;
+        if (y > 0 && parent->getChunkLod(x, y - 1, eye) > lod)
+            edges |= CHUNK_EDGE_BOTTOM;
+        if (y < parent->chunksPerSide - 1 && parent->getChunkLod(x, y + 1, eye) > lod)
+            edges |= CHUNK_EDGE_TOP;
+
+        uint32_t numVertices = (TERRAIN_CHUNK_SIZE + 1) * (TERRAIN_CHUNK_SIZE + 1);
+        parent->submit(camera, view, state, program, renderMode, preRenderCallback, firstVertex, numVertices, chunkIndexBuffers[lod][edges]);
+    }
+
     void TerrainGrassData::Batch::onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback)
     {
         if (parent == nullptr)
@@ -2730,6 +3271,8 @@ namespace GX
         if (!parent->terrain->getDrawGrass())
             return;
 
+        uint32_t drawIndexCount = indexCount;
+
         if (camera != nullptr)
         {
             AxisAlignedBox bounds = getBounds();
@@ -2739,9 +3282,21 @@ namespace GX
 
             if (!bounds.isInfinite())
             {
-                bool visible = Mathf::intersects(camera->getTransform()->getPosition(), parent->terrain->getGrassDrawDistance(), bounds);
+                glm::vec3 camPos = camera->getTransform()->getPosition();
+                float drawDistance = parent->terrain->getGrassDrawDistance();
+
+                bool visible = Mathf::intersects(camPos, drawDistance, bounds);
                 if (!visible)
                     return;
+
+                //Draw only a part of the blades far from the camera
+                float dist = glm::distance(camPos, glm::clamp(camPos, bounds.getMinimum(), bounds.getMaximum()));
+                uint32_t visibleCount = (uint32_t)((float)meshes.size() * Terrain::getDensityFalloff(dist, drawDistance));
+
+                if (visibleCount == 0)
+                    return;
+
+                drawIndexCount = std::min(visibleCount * 6, indexCount);
             }
         }
 
@@ -2832,7 +3387,7 @@ namespace GX
 
                 // Set vertex and index buffer.
                 bgfx::setVertexBuffer(0, vbh);
-                bgfx::setIndexBuffer(ibh);
+                bgfx::setIndexBuffer(ibh, 0, drawIndexCount);
 
                 // Set render states.
                 bgfx::setState(passState);
@@ -2894,7 +3449,7 @@ namespace GX
         }
     }
 
-    void TerrainTreeData::TreeMesh::onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback)
+    void TerrainTreeData::Cell::onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback)
     {
         if (parent == nullptr)
             return;
@@ -2913,120 +3468,261 @@ namespace GX
         if (!terrain->getDrawTrees())
             return;
 
-        glm::mat4x4 trans = getTransform();
-        glm::mat3x3 normalMatrix = glm::identity<glm::mat3x3>();
+        if (meshes.size() == 0)
+            return;
 
-        if (program.idx == bgfx::kInvalidHandle)
-            normalMatrix = trans;
+        if (instancesDirty)
+            updateInstances();
 
-        if (camera != nullptr)
+        //Shadow passes draw every tree of the cell as a mesh
+        if (camera == nullptr)
         {
-            Transform* terrTrans = terrain->getGameObject()->getTransform();
-            float dist = glm::distance(camera->getTransform()->getPosition(), glm::vec3(trans[3]));
+            for (auto& m : meshes)
+                renderMesh(m, camera, view, state, program, renderMode, preRenderCallback);
 
-            bool visible = dist <= terrain->getTreeDrawDistance();
-            if (!visible)
-                return;
+            return;
+        }
 
-            if (dist > terrain->treeImpostorStartDistance)
-            {
-                if (program.idx == bgfx::kInvalidHandle && static_cast<RenderMode>(renderMode) == RenderMode::Forward)
-                {
-                    if (6 == bgfx::getAvailTransientVertexBuffer(6, VertexLayouts::primitiveVertexLayout))
-                    {
-                        bgfx::TransientVertexBuffer vb;
-                        bgfx::allocTransientVertexBuffer(&vb, 6, VertexLayouts::primitiveVertexLayout);
-                        PosTexCoord0Vertex* vertex = (PosTexCoord0Vertex*)vb.data;
-
-                        AxisAlignedBox parentBounds = parent->getBounds();
-
-                        float zz = 0;
-                        float szX = parentBounds.getSize().y * 0.5f;
-                        float szY = parentBounds.getSize().y;
-
-                        vertex[0].pos = glm::vec3(-szX, 0, zz);
-                        vertex[0].uv = glm::vec2(0, 0);
-                        vertex[1].pos = glm::vec3(-szX, szY, zz);
-                        vertex[1].uv = glm::vec2(0, 1);
-                        vertex[2].pos = glm::vec3(szX, szY, zz);
-                        vertex[2].uv = glm::vec2(1, 1);
-                        //--
-                        vertex[3].pos = glm::vec3(szX, szY, zz);
-                        vertex[3].uv = glm::vec2(1, 1);
-                        vertex[4].pos = glm::vec3(szX, 0, zz);
-                        vertex[4].uv = glm::vec2(1, 0);
-                        vertex[5].pos = glm::vec3(-szX, 0, zz);
-                        vertex[5].uv = glm::vec2(0, 0);
-
-                        glm::mat4x4 trans2 = glm::translate(glm::identity<glm::mat4x4>(), position);
-                        trans2 = glm::scale(trans2, glm::vec3(scale));
-                        trans2 = terrTrans->getTransformMatrix() * trans2;
-
-                        Transform* ct = camera->getTransform();
-                        glm::mat4x4 mtx = trans2;
-                        glm::highp_quat rot = glm::quatLookAt(-ct->getForward(), ct->getUp());
-                        mtx = mtx * glm::mat4_cast(glm::inverse(terrTrans->getRotation()) * rot);
-
-                        glm::vec3 nrm = ct->getPosition() - position;
-
-                        bool rendered = false;
-                        //Lighting pass
-                        std::vector<Light*>& lights = Renderer::getSingleton()->getLights();
-                        for (int iter = 0; iter < lights.size(); ++iter)
-                        {
-                            Light* light = lights[iter];
+        //Nearest and farthest points of the cell decide if trees can be handled all at once
+        AxisAlignedBox aab = getBounds();
+        glm::vec3 camPos = camera->getTransform()->getPosition();
+        glm::vec3 nearest = glm::clamp(camPos, aab.getMinimum(), aab.getMaximum());
+        glm::vec3 farthest = glm::max(glm::abs(camPos - aab.getMinimum()), glm::abs(camPos - aab.getMaximum()));
 
-                            if (light->getLightType() != LightType::Directional)
-                                continue;
+        float minDist = glm::distance(camPos, nearest);
+        float maxDist = glm::length(farthest);
 
-                            if (!light->submitUniforms())
-                                continue;
+        float drawDistance = terrain->getTreeDrawDistance();
+        float impostorDistance = terrain->treeImpostorStartDistance;
 
-                            bgfx::setVertexBuffer(0, &vb);
-                            bgfx::setTransform(glm::value_ptr(mtx), 1);
-                            //bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_CULL_CW);
-                            bgfx::setState((state &= ~(BGFX_STATE_WRITE_A)));
+        if (minDist > drawDistance)
+            return;
 
-                            if (bgfx::isValid(parent->impostorTexture))
-                                bgfx::setTexture(0, Terrain::albedoTextureHandle, parent->impostorTexture);
+        bool drawBillboards = program.idx == bgfx::kInvalidHandle && static_cast<RenderMode>(renderMode) == RenderMode::Forward;
 
-                            //Renderer::getSingleton()->setSystemUniforms(camera);
-                            bgfx::setUniform(Renderer::getNormalUniform(), glm::value_ptr(glm::vec4(nrm.x, nrm.y, nrm.z, 1.0f)), 1);
+        if (maxDist <= impostorDistance)
+        {
+            for (auto& m : meshes)
+                renderMesh(m, camera, view, state, program, renderMode, preRenderCallback);
 
-                            if (preRenderCallback != nullptr)
-                                preRenderCallback();
+            return;
+        }
 
-                            bgfx::submit(view, Renderer::getSingleton()->getTerrainTreeBillboardLightProgram());
+        if (minDist > impostorDistance && maxDist <= drawDistance)
+        {
+            if (drawBillboards)
+                renderBillboards(meshes, true, camera, view, state, preRenderCallback);
 
-                            rendered = true;
-                            break;
-                        }
+            return;
+        }
 
-                        if (!rendered)
-                        {
-                            //Ambient pass
-                            bgfx::setVertexBuffer(0, &vb);
-                            bgfx::setTransform(glm::value_ptr(mtx), 1);
-                            //bgfx::setState(BGFX_STATE_WRITE_RGB | BGFX_STATE_WRITE_Z | BGFX_STATE_DEPTH_TEST_LEQUAL | BGFX_STATE_CULL_CW);
-                            bgfx::setState((state &= ~(BGFX_STATE_WRITE_A)));
+        //Cell crosses one of the distance borders, split it per tree
+        std::vector<TreeMesh*> billboards;
+
+        for (auto& m : meshes)
+        {
+            float dist = glm::distance(camPos, glm::vec3(m->cachedTransform[3]));
+
+            if (dist > drawDistance)
+                continue;
 
-                            if (bgfx::isValid(parent->impostorTexture))
-                                bgfx::setTexture(0, Terrain::albedoTextureHandle, parent->impostorTexture);
+            if (dist > impostorDistance)
+            {
+                if (drawBillboards)
+                    billboards.push_back(m);
+            }
+            else
+                renderMesh(m, camera, view, state, program, renderMode, preRenderCallback);
+        }
 
-                            //Renderer::getSingleton()->setSystemUniforms(camera);
-                            bgfx::setUniform(Renderer::getNormalUniform(), glm::value_ptr(glm::vec4(nrm.x, nrm.y, nrm.z, 1.0f)), 1);
+        if (billboards.size() > 0)
+            renderBillboards(billboards, false, camera, view, state, preRenderCallback);
+    }
 
-                            if (preRenderCallback != nullptr)
-                                preRenderCallback();
+    void TerrainTreeData::Cell::renderBillboards(const std::vector<TreeMesh*>& trees, bool allTrees, Camera* camera, int view, uint64_t state, std::function<void()> preRenderCallback)
+    {
+        Renderer* renderer = Renderer::getSingleton();
 
-                            bgfx::submit(view, Renderer::getSingleton()->getTerrainTreeBillboardProgram());
-                        }
-                    }
-                }
+        bgfx::ProgramHandle ambientProgram = renderer->getTerrainTreeBillboardInstancedProgram();
+        bgfx::ProgramHandle lightProgram = renderer->getTerrainTreeBillboardLightInstancedProgram();
+
+        //Fallback for renderers without instancing
+        if (!bgfx::isValid(ambientProgram) || !bgfx::isValid(lightProgram) || !bgfx::isValid(parent->impostorVbh))
+        {
+            for (auto& m : trees)
+                renderBillboard(m, camera, view, state, preRenderCallback);
+
+            return;
+        }
+
+        bgfx::InstanceDataBuffer idb;
+        uint32_t numInstances = (uint32_t)trees.size();
 
+        if (allTrees)
+        {
+            if (!bgfx::isValid(instanceBuffer))
+                return;
+        }
+        else
+        {
+            const uint16_t stride = sizeof(glm::mat4x4);
+            if (numInstances != bgfx::getAvailInstanceDataBuffer(numInstances, stride))
                 return;
+
+            bgfx::allocInstanceDataBuffer(&idb, numInstances, stride);
+            glm::mat4x4* data = (glm::mat4x4*)idb.data;
+
+            for (uint32_t i = 0; i < numInstances; ++i)
+                data[i] = trees[i]->getTransform();
+        }
+
+        //Light shader only uses the first directional light as billboards did before
+        bgfx::ProgramHandle ph = ambientProgram;
+
+        std::vector<Light*>& lights = renderer->getLights();
+        for (int iter = 0; iter < lights.size(); ++iter)
+        {
+            Light* light = lights[iter];
+
+            if (light->getLightType() != LightType::Directional)
+                continue;
+
+            if (!light->submitUniforms())
+                continue;
+
+            ph = lightProgram;
+            break;
+        }
+
+        //Quads are aligned to the camera plane in the vertex shader, so they all share this normal
+        glm::vec3 nrm = -camera->getTransform()->getForward();
+
+        bgfx::setVertexBuffer(0, parent->impostorVbh);
+
+        if (allTrees)
+            bgfx::setInstanceDataBuffer(instanceBuffer, 0, numInstances);
+        else
+            bgfx::setInstanceDataBuffer(&idb);
+
+        bgfx::setState(state & ~(BGFX_STATE_WRITE_A));
+
+        if (bgfx::isValid(parent->impostorTexture))
+            bgfx::setTexture(0, Terrain::albedoTextureHandle, parent->impostorTexture);
+
+        bgfx::setUniform(Renderer::getNormalUniform(), glm::value_ptr(glm::vec4(nrm.x, nrm.y, nrm.z, 1.0f)), 1);
+
+        if (preRenderCallback != nullptr)
+            preRenderCallback();
+
+        bgfx::submit(view, ph);
+    }
+
+    void TerrainTreeData::Cell::renderBillboard(TreeMesh* mesh, Camera* camera, int view, uint64_t state, std::function<void()> preRenderCallback)
+    {
+        Terrain* terrain = parent->terrain;
+        Transform* terrTrans = terrain->getGameObject()->getTransform();
+
+        if (6 == bgfx::getAvailTransientVertexBuffer(6, VertexLayouts::primitiveVertexLayout))
+        {
+            bgfx::TransientVertexBuffer vb;
+            bgfx::allocTransientVertexBuffer(&vb, 6, VertexLayouts::primitiveVertexLayout);
+            PosTexCoord0Vertex* vertex = (PosTexCoord0Vertex*)vb.data;
+
+            AxisAlignedBox parentBounds = parent->getBounds();
+
+            float zz = 0;
+            float szX = parentBounds.getSize().y * 0.5f;
+            float szY = parentBounds.getSize().y;
+
+            vertex[0].pos = glm::vec3(-szX, 0, zz);
+            vertex[0].uv = glm::vec2(0, 0);
+            vertex[1].pos = glm::vec3(-szX, szY, zz);
+            vertex[1].uv = glm::vec2(0, 1);
+            vertex[2].pos = glm::vec3(szX, szY, zz);
+            vertex[2].uv = glm::vec2(1, 1);
+            //--
+            vertex[3].pos = glm::vec3(szX, szY, zz);
+            vertex[3].uv = glm::vec2(1, 1);
+            vertex[4].pos = glm::vec3(szX, 0, zz);
+            vertex[4].uv = glm::vec2(1, 0);
+            vertex[5].pos = glm::vec3(-szX, 0, zz);
+            vertex[5].uv = glm::vec2(0, 0);
+
+            glm::mat4x4 trans2 = glm::translate(glm::identity<glm::mat4x4>(), mesh->position);
+            trans2 = glm::scale(trans2, glm::vec3(mesh->scale));
+            trans2 = terrTrans->getTransformMatrix() * trans2;
+
+            Transform* ct = camera->getTransform();
+            glm::mat4x4 mtx = trans2;
+            glm::highp_quat rot = glm::quatLookAt(-ct->getForward(), ct->getUp());
+            mtx = mtx * glm::mat4_cast(glm::inverse(terrTrans->getRotation()) * rot);
+
+            //Quad faces the camera plane, same normal as in renderBillboards
+            glm::vec3 nrm = -ct->getForward();
+
+            bool rendered = false;
+            //Lighting pass
+            std::vector<Light*>& lights = Renderer::getSingleton()->getLights();
+            for (int iter = 0; iter < lights.size(); ++iter)
+            {
+                Light* light = lights[iter];
+
+                if (light->getLightType() != LightType::Directional)
+                    continue;
+
+                if (!light->submitUniforms())
+                    continue;
+
+                bgfx::setVertexBuffer(0, &vb);
+                bgfx::setTransform(glm::value_ptr(mtx), 1);
+                bgfx::setState((state &= ~(BGFX_STATE_WRITE_A)));
+
+                if (bgfx::isValid(parent->impostorTexture))
+                    bgfx::setTexture(0, Terrain::albedoTextureHandle, parent->impostorTexture);
+
+                bgfx::setUniform(Renderer::getNormalUniform(), glm::value_ptr(glm::vec4(nrm.x, nrm.y, nrm.z, 1.0f)), 1);
+
+                if (preRenderCallback != nullptr)
+                    preRenderCallback();
+
+                bgfx::submit(view, Renderer::getSingleton()->getTerrainTreeBillboardLightProgram());
+
+                rendered = true;
+                break;
+            }
+
+            if (!rendered)
+            {
+                //Ambient pass
+                bgfx::setVertexBuffer(0, &vb);
+                bgfx::setTransform(glm::value_ptr(mtx), 1);
+                bgfx::setState((state &= ~(BGFX_STATE_WRITE_A)));
+
+                if (bgfx::isValid(parent->impostorTexture))
+                    bgfx::setTexture(0, Terrain::albedoTextureHandle, parent->impostorTexture);
+
+                bgfx::setUniform(Renderer::getNormalUniform(), glm::value_ptr(glm::vec4(nrm.x, nrm.y, nrm.z, 1.0f)), 1);
+
+                if (preRenderCallback != nullptr)
+                    preRenderCallback();
+
+                bgfx::submit(view, Renderer::getSingleton()->getTerrainTreeBillboardProgram());
             }
         }
+    }
+
+    void TerrainTreeData::Cell::renderMesh(TreeMesh* mesh, Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback)
+    {
+        Renderer* renderer = Renderer::getSingleton();
+
+        glm::mat4x4 trans = mesh->getTransform();
+        glm::mat3x3 normalMatrix = glm::identity<glm::mat3x3>();
+
+        if (program.idx == bgfx::kInvalidHandle)
+            normalMatrix = trans;
+
+        //Near trees are merged into the renderer instance batches when their material allows it
+        bool instanced = program.idx == bgfx::kInvalidHandle && renderer->getCollectInstances();
 
         for (auto it = parent->meshList.begin(); it != parent->meshList.end(); ++it)
         {
@@ -3053,6 +3749,12 @@ namespace GX
                         continue;
                 }
 
+                if (instanced)
+                {
+                    if (renderer->addInstance(subMesh, 0, material, trans))
+                        continue;
+                }
+
                 int passCount = 1;
 
                 if (program.idx == bgfx::kInvalidHandle)
@@ -3074,7 +3776,7 @@ namespace GX
 
                     int iterationCount = 1;
 
-                    std::vector<Light*>& lights = Renderer::getSingleton()->getLights();
+                    std::vector<Light*>& lights = renderer->getLights();
 
                     if (program.idx == bgfx::kInvalidHandle)
                     {
@@ -3102,7 +3804,7 @@ namespace GX
                                 {
                                     if (lights.size() > 0)
                                     {
-                                        Light* light = Renderer::getSingleton()->getFirstLight();
+                                        Light* light = renderer->getFirstLight();
                                         if (light != nullptr)
                                             light->submitUniforms();
                                     }
@@ -3131,7 +3833,7 @@ namespace GX
                         }
                         else
                         {
-                            bgfx::UniformHandle tex = Renderer::getSingleton()->getAlbedoMapUniform();
+                            bgfx::UniformHandle tex = renderer->getAlbedoMapUniform();
                             auto& uniforms = material->getUniforms();
                             bool textureWasSet = false;
                             for (auto& u : uniforms)
@@ -3201,12 +3903,17 @@ namespace GX
         if (!terrain->getDrawDetailMeshes())
             return;
 
+        if (meshes.size() == 0)
+            return;
+
         glm::mat4x4 trans = terrain->getGameObject()->getTransform()->getTransformMatrix();
         glm::mat3x3 normalMatrix = glm::identity<glm::mat3x3>();
 
         if (program.idx == bgfx::kInvalidHandle)
             normalMatrix = trans;
 
+        uint32_t visibleCount = (uint32_t)meshes.size();
+
         if (camera != nullptr)
         {
             AxisAlignedBox bounds = getBounds();
@@ -3216,9 +3923,19 @@ namespace GX
 
             if (!bounds.isInfinite())
             {
-                bool visible = Mathf::intersects(camera->getTransform()->getPosition(), terrain->getDetailMeshesDrawDistance(), bounds);
+                glm::vec3 camPos = camera->getTransform()->getPosition();
+                float drawDistance = terrain->getDetailMeshesDrawDistance();
+
+                bool visible = Mathf::intersects(camPos, drawDistance, bounds);
                 if (!visible)
                     return;
+
+                //Draw only a part of the meshes far from the camera
+                float dist = glm::distance(camPos, glm::clamp(camPos, bounds.getMinimum(), bounds.getMaximum()));
+                visibleCount = std::min((uint32_t)((float)meshes.size() * Terrain::getDensityFalloff(dist, drawDistance)), (uint32_t)meshes.size());
+
+                if (visibleCount == 0)
+                    return;
             }
         }
 
@@ -3309,7 +4026,7 @@ namespace GX
 
                         // Set vertex and index buffer.
                         bgfx::setVertexBuffer(0, subBatch.vbh);
-                        bgfx::setIndexBuffer(subBatch.ibh);
+                        bgfx::setIndexBuffer(subBatch.ibh, 0, subBatch.indexCount / (uint32_t)meshes.size() * visibleCount);
 
                         // Set render states.
                         bgfx::setState(passState);
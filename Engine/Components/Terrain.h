@@ -11,6 +11,10 @@
 #include "../Serialization/Assets/STerrainData.h"
 
 #define MAX_TERRAIN_TEXTURES 5
+#define TERRAIN_CHUNK_SIZE 64 //Quads per chunk side
+#define TERRAIN_CHUNK_LODS 7 //Vertex step 1 to TERRAIN_CHUNK_SIZE
+#define TERRAIN_CHUNK_LOD_DISTANCE 2.0f //Distance in chunks covered by the first LOD
+#define TERRAIN_VEGETATION_CELL_SIZE 32.0f //Grass, trees and detail meshes are grouped and culled by cells of this size
 
 namespace GX
 {
@@ -32,38 +36,74 @@ namespace GX
         friend class Terrain;
 
     public:
-        class TreeMesh : public Renderable
+        class Cell;
+
+        class TreeMesh
         {
             friend class Terrain;
             friend struct TerrainTreeData;
 
         private:
-            struct PosTexCoord0Vertex
-            {
-                glm::vec3 pos = glm::vec3(0);
-                glm::vec2 uv = glm::vec2(0);
-            };
-
             TerrainTreeData* parent = nullptr;
+            Cell* cell = nullptr;
             AxisAlignedBox cachedAAB = AxisAlignedBox::BOX_NULL;
             glm::mat4x4 cachedTransform = glm::mat4x4(FLT_MAX);
             glm::mat4x4 getTransform();
 
         public:
             TreeMesh(TerrainTreeData* _parent);
-            virtual ~TreeMesh();
+            ~TreeMesh();
 
             glm::vec3 position = glm::vec3(0.0f);
             float scale = 1.0f;
             float rotation = 0.0f;
 
+            AxisAlignedBox getBounds(bool world = true);
+
+            void updateTransform();
+        };
+
+        //Trees of one area of the terrain. Culled as a whole and drawn with instancing
+        class Cell : public Renderable
+        {
+            friend class Terrain;
+            friend struct TerrainTreeData;
+
+        private:
+            struct PosTexCoord0Vertex
+            {
+                glm::vec3 pos = glm::vec3(0);
+                glm::vec2 uv = glm::vec2(0);
+            };
+
+            TerrainTreeData* parent = nullptr;
+            glm::ivec2 index = glm::ivec2(0);
+            std::vector<TreeMesh*> meshes;
+
+            AxisAlignedBox bounds = AxisAlignedBox::BOX_NULL;
+            bool boundsDirty = true;
+
+            bgfx::VertexBufferHandle instanceBuffer = { bgfx::kInvalidHandle };
+            bool instancesDirty = true;
+
+            void updateInstances();
+            void renderMesh(TreeMesh* mesh, Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback);
+            void renderBillboards(const std::vector<TreeMesh*>& trees, bool allTrees, Camera* camera, int view, uint64_t state, std::function<void()> preRenderCallback);
+            void renderBillboard(TreeMesh* mesh, Camera* camera, int view, uint64_t state, std::function<void()> preRenderCallback);
+
+        public:
+            Cell(TerrainTreeData* _parent, glm::ivec2 _index);
+            virtual ~Cell();
+
             virtual AxisAlignedBox getBounds(bool world = true);
             virtual bool isTransparent() { return false; }
             virtual bool getCastShadows();
             virtual void onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback);
             virtual bool checkCullingMask(LayerMask& mask);
 
-            void updateTransform();
+            void setDirty() { boundsDirty = true; instancesDirty = true; }
+
+            const std::vector<TreeMesh*>& getMeshes() { return meshes; }
         };
 
     private:
@@ -83,13 +123,18 @@ namespace GX
 
         std::vector<ModelMeshData> meshList;
         bgfx::TextureHandle impostorTexture = { bgfx::kInvalidHandle };
+        bgfx::VertexBufferHandle impostorVbh = { bgfx::kInvalidHandle };
 
         std::vector<TreeMesh*> meshes;
+        std::vector<Cell*> cells;
 
         AxisAlignedBox bounds = AxisAlignedBox::BOX_NULL;
         void destroyImpostorTexture();
         void updateImpostorTexture();
 
+        void addToCell(TreeMesh* mesh);
+        void removeFromCell(TreeMesh* mesh);
+
     public:
         TerrainTreeData(Terrain* _terrain) { terrain = _terrain; }
         ~TerrainTreeData();
@@ -112,6 +157,7 @@ namespace GX
         void addTree(glm::vec3 position, float rotation, float scale);
         bool removeTree(glm::vec2 pos, float density);
         const std::vector<TreeMesh*>& getMeshes() { return meshes; }
+        const std::vector<Cell*>& getCells() { return cells; }
 
         void destroy();
     };
@@ -157,6 +203,7 @@ namespace GX
             };
 
             TerrainDetailMeshData* parent = nullptr;
+            glm::ivec2 cell = glm::ivec2(0);
             AxisAlignedBox bounds = AxisAlignedBox::BOX_NULL;
             AxisAlignedBox cachedAAB = AxisAlignedBox::BOX_NULL;
             glm::mat4x4 prevTransform = glm::mat4x4(FLT_MAX);
@@ -206,6 +253,7 @@ namespace GX
         std::vector<Batch*> batches;
 
         AxisAlignedBox bounds = AxisAlignedBox::BOX_NULL;
+        Batch* getBatch(glm::vec3 position);
         void destroyImpostorTexture();
         void updateImpostorTexture();
 
@@ -278,6 +326,7 @@ namespace GX
             glm::mat4x4 prevTransform = glm::mat4x4(FLT_MAX);
 
             TerrainGrassData* parent = nullptr;
+            glm::ivec2 cell = glm::ivec2(0);
 
             std::vector<GrassMesh> meshes;
 
@@ -310,6 +359,7 @@ namespace GX
 
         std::vector<Batch*> batches;
 
+        Batch* getBatch(glm::vec3 position);
         void destroy();
 
     public:
@@ -348,7 +398,70 @@ namespace GX
             glm::vec2 texcoord1 = glm::vec2(0, 0);
         };
 
+        //Fixed size part of the terrain with its own bounds and level of detail
+        class Chunk : public Renderable
+        {
+            friend class Terrain;
+
+        private:
+            Terrain* parent = nullptr;
+            int x = 0;
+            int y = 0;
+            uint32_t firstVertex = 0;
+
+            AxisAlignedBox bounds = AxisAlignedBox::Extent::EXTENT_INFINITE;
+            AxisAlignedBox cachedAAB = AxisAlignedBox::Extent::EXTENT_INFINITE;
+            glm::mat4x4 prevTransform = glm::mat4x4(FLT_MAX);
+
+        public:
+            Chunk(Terrain* _parent, int _x, int _y);
+            virtual ~Chunk();
+
+            virtual AxisAlignedBox getBounds(bool world = true);
+            virtual bool isTransparent() { return false; }
+            virtual bool isStatic();
+            virtual bool getCastShadows();
+            virtual void onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback);
+            virtual bool checkCullingMask(LayerMask& mask);
+            virtual Material* getSortMaterial();
+        };
+
     private:
+        //Area of the heightmap in vertices
+        struct DirtyRect
+        {
+            int minX = 0;
+            int minY = 0;
+            int maxX = -1;
+            int maxY = -1;
+
+            bool isEmpty() { return maxX < minX || maxY < minY; }
+            void reset() { minX = 0; minY = 0; maxX = -1; maxY = -1; }
+            void merge(int x0, int y0, int x1, int y1)
+            {
+                if (isEmpty())
+                {
+                    minX = x0; minY = y0; maxX = x1; maxY = y1;
+                }
+                else
+                {
+                    minX = std::min(minX, x0); minY = std::min(minY, y0);
+                    maxX = std::max(maxX, x1); maxY = std::max(maxY, y1);
+                }
+            }
+        };
+
+        enum ChunkEdge
+        {
+            CHUNK_EDGE_LEFT = 1,
+            CHUNK_EDGE_RIGHT = 2,
+            CHUNK_EDGE_BOTTOM = 4,
+            CHUNK_EDGE_TOP = 8
+        };
+
+        static bgfx::IndexBufferHandle chunkIndexBuffers[TERRAIN_CHUNK_LODS][16];
+        static bool chunkIndexBuffersCreated;
+
         static bgfx::UniformHandle textureDiffuseHandles[MAX_TERRAIN_TEXTURES];
         static bgfx::UniformHandle textureNormalHandles[MAX_TERRAIN_TEXTURES];
         static bgfx::UniformHandle textureSplatHandles[MAX_TERRAIN_TEXTURES];
@@ -357,6 +470,8 @@ namespace GX
         static bgfx::UniformHandle albedoTextureHandle;
 
         bool isDirty = true;
+        DirtyRect meshDirtyRect; //Vertices to rebuild on the next render
+        DirtyRect positionsDirtyRect; //Vertices to re-snap grass, trees and detail meshes to
 
         Transform* transform = nullptr;
 
@@ -365,7 +480,6 @@ namespace GX
         glm::mat4x4 prevTransform = glm::mat4x4(FLT_MAX);
 
         bgfx::DynamicVertexBufferHandle vbh = { bgfx::kInvalidHandle };
-        bgfx::DynamicIndexBufferHandle ibh = { bgfx::kInvalidHandle };
 
         float* heightMap = nullptr;
         VertexBuffer* vertices = nullptr;
@@ -373,6 +487,11 @@ namespace GX
         uint32_t vertexCount = 0;
         uint32_t indexCount = 0;
 
+        std::vector<Chunk*> chunks;
+        VertexBuffer* chunkVertices = nullptr;
+        int chunksPerSide = 0;
+        glm::vec3 lodPosition = glm::vec3(0.0f);
+
         Material* material = nullptr;
         std::string filePath = "";
 
@@ -401,9 +520,19 @@ namespace GX
         void create();
         void recreate();
         void updateTerrainMesh();
+        void updateVertexPositions(int x0, int y0, int x1, int y1);
+        void updateNormals(int x0, int y0, int x1, int y1);
         void updateTerrain();
+        void updateTerrainRegion();
+        void updateChunks();
+        void updateChunkRows(Chunk* chunk, int firstRow, int lastRow);
+        void updateIfDirty();
         void updateTreesTransforms();
 
+        int getChunkLod(int x, int y, glm::vec3 eye);
+        void submit(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback, uint32_t firstVertex, uint32_t numVertices, bgfx::IndexBufferHandle indexBuffer);
+
+        static void createChunkIndexBuffers();
         static void releaseData(void* _ptr, void* _userData);
 
     public:
@@ -418,6 +547,7 @@ namespace GX
         virtual bool isStatic();
         virtual void onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback);
         virtual bool checkCullingMask(LayerMask& mask);
+        virtual Material* getSortMaterial() { return material; }
         virtual void onAttach();
         virtual void onDetach();
         virtual void onRefresh();
@@ -446,6 +576,9 @@ namespace GX
         float getGrassDrawDistance() { return grassDrawDistance; }
         void setGrassDrawDistance(float value) { grassDrawDistance = value; }
 
+        //Fraction of grass and detail meshes drawn at the given distance
+        static float getDensityFalloff(float distance, float drawDistance);
+
         std::vector<TerrainTextureData>& getTextures() { return textureList; }
         std::vector<TerrainTreeData*>& getTrees() { return treeList; }
         std::vector<TerrainDetailMeshData*>& getDetailMeshes() { return detailMeshList; }
@@ -482,7 +615,8 @@ namespace GX
         bool getDetailMeshesCastShadows() { return detailMeshesCastShadows; }
 
         bool getIsDirty() { return isDirty; }
-        void setIsDirty() { isDirty = true; }
+        void setIsDirty();
+        void setIsDirty(int x0, int y0, int x1, int y1); //Only the given heightmap area has changed
 
         TerrainGrassData* addGrassData();
         void removeGrassData(int index);
@@ -493,7 +627,7 @@ namespace GX
         TerrainDetailMeshData* addDetailMeshData();
         void removeDetailMeshData(int index);
 
-        void updatePositions(/*glm::vec3 _min, glm::vec3 _max*/);
+        void updatePositions(); //Re-snaps objects inside the area changed since the last call
 
         uint32_t getIndexCount() { return indexCount; }
         uint32_t getVertexCount() { return vertexCount; }
@@ -55,7 +55,7 @@ namespace GX
 		if (getGameObject() == nullptr)
 			return;
 
-		Terrain* terrain = (Terrain*)getGameObject()->getComponent(Terrain::COMPONENT_TYPE);
+		Terrain* terrain = getGameObject()->getComponent<Terrain>();
 		if (terrain == nullptr)
 			return;
 
@@ -81,6 +81,10 @@ namespace GX
 		Transform* prevParent = parent;
 		parent = value;
 
+		if (prevParent != nullptr)
+			prevParent->markSubtreeChanged();
+		markSubtreeChanged();
+
 		if (gameObject != nullptr)
 		{
 			if (parent != nullptr)
@@ -200,9 +204,17 @@ namespace GX
 				VectorUtils::move(children, ii1, index);
 		}
 
+		markSubtreeChanged();
+
 		Engine::getSingleton()->markGameObjectsOutdated();
 	}
 
+	void Transform::markSubtreeChanged()
+	{
+		for (Transform* t = this; t != nullptr; t = t->parent)
+			++t->subtreeVersion;
+	}
+
 	Transform* Transform::getChild(int index)
 	{
 		if (index < children.size())
@@ -448,6 +460,25 @@ namespace GX
 			setTransformMatrix(value);
 	}
 
+	void Transform::setLocalTransform(glm::vec3 position, glm::highp_quat rotation, glm::vec3 scale, bool updateChildren)
+	{
+		localPosition = position;
+		localRotation = rotation;
+		localScale = scale;
+
+		if (localScale.x == 0) localScale.x = 0.0001f;
+		if (localScale.y == 0) localScale.y = 0.0001f;
+		if (localScale.z == 0) localScale.z = 0.0001f;
+
+		needUpdateTransformMatrix = true;
+		needUpdateTransformMatrixInverse = true;
+
+		updateTransform();
+
+		if (updateChildren)
+			updateChildTransform();
+	}
+
 	void Transform::yaw(float degree, bool world)
 	{
 		rotate(glm::vec3(0, 1, 0), degree, world);
@@ -17,6 +17,7 @@ namespace GX
 		friend class Renderer;
 		friend class MeshRenderer;
 		friend class DecalRenderer;
+		friend class Animation;
 
 	private:
 		glm::vec3 position = glm::vec3(0, 0, 0);
@@ -30,6 +31,8 @@ namespace GX
 		Transform* parent = nullptr;
 		std::vector<Transform*> children;
 
+		uint32_t subtreeVersion = 0; //Changes when objects below are added, removed, reordered or renamed
+
 		bool needUpdateTransformMatrix = true;
 		bool needUpdateTransformMatrixInverse = true;
 		glm::mat4x4 cachedTransform = glm::identity<glm::mat4x4>();
@@ -56,6 +59,10 @@ namespace GX
 		void setChildIndex(Transform * child, int index);
 		Transform* getChild(int index);
 
+		//Increases subtree version of this transform and all its parents
+		void markSubtreeChanged();
+		uint32_t getSubtreeVersion() { return subtreeVersion; }
+
 		glm::vec3 getPosition();
 		glm::vec3 getLocalPosition();
 		glm::highp_quat getRotation();
@@ -80,6 +87,7 @@ namespace GX
 		void setLocalScale(glm::vec3 value, bool updateChildren = true);
 		void setTransformMatrix(glm::mat4x4 value);
 		void setLocalTransformMatrix(glm::mat4x4 value);
+		void setLocalTransform(glm::vec3 position, glm::highp_quat rotation, glm::vec3 scale, bool updateChildren = true);
 
 		void yaw(float degree, bool world = true);
 		void pitch(float degree, bool world = true);
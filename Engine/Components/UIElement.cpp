@@ -101,12 +101,12 @@ namespace GX
 		Transform* parent = getGameObject()->getTransform()->getParent();
 		if (parent != nullptr)
 		{
-			canvas = (Canvas*)parent->getGameObject()->getComponent(Canvas::COMPONENT_TYPE);
+			canvas = parent->getGameObject()->getComponent<Canvas>();
 			while (parent != nullptr && canvas == nullptr)
 			{
 				parent = parent->getParent();
 				if (parent != nullptr)
-					canvas = (Canvas*)parent->getGameObject()->getComponent(Canvas::COMPONENT_TYPE);
+					canvas = parent->getGameObject()->getComponent<Canvas>();
 			}
 		}
 		else
@@ -83,7 +83,7 @@ namespace GX
 
 		if (Engine::getSingleton()->getIsRuntimeMode())
 		{
-			RigidBody* body = (RigidBody*)getGameObject()->getComponent(RigidBody::COMPONENT_TYPE);
+			RigidBody* body = getGameObject()->getComponent<RigidBody>();
 
 			if (body != nullptr)
 			{
@@ -218,7 +218,7 @@ namespace GX
 
 		bool active = getEnabled() && gameObject->getActive();
 
-		RigidBody* body = (RigidBody*)gameObject->getComponent(RigidBody::COMPONENT_TYPE);
+		RigidBody* body = gameObject->getComponent<RigidBody>();
 
 		if (active)
 		{
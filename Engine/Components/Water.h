@@ -75,6 +75,7 @@ namespace GX
         virtual bool isTransparent() { return false; }
         virtual void onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback);
         virtual bool checkCullingMask(LayerMask& mask);
+        virtual Material* getSortMaterial() { return material; }
         virtual void onAttach();
         virtual void onDetach();
         virtual Component* onClone();
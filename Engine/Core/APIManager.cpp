@@ -13,6 +13,8 @@
 #include "../../Mono/include/mono/metadata/class.h"
 #include "../../Mono/include/mono/metadata/mono-gc.h"
 #include "../../Mono/include/mono/metadata/attrdefs.h"
+#include "../../Mono/include/mono/metadata/metadata.h"
+#include "../../Mono/include/mono/metadata/loader.h"
 
 #include "../Classes/IO.h"
 #include "../Classes/StringConverter.h"
@@ -99,6 +101,12 @@
 
 #define BUFSIZE 4096
 
+#ifdef _WIN32
+#define THUNK_CALL __stdcall
+#else
+#define THUNK_CALL
+#endif
+
 namespace GX
 {
 	APIManager APIManager::singleton;
@@ -195,6 +203,8 @@ namespace GX
 					script->managedClassName = classList[script];
 					script->managedClass = findClass(script->managedClassName);
 					script->createManagedObject();
+
+					updateScriptRegistration(script);
 				}
 
 				for (auto it = classList.begin(); it != classList.end(); ++it)
@@ -225,7 +235,7 @@ namespace GX
 	{
 		if (Engine::getSingleton()->getIsRuntimeMode())
 		{
-			execute("Update");
+			executeCallback(ScriptCallback::Update);
 
 			destroyNodes();
 			checkSceneToLoad();
@@ -242,7 +252,7 @@ namespace GX
 
 			while (fixedTimeSimulated < currentTime)
 			{
-				execute("FixedUpdate");
+				executeCallback(ScriptCallback::FixedUpdate);
 				fixedTimeSimulated += fixedTimeStep;
 			}
 		}
@@ -675,6 +685,8 @@ namespace GX
 			mono_thread_attach(domain);
 
 		behaviourClasses.clear();
+		methodCache.clear();
+		clearScriptCallbacks();
 		
 		cleanup();
 
@@ -1029,52 +1041,87 @@ namespace GX
 		if (object == nullptr)
 			return;
 
-		//Build a method description object
-		MonoClass* mclass = mono_object_get_class(object);
-		std::string class_name = mono_class_get_name(mclass);
-		class_name = CP_SYS(class_name);
+		CachedMethod& cached = getCachedMethod(mono_object_get_class(object), methodName, stringParams);
 
-		std::string methodDescStr = std::string(class_name + ":" + methodName + "(" + stringParams + ")").c_str();
-		MonoMethodDesc*  methodDesc = mono_method_desc_new(methodDescStr.c_str(), false);
+		if (cached.method == nullptr)
+			return;
 
-		MonoMethod* method = nullptr;
+		if (cached.thunk != nullptr && params == nullptr)
+		{
+			typedef void (THUNK_CALL *MethodThunk)(MonoObject* obj, MonoException** exc);
 
-		if (methodDesc != nullptr)
+			MonoException* except = nullptr;
+			((MethodThunk)cached.thunk)(object, &except);
+
+			if (except != nullptr)
+				reportException((MonoObject*)except);
+		}
+		else
 		{
-			//Search the method in the image
-			method = mono_method_desc_search_in_class(methodDesc, mclass);
-			mono_method_desc_free(methodDesc);
+			MonoObject* except = nullptr;
+			mono_runtime_invoke(cached.method, object, params, (MonoObject**)&except);
+
+			if (except != nullptr)
+				reportException(except);
 		}
+	}
+
+	APIManager::CachedMethod& APIManager::getCachedMethod(MonoClass* klass, const std::string& methodName, const std::string& stringParams)
+	{
+		auto& classMethods = methodCache[klass];
+
+		auto it = stringParams.empty() ? classMethods.find(methodName) : classMethods.find(methodName + "(" + stringParams + ")");
+		if (it != classMethods.end())
+			return it->second;
 
-		while (method == nullptr)
+		CachedMethod cached;
+		cached.method = searchMethod(klass, methodName, stringParams);
+
+		if (cached.method != nullptr)
 		{
-			mclass = mono_class_get_parent(mclass);
+			//Thunks are only used for "void Method()" callbacks like Update and FixedUpdate
+			MonoMethodSignature* sig = mono_method_signature(cached.method);
+			if (sig != nullptr && mono_signature_get_param_count(sig) == 0 &&
+				mono_type_get_type(mono_signature_get_return_type(sig)) == MONO_TYPE_VOID)
+			{
+				cached.thunk = mono_method_get_unmanaged_thunk(cached.method);
+			}
+		}
 
-			if (mclass == nullptr)
-				break;
+		std::string key = stringParams.empty() ? methodName : methodName + "(" + stringParams + ")";
+		classMethods[key] = cached;
 
-			class_name = mono_class_get_name(mclass);
+		return classMethods[key];
+	}
+
+	MonoMethod* APIManager::searchMethod(MonoClass* klass, const std::string& methodName, const std::string& stringParams)
+	{
+		MonoClass* mclass = klass;
+		MonoMethod* method = nullptr;
+
+		while (mclass != nullptr)
+		{
+			//Build a method description object
+			std::string class_name = mono_class_get_name(mclass);
 			class_name = CP_SYS(class_name);
 
-			methodDescStr = std::string(class_name + ":" + methodName + "(" + stringParams + ")").c_str();
-			methodDesc = mono_method_desc_new(methodDescStr.c_str(), false);
+			std::string methodDescStr = class_name + ":" + methodName + "(" + stringParams + ")";
+			MonoMethodDesc* methodDesc = mono_method_desc_new(methodDescStr.c_str(), false);
 
-			if (methodDesc)
+			if (methodDesc != nullptr)
 			{
 				//Search the method in the image
 				method = mono_method_desc_search_in_class(methodDesc, mclass);
 				mono_method_desc_free(methodDesc);
 			}
-		}
 
-		if (method != nullptr)
-		{
-			MonoObject* except = nullptr;
-			mono_runtime_invoke(method, object, params, (MonoObject**)&except);
+			if (method != nullptr)
+				break;
 
-			if (except != nullptr)
-				reportException(except);
+			mclass = mono_class_get_parent(mclass);
 		}
+
+		return method;
 	}
 
 	void APIManager::executeStatic(MonoClass* klass, std::string methodName, void** params)
@@ -1099,6 +1146,173 @@ namespace GX
 		}
 	}
 
+	const std::string& APIManager::getCallbackName(ScriptCallback callback)
+	{
+		static const std::string names[(int)ScriptCallback::Count] = { "Update", "FixedUpdate" };
+
+		return names[(int)callback];
+	}
+
+	//Same rules as the hierarchy walk: objects under an inactive or destroyed parent are skipped
+	static bool isExecutable(GameObject* obj)
+	{
+		for (Transform* t = obj->getTransform(); t != nullptr; t = t->getParent())
+		{
+			GameObject* o = t->getGameObject();
+			if (o->destroyPending || !o->getActive())
+				return false;
+		}
+
+		return true;
+	}
+
+	void APIManager::updateScriptRegistration(MonoScript* script)
+	{
+		uint8_t callbacks = 0;
+
+		if (script->isAttached() && script->getEnabled() && script->managedClass != nullptr && script->managedObject != nullptr)
+		{
+			if (script->gameObject != nullptr && isExecutable(script->gameObject))
+			{
+				for (int i = 0; i < (int)ScriptCallback::Count; ++i)
+				{
+					if (getCachedMethod(script->managedClass, getCallbackName((ScriptCallback)i), "").method != nullptr)
+						callbacks |= (1 << i);
+				}
+			}
+		}
+
+		if (callbacks == script->registeredCallbacks)
+			return;
+
+		if (script->registrationOrder == 0)
+			script->registrationOrder = ++scriptRegistrationCounter;
+
+		for (int i = 0; i < (int)ScriptCallback::Count; ++i)
+		{
+			bool registered = (script->registeredCallbacks & (1 << i)) != 0;
+			bool required = (callbacks & (1 << i)) != 0;
+
+			if (required && !registered)
+				addToCallbackList(scriptCallbacks[i], script);
+			else if (!required && registered)
+				removeFromCallbackList(scriptCallbacks[i], script);
+		}
+
+		script->registeredCallbacks = callbacks;
+	}
+
+	void APIManager::unregisterScript(MonoScript* script)
+	{
+		if (script->registeredCallbacks == 0)
+			return;
+
+		for (int i = 0; i < (int)ScriptCallback::Count; ++i)
+		{
+			if (script->registeredCallbacks & (1 << i))
+				removeFromCallbackList(scriptCallbacks[i], script);
+		}
+
+		script->registeredCallbacks = 0;
+	}
+
+	void APIManager::addToCallbackList(ScriptCallbackList& list, MonoScript* script)
+	{
+		if (list.executing)
+		{
+			list.pending.push_back(script);
+			return;
+		}
+
+		auto it = std::lower_bound(list.scripts.begin(), list.scripts.end(), script, [](MonoScript* a, MonoScript* b) -> bool
+			{
+				return a->registrationOrder < b->registrationOrder;
+			}
+		);
+
+		list.scripts.insert(it, script);
+	}
+
+	void APIManager::removeFromCallbackList(ScriptCallbackList& list, MonoScript* script)
+	{
+		auto pt = std::find(list.pending.begin(), list.pending.end(), script);
+		if (pt != list.pending.end())
+		{
+			list.pending.erase(pt);
+			return;
+		}
+
+		auto it = std::find(list.scripts.begin(), list.scripts.end(), script);
+		if (it == list.scripts.end())
+			return;
+
+		//Keep indices stable while the list is being executed
+		if (list.executing)
+		{
+			*it = nullptr;
+			list.hasRemoved = true;
+		}
+		else
+			list.scripts.erase(it);
+	}
+
+	void APIManager::executeCallback(ScriptCallback callback)
+	{
+		if (Scene::getLoadedScene().empty())
+			return;
+
+		ScriptCallbackList& list = scriptCallbacks[(int)callback];
+		const std::string& methodName = getCallbackName(callback);
+
+		list.executing = true;
+
+		for (size_t i = 0; i < list.scripts.size(); ++i)
+		{
+			MonoScript* script = list.scripts[i];
+
+			if (script == nullptr)
+				continue;
+
+			execute(script->managedObject, methodName);
+		}
+
+		list.executing = false;
+
+		if (list.hasRemoved)
+		{
+			list.scripts.erase(std::remove(list.scripts.begin(), list.scripts.end(), nullptr), list.scripts.end());
+			list.hasRemoved = false;
+		}
+
+		if (list.pending.size() > 0)
+		{
+			std::vector<MonoScript*> pending = list.pending;
+			list.pending.clear();
+
+			for (auto* script : pending)
+				addToCallbackList(list, script);
+		}
+	}
+
+	void APIManager::clearScriptCallbacks()
+	{
+		for (int i = 0; i < (int)ScriptCallback::Count; ++i)
+		{
+			for (auto* script : scriptCallbacks[i].scripts)
+			{
+				if (script != nullptr)
+					script->registeredCallbacks = 0;
+			}
+
+			for (auto* script : scriptCallbacks[i].pending)
+				script->registeredCallbacks = 0;
+
+			scriptCallbacks[i].scripts.clear();
+			scriptCallbacks[i].pending.clear();
+			scriptCallbacks[i].hasRemoved = false;
+		}
+	}
+
 	void APIManager::destroyNodes()
 	{
 		for (auto it = objectsToDestroy.begin(); it != objectsToDestroy.end(); ++it)
@@ -1119,12 +1333,33 @@ namespace GX
 			GameObject* obj = *it;
 			std::vector<MonoScript*> scripts = obj->getMonoScripts();
 			for (auto ct = scripts.begin(); ct != scripts.end(); ++ct)
+			{
 				(*ct)->createManagedObject();
+				updateScriptRegistration(*ct);
+			}
 		}
 	}
 
 	void APIManager::addDestroyObject(GameObject* node)
 	{
+		//Scripts of the object and its children stop receiving callbacks right away
+		std::vector<Transform*> nstack = { node->getTransform() };
+		while (nstack.size() > 0)
+		{
+			Transform* t = nstack.back();
+			nstack.pop_back();
+
+			GameObject* obj = t->getGameObject();
+			obj->destroyPending = true;
+
+			std::vector<MonoScript*> scripts = obj->getMonoScripts();
+			for (auto* script : scripts)
+				updateScriptRegistration(script);
+
+			for (auto* child : t->children)
+				nstack.push_back(child);
+		}
+
 		if (std::find(objectsToDestroy.begin(), objectsToDestroy.end(), node) == objectsToDestroy.end())
 			objectsToDestroy.push_back(node);
 	}
@@ -6,6 +6,7 @@
 #include <vector>
 #include <functional>
 #include <map>
+#include <unordered_map>
 
 namespace GX
 {
@@ -19,6 +20,7 @@ namespace GX
 
 	public:
 		enum CompileConfiguration { Debug, Release };
+		enum class ScriptCallback { Update, FixedUpdate, Count };
 
 	private:
 		static APIManager singleton;
@@ -39,6 +41,38 @@ namespace GX
 
 		std::vector<MonoClass*> behaviourClasses;
 
+		//Resolved methods per class. Missing methods are cached as nullptr so scripts without a callback are skipped
+		struct CachedMethod
+		{
+		public:
+			MonoMethod* method = nullptr;
+			void* thunk = nullptr; //Unmanaged thunk for parameterless void methods
+		};
+
+		std::unordered_map<MonoClass*, std::unordered_map<std::string, CachedMethod>> methodCache;
+
+		CachedMethod& getCachedMethod(MonoClass* klass, const std::string& methodName, const std::string& stringParams);
+		MonoMethod* searchMethod(MonoClass* klass, const std::string& methodName, const std::string& stringParams);
+
+		//Enabled scripts implementing each callback, sorted by registration order
+		struct ScriptCallbackList
+		{
+		public:
+			std::vector<MonoScript*> scripts;
+			std::vector<MonoScript*> pending; //Scripts added while the list is being executed
+			bool executing = false;
+			bool hasRemoved = false;
+		};
+
+		ScriptCallbackList scriptCallbacks[(int)ScriptCallback::Count];
+		uint64_t scriptRegistrationCounter = 0;
+
+		static const std::string& getCallbackName(ScriptCallback callback);
+		void addToCallbackList(ScriptCallbackList& list, MonoScript* script);
+		void removeFromCallbackList(ScriptCallbackList& list, MonoScript* script);
+		void executeCallback(ScriptCallback callback);
+		void clearScriptCallbacks();
+
 		std::string getStringProperty(const char *propertyName, MonoClass *classType, MonoObject *classObject);
 		void retrieveClassesAndFields();
 
@@ -90,6 +124,8 @@ namespace GX
 		void executeForNode(GameObject* node, std::string methodName, std::string className = "", void** params = nullptr, std::string stringParams = "");
 		void execute(MonoObject* object, std::string methodName, void** params = nullptr, std::string stringParams = "");
 		void executeStatic(MonoClass* klass, std::string methodName, void** params = nullptr);
+		void updateScriptRegistration(MonoScript* script); //Adds or removes the script from callback lists depending on its state
+		void unregisterScript(MonoScript* script);
 		void setLogCallback(std::function<void(std::string)> callback) { logCallback = callback; }
 		void setBeginCompileCallback(std::function<void()> callback) { beginCompileCallback = callback; }
 		void setEndCompileCallback(std::function<void()> callback) { endCompileCallback = callback; }
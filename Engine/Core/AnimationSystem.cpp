@@ -0,0 +1,159 @@
+#include "AnimationSystem.h"
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "../Components/Transform.h"
+#include "../Components/Animation.h"
+#include "../Components/MeshRenderer.h"
+#include "../Assets/Mesh.h"
+
+namespace GX
+{
+	AnimationSystem AnimationSystem::singleton;
+
+	AnimationSystem::AnimationSystem()
+	{
+
+	}
+
+	AnimationSystem::~AnimationSystem()
+	{
+
+	}
+
+	void AnimationSystem::addAnimation(Animation* animation)
+	{
+		if (std::find(animations.begin(), animations.end(), animation) == animations.end())
+			animations.push_back(animation);
+	}
+
+	void AnimationSystem::removeAnimation(Animation* animation)
+	{
+		auto it = std::find(animations.begin(), animations.end(), animation);
+		if (it != animations.end())
+			animations.erase(it);
+	}
+
+	void AnimationSystem::addMeshRenderer(MeshRenderer* meshRenderer)
+	{
+		if (std::find(meshRenderers.begin(), meshRenderers.end(), meshRenderer) == meshRenderers.end())
+			meshRenderers.push_back(meshRenderer);
+	}
+
+	void AnimationSystem::removeMeshRenderer(MeshRenderer* meshRenderer)
+	{
+		auto it = std::find(meshRenderers.begin(), meshRenderers.end(), meshRenderer);
+		if (it != meshRenderers.end())
+			meshRenderers.erase(it);
+	}
+
+	void AnimationSystem::update(float deltaTime)
+	{
+		++frame;
+
+		updateAnimations(deltaTime);
+		updateSkinning();
+	}
+
+	void AnimationSystem::updateAnimations(float deltaTime)
+	{
+		std::vector<Animation*> active;
+		std::unordered_set<GameObject*> owners;
+
+		for (auto& anim : animations)
+		{
+			GameObject* obj = anim->getGameObject();
+			if (obj == nullptr || !obj->getActive() || !anim->getEnabled())
+				continue;
+
+			active.push_back(anim);
+			owners.insert(obj);
+		}
+
+		if (active.empty())
+			return;
+
+		//Animations placed inside another animated hierarchy change the same transforms.
+		//They run after the parallel part, parents first
+		std::vector<Animation*> independent;
+		std::vector<std::pair<int, Animation*>> nested;
+
+		for (auto& anim : active)
+		{
+			int depth = 0;
+			bool isNested = false;
+
+			for (Transform* t = anim->getGameObject()->getTransform()->getParent(); t != nullptr; t = t->getParent())
+			{
+				++depth;
+				if (owners.find(t->getGameObject()) != owners.end())
+					isNested = true;
+			}
+
+			if (isNested)
+				nested.push_back(std::make_pair(depth, anim));
+			else
+				independent.push_back(anim);
+		}
+
+		JobSystem::getSingleton()->parallelFor(independent.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					independent[i]->update(deltaTime);
+			}
+		);
+
+		std::stable_sort(nested.begin(), nested.end(), [](const std::pair<int, Animation*>& a, const std::pair<int, Animation*>& b) -> bool
+			{
+				return a.first < b.first;
+			}
+		);
+
+		for (auto& n : nested)
+			n.second->update(deltaTime);
+
+		//Scripts are not thread safe
+		for (auto& anim : active)
+			anim->dispatchEvents();
+	}
+
+	void AnimationSystem::updateSkinning()
+	{
+		//Renderers skinned to the same root read the same bone transforms and are processed by one job
+		std::vector<std::vector<MeshRenderer*>> groups;
+		std::unordered_map<GameObject*, size_t> groupIndices;
+
+		for (auto& mr : meshRenderers)
+		{
+			GameObject* obj = mr->getGameObject();
+			if (obj == nullptr || !obj->getActive() || !mr->getEnabled())
+				continue;
+
+			if (!mr->is_skinned || mr->rootObject == nullptr || mr->mesh == nullptr || !mr->mesh->isLoaded())
+				continue;
+
+			auto it = groupIndices.find(mr->rootObject);
+			if (it == groupIndices.end())
+			{
+				groupIndices[mr->rootObject] = groups.size();
+				groups.push_back({ mr });
+			}
+			else
+				groups[it->second].push_back(mr);
+		}
+
+		JobSystem::getSingleton()->parallelFor(groups.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+				{
+					for (auto& mr : groups[i])
+						mr->updateBonePalette();
+				}
+			}
+		);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace GX
+{
+	class Animation;
+	class MeshRenderer;
+
+	//Evaluates animations and skinning matrices of all characters once per frame, before any pass is rendered.
+	//Characters do not share transforms, so each one is processed as a separate job
+	class AnimationSystem
+	{
+	private:
+		static AnimationSystem singleton;
+
+		std::vector<Animation*> animations;
+		std::vector<MeshRenderer*> meshRenderers;
+
+		uint32_t frame = 0;
+
+		void updateAnimations(float deltaTime);
+		void updateSkinning();
+
+	public:
+		AnimationSystem();
+		~AnimationSystem();
+
+		static AnimationSystem* getSingleton() { return &singleton; }
+
+		void addAnimation(Animation* animation);
+		void removeAnimation(Animation* animation);
+
+		void addMeshRenderer(MeshRenderer* meshRenderer);
+		void removeMeshRenderer(MeshRenderer* meshRenderer);
+
+		//Called once per frame on the main thread
+		void update(float deltaTime);
+
+		//Skinning matrices computed during this frame are up to date
+		uint32_t getFrame() { return frame; }
+	};
+}
@@ -0,0 +1,134 @@
+#include "AsyncLoader.h"
+
+#include <algorithm>
+#include <bx/timer.h>
+
+#include "../Assets/Asset.h"
+
+namespace GX
+{
+	AsyncLoader AsyncLoader::singleton;
+
+	AsyncLoader::AsyncLoader()
+	{
+
+	}
+
+	AsyncLoader::~AsyncLoader()
+	{
+
+	}
+
+	std::vector<std::shared_ptr<AsyncLoader::Request>>::iterator AsyncLoader::findRequest(Asset* asset)
+	{
+		return std::find_if(requests.begin(), requests.end(), [asset](std::shared_ptr<Request>& req) -> bool { return req->asset == asset; });
+	}
+
+	void AsyncLoader::finishRequest(std::shared_ptr<Request> request, bool runUpload)
+	{
+		//Lets the worker part stop early instead of finishing work that will be dropped
+		if (!runUpload)
+			request->asset->loadingCancelled = true;
+
+		JobSystem::getSingleton()->wait(request->job);
+
+		request->asset->loading = false;
+		request->asset->loadingCancelled = false;
+
+		if (runUpload && request->upload != nullptr)
+			request->upload();
+	}
+
+	void AsyncLoader::schedule(Asset* asset, std::function<void()> work, std::function<void()> upload)
+	{
+		std::shared_ptr<Request> request = std::make_shared<Request>();
+		request->asset = asset;
+		request->upload = upload;
+
+		asset->loading = true;
+		requests.push_back(request);
+
+		request->job = JobSystem::getSingleton()->schedule(work);
+	}
+
+	void AsyncLoader::processUploads()
+	{
+		if (requests.empty())
+			return;
+
+		int64_t start = bx::getHPCounter();
+		double toMs = 1000.0 / double(bx::getHPFrequency());
+
+		for (size_t i = 0; i < requests.size();)
+		{
+			std::shared_ptr<Request> request = requests[i];
+
+			if (!request->job.isDone())
+			{
+				++i;
+				continue;
+			}
+
+			requests.erase(requests.begin() + i);
+			finishRequest(request, true);
+
+			//At least one upload is done every frame so loading always progresses
+			if (double(bx::getHPCounter() - start) * toMs >= uploadTimeBudget)
+				break;
+		}
+	}
+
+	void AsyncLoader::wait(Asset* asset)
+	{
+		auto it = findRequest(asset);
+		if (it == requests.end())
+			return;
+
+		std::shared_ptr<Request> request = *it;
+		requests.erase(it);
+
+		finishRequest(request, true);
+	}
+
+	void AsyncLoader::waitAll()
+	{
+		while (!requests.empty())
+		{
+			std::shared_ptr<Request> request = requests.front();
+			requests.erase(requests.begin());
+
+			finishRequest(request, true);
+		}
+	}
+
+	void AsyncLoader::cancel(Asset* asset)
+	{
+		auto it = findRequest(asset);
+		if (it == requests.end())
+			return;
+
+		std::shared_ptr<Request> request = *it;
+		requests.erase(it);
+
+		finishRequest(request, false);
+	}
+
+	std::vector<Asset*> AsyncLoader::getPendingAssets()
+	{
+		std::vector<Asset*> assets;
+		assets.reserve(requests.size());
+
+		for (auto& request : requests)
+			assets.push_back(request->asset);
+
+		return assets;
+	}
+
+	void AsyncLoader::cancelAll()
+	{
+		for (auto& request : requests)
+			finishRequest(request, false);
+
+		requests.clear();
+	}
+}
\ No newline at end of file
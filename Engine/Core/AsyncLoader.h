@@ -0,0 +1,64 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "JobSystem.h"
+
+namespace GX
+{
+	class Asset;
+
+	//Loads assets in two stages. Reading and decoding runs on job threads,
+	//GPU resources are created on the main thread within a per frame time budget
+	class AsyncLoader
+	{
+	private:
+		struct Request
+		{
+		public:
+			Asset* asset = nullptr;
+			std::function<void()> upload = nullptr;
+			JobHandle job;
+		};
+
+		static AsyncLoader singleton;
+
+		std::vector<std::shared_ptr<Request>> requests;
+		float uploadTimeBudget = 2.0f;
+
+		std::vector<std::shared_ptr<Request>>::iterator findRequest(Asset* asset);
+		void finishRequest(std::shared_ptr<Request> request, bool runUpload);
+
+	public:
+		AsyncLoader();
+		~AsyncLoader();
+
+		static AsyncLoader* getSingleton() { return &singleton; }
+
+		//Must be called from the main thread. Asset stays in loading state until upload is done
+		void schedule(Asset* asset, std::function<void()> work, std::function<void()> upload);
+
+		//Runs uploads of finished requests until the time budget is exceeded. Called once per frame
+		void processUploads();
+
+		//Blocks until the asset is fully loaded
+		void wait(Asset* asset);
+		void waitAll();
+
+		//Waits for the worker part and drops the upload. Used when asset is destroyed while loading
+		void cancel(Asset* asset);
+		void cancelAll();
+
+		//Assets of all requests that are not finished yet, in request order
+		std::vector<Asset*> getPendingAssets();
+
+		bool isBusy() { return !requests.empty(); }
+		int getNumPending() { return (int)requests.size(); }
+
+		//Milliseconds per frame
+		float getUploadTimeBudget() { return uploadTimeBudget; }
+		void setUploadTimeBudget(float value) { uploadTimeBudget = value; }
+	};
+}
\ No newline at end of file
@@ -13,8 +13,10 @@
 
 #include "Renderer/Renderer.h"
 #include "Classes/VectorUtils.h"
+#include "Classes/Hash.h"
 #include "Classes/IO.h"
 #include "Classes/StringConverter.h"
+#include "Classes/ZipHelper.h"
 #include "Assets/Asset.h"
 #include "Core/Debug.h"
 
@@ -42,7 +44,10 @@ namespace GX
         clear();
 
         for (auto& it : zipArchives)
+        {
+            ZipHelper::unmapArchive(it.second);
             zip_close_z(it.second);
+        }
 
         zipArchives.clear();
     }
@@ -65,7 +70,10 @@ namespace GX
                 Debug::logError(std::string(buf));
             }
             else
+            {
                 zipArchives[path] = za;
+                ZipHelper::mapArchive(za, _path);
+            }
         }
     }
 
@@ -257,7 +265,7 @@ namespace GX
 
             //
             GameObject* obj = child->gameObject;
-            Animation* anim = (Animation*)obj->getComponent(Animation::COMPONENT_TYPE);
+            Animation* anim = obj->getComponent<Animation>();
             if (anim != nullptr)
                 anim->stop();
             //
@@ -281,7 +289,7 @@ namespace GX
             GameObject* child = *nstack.begin();
             nstack.erase(nstack.begin());
 
-            Animation* anim = (Animation*)child->getComponent(Animation::COMPONENT_TYPE);
+            Animation* anim = child->getComponent<Animation>();
             if (anim != nullptr)
                 anim->stop();
 
@@ -348,140 +356,208 @@ namespace GX
         markGameObjectsOutdated();
     }
 
-    GameObject* Engine::getGameObject(std::string guid)
+    void Engine::registerGameObject(GameObject* gameObject)
     {
-        GameObject* result = nullptr;
+        if (gameObject->registered)
+            return;
 
-        auto& gameObjects = getGameObjects();
+        gameObjectsByGuid.insert(std::make_pair(gameObject->guidHash, gameObject));
+        gameObjectsByName.insert(std::make_pair(gameObject->nameHash, gameObject));
 
-        for (auto& obj : gameObjects)
+        gameObject->registered = true;
+    }
+
+    void Engine::unregisterGameObject(GameObject* gameObject)
+    {
+        if (!gameObject->registered)
+            return;
+
+        auto guidRange = gameObjectsByGuid.equal_range(gameObject->guidHash);
+        for (auto gt = guidRange.first; gt != guidRange.second; ++gt)
         {
-            if (obj->getGuid() == guid)
+            if (gt->second == gameObject)
             {
-                result = obj;
+                gameObjectsByGuid.erase(gt);
                 break;
             }
         }
 
-        return result;
-    }
-
-    GameObject* Engine::getGameObject(size_t guidHash)
-    {
-        GameObject* result = nullptr;
-
-        auto& gameObjects = getGameObjects();
-
-        for (auto& obj : gameObjects)
+        auto range = gameObjectsByName.equal_range(gameObject->nameHash);
+        for (auto nt = range.first; nt != range.second; ++nt)
         {
-            if (obj->getGuidHash() == guidHash)
+            if (nt->second == gameObject)
             {
-                result = obj;
+                gameObjectsByName.erase(nt);
                 break;
             }
         }
 
-        return result;
+        gameObject->registered = false;
+
+        if (gameObject->getTransform() != nullptr)
+            gameObject->getTransform()->markSubtreeChanged();
     }
 
-    GameObject* Engine::findGameObject(std::string name)
+    void Engine::onGameObjectRenamed(GameObject* gameObject, size_t oldNameHash)
     {
-        GameObject* result = nullptr;
-
-        auto& gameObjects = getGameObjects();
-
-        for (auto& obj : gameObjects)
+        auto range = gameObjectsByName.equal_range(oldNameHash);
+        for (auto it = range.first; it != range.second; ++it)
         {
-            if (obj->getName() == name)
+            if (it->second == gameObject)
             {
-                result = obj;
+                gameObjectsByName.erase(it);
                 break;
             }
         }
 
-        return result;
+        gameObjectsByName.insert(std::make_pair(gameObject->nameHash, gameObject));
+
+        gameObject->getTransform()->markSubtreeChanged();
     }
 
-    GameObject* Engine::findGameObject(size_t nameHash)
+    void Engine::onGameObjectGuidChanged(GameObject* gameObject, size_t oldGuidHash)
     {
-        GameObject* result = nullptr;
-
-        auto& gameObjects = getGameObjects();
-
-        for (auto& obj : gameObjects)
+        auto range = gameObjectsByGuid.equal_range(oldGuidHash);
+        for (auto it = range.first; it != range.second; ++it)
         {
-            if (obj->getNameHash() == nameHash)
+            if (it->second == gameObject)
             {
-                result = obj;
+                gameObjectsByGuid.erase(it);
                 break;
             }
         }
 
-        return result;
+        gameObjectsByGuid.insert(std::make_pair(gameObject->guidHash, gameObject));
     }
 
-    GameObject* Engine::findGameObject(std::string name, GameObject* root)
+    GameObject* Engine::getGameObject(std::string guid)
     {
-        GameObject * result = nullptr;
+        return findGameObjectByGuidHash(Hash::getHash(guid), &guid);
+    }
 
-        std::vector<GameObject*> nstack;
-        nstack.push_back(root);
+    GameObject* Engine::getGameObject(size_t guidHash)
+    {
+        return findGameObjectByGuidHash(guidHash, nullptr);
+    }
 
-        while (nstack.size() > 0)
+    GameObject* Engine::findGameObjectByGuidHash(size_t guidHash, const std::string* guid)
+    {
+        //A unique guid is returned directly.
+        //If several objects share it, the first one in the object list is returned as before
+        GameObject* result = nullptr;
+        int numMatches = 0;
+
+        auto range = gameObjectsByGuid.equal_range(guidHash);
+        for (auto it = range.first; it != range.second; ++it)
         {
-            GameObject* child = *nstack.begin();
-            nstack.erase(nstack.begin());
+            GameObject* obj = it->second;
 
-            if (child->getName() == name)
-            {
-                result = child;
-                nstack.clear();
+            if (guid != nullptr && obj->getGuid() != *guid)
+                continue;
+
+            result = obj;
+            ++numMatches;
+
+            if (numMatches > 1)
                 break;
-            }
+        }
 
-            std::vector<Transform*>& children = child->getTransform()->getChildren();
+        if (numMatches < 2)
+            return result;
 
-            int j = 0;
-            for (auto it = children.begin(); it != children.end(); ++it, ++j)
-            {
-                Transform* ch = *it;
-                nstack.insert(nstack.begin() + j, ch->getGameObject());
-            }
+        auto& objects = getGameObjects();
+        for (auto& obj : objects)
+        {
+            if (obj->getGuidHash() != guidHash)
+                continue;
+
+            if (guid != nullptr && obj->getGuid() != *guid)
+                continue;
+
+            return obj;
         }
 
-        return result;
+        return nullptr;
+    }
+
+    GameObject* Engine::findGameObject(std::string name)
+    {
+        return findGameObjectByNameHash(Hash::getHash(name), &name, nullptr);
+    }
+
+    GameObject* Engine::findGameObject(size_t nameHash)
+    {
+        return findGameObjectByNameHash(nameHash, nullptr, nullptr);
+    }
+
+    GameObject* Engine::findGameObject(std::string name, GameObject* root)
+    {
+        return findGameObjectByNameHash(Hash::getHash(name), &name, root);
     }
 
     GameObject* Engine::findGameObject(size_t nameHash, GameObject* root)
     {
+        return findGameObjectByNameHash(nameHash, nullptr, root);
+    }
+
+    GameObject* Engine::findGameObjectByNameHash(size_t nameHash, const std::string* name, GameObject* root)
+    {
+        //Objects with a unique name (within root) are returned directly.
+        //If several objects share the name, the first one in hierarchy order is returned as before
         GameObject* result = nullptr;
+        int numMatches = 0;
+
+        auto range = gameObjectsByName.equal_range(nameHash);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            GameObject* obj = it->second;
+
+            if (name != nullptr && obj->getName() != *name)
+                continue;
+
+            if (root != nullptr)
+            {
+                Transform* t = obj->getTransform();
+                while (t != nullptr && t != root->getTransform())
+                    t = t->getParent();
+
+                if (t == nullptr)
+                    continue;
+            }
+
+            result = obj;
+            ++numMatches;
+
+            if (numMatches > 1)
+                break;
+        }
+
+        if (numMatches < 2)
+            return result;
 
         std::vector<GameObject*> nstack;
-        nstack.push_back(root);
+        if (root != nullptr)
+            nstack.push_back(root);
+        else
+        {
+            for (auto it = rootTransforms.rbegin(); it != rootTransforms.rend(); ++it)
+                nstack.push_back((*it)->getGameObject());
+        }
 
         while (nstack.size() > 0)
         {
-            GameObject* child = *nstack.begin();
-            nstack.erase(nstack.begin());
+            GameObject* child = nstack.back();
+            nstack.pop_back();
 
-            if (child->getNameHash() == nameHash)
-            {
-                result = child;
-                nstack.clear();
-                break;
-            }
+            if (child->getNameHash() == nameHash && (name == nullptr || child->getName() == *name))
+                return child;
 
             std::vector<Transform*>& children = child->getTransform()->getChildren();
-
-            int j = 0;
-            for (auto it = children.begin(); it != children.end(); ++it, ++j)
-            {
-                Transform* ch = *it;
-                nstack.insert(nstack.begin() + j, ch->getGameObject());
-            }
+            for (auto it = children.rbegin(); it != children.rend(); ++it)
+                nstack.push_back((*it)->getGameObject());
         }
 
-        return result;
+        return nullptr;
     }
 
     int Engine::getGameObjectIndex(GameObject* obj)
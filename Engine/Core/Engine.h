@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include "../Serialization/Settings/ProjectSettings.h"
 
@@ -17,6 +18,7 @@ namespace GX
 	class Engine
 	{
 		friend class Window;
+		friend class GameObject;
 
 	private:
 		static Engine singleton;
@@ -46,6 +48,19 @@ namespace GX
 		std::vector<GameObject*> gameObjectCache;
 		bool needUpdateGameObjectCache = true;
 
+		//Lookup tables, updated when objects are created, destroyed or renamed.
+		//Guids are not always unique (additive scene loading), so both tables allow duplicates
+		std::unordered_multimap<size_t, GameObject*> gameObjectsByGuid;
+		std::unordered_multimap<size_t, GameObject*> gameObjectsByName;
+
+		void registerGameObject(GameObject* gameObject);
+		void unregisterGameObject(GameObject* gameObject);
+		void onGameObjectRenamed(GameObject* gameObject, size_t oldNameHash);
+		void onGameObjectGuidChanged(GameObject* gameObject, size_t oldGuidHash);
+		//Name and guid are optional, if set they are compared too, so hash collisions are skipped
+		GameObject* findGameObjectByNameHash(size_t nameHash, const std::string* name, GameObject* root);
+		GameObject* findGameObjectByGuidHash(size_t guidHash, const std::string* guid);
+
 	public:
 		Engine();
 		~Engine();
@@ -23,6 +23,8 @@ namespace GX
 
 		transform = new Transform();
 		addComponent(transform);
+
+		Engine::getSingleton()->registerGameObject(this);
 	}
 
 	GameObject::GameObject(std::string _guid)
@@ -33,10 +35,14 @@ namespace GX
 
 		transform = new Transform();
 		addComponent(transform);
+
+		Engine::getSingleton()->registerGameObject(this);
 	}
 
 	GameObject::~GameObject()
 	{
+		Engine::getSingleton()->unregisterGameObject(this);
+
 		//Delete components
 		while (components.size() > 0)
 		{
@@ -106,34 +112,72 @@ namespace GX
 
 	void GameObject::setName(std::string value)
 	{
+		size_t oldNameHash = nameHash;
+
 		name = value;
 		nameHash = Hash::getHash(name);
+
+		if (registered && oldNameHash != nameHash)
+			Engine::getSingleton()->onGameObjectRenamed(this, oldNameHash);
 	}
 
 	void GameObject::setGuid(std::string value)
 	{
+		size_t oldGuidHash = guidHash;
+
 		guid = value;
 		guidHash = Hash::getHash(guid);
+
+		if (registered && oldGuidHash != guidHash)
+			Engine::getSingleton()->onGameObjectGuidChanged(this, oldGuidHash);
 	}
 
 	Component* GameObject::getComponent(std::string type)
 	{
-		auto it = std::find_if(components.begin(), components.end(), [=](Component* comp) { return comp->getComponentType() == type; });
+		Component* comp = getComponentByTypeId(Component::findTypeId(type));
 
-		if (it != components.end())
-			return *it;
-		else
+		if (comp != nullptr)
+			return comp;
+
+		//Look for a script with this class name
+		MonoScript* script = getComponent<MonoScript>();
+		if (script != nullptr)
 		{
-			auto scripts = getMonoScripts();
-			auto it = std::find_if(scripts.begin(), scripts.end(), [=](MonoScript* comp) { return comp->getClassName() == type; });
+			for (auto it = components.begin(); it != components.end(); ++it)
+			{
+				if ((*it)->typeId == script->typeId && ((MonoScript*)*it)->getClassName() == type)
+					return *it;
+			}
+		}
+
+		return nullptr;
+	}
+
+	Component* GameObject::getComponentByTypeId(int typeId)
+	{
+		if (typeId < 0)
+			return nullptr;
+
+		if ((componentMask & (1ull << (typeId & 63))) == 0)
+			return nullptr;
 
-			if (it != scripts.end())
+		for (auto it = components.begin(); it != components.end(); ++it)
+		{
+			if ((*it)->typeId == typeId)
 				return *it;
 		}
 
 		return nullptr;
 	}
 
+	void GameObject::updateComponentMask()
+	{
+		componentMask = 0;
+
+		for (auto it = components.begin(); it != components.end(); ++it)
+			componentMask |= 1ull << ((*it)->typeId & 63);
+	}
+
 	Component* GameObject::getComponent(int index)
 	{
 		if (index < components.size())
@@ -145,9 +189,14 @@ namespace GX
 	std::vector<MonoScript*> GameObject::getMonoScripts()
 	{
 		std::vector<MonoScript*> lst;
+
+		static const int scriptTypeId = Component::getTypeId(MonoScript::COMPONENT_TYPE);
+		if ((componentMask & (1ull << (scriptTypeId & 63))) == 0)
+			return lst;
+
 		for (auto it = components.begin(); it != components.end(); ++it)
 		{
-			if ((*it)->getComponentType() == MonoScript::COMPONENT_TYPE)
+			if ((*it)->typeId == scriptTypeId)
 				lst.push_back((MonoScript*)*it);
 		}
 
@@ -161,6 +210,9 @@ namespace GX
 		component->gameObject = this;
 		components.push_back(component);
 
+		component->getComponentTypeId();
+		componentMask |= 1ull << (component->typeId & 63);
+
 		if (component->getComponentType() == RigidBody::COMPONENT_TYPE)
 			rigidBody = (RigidBody*)component;
 
@@ -180,6 +232,7 @@ namespace GX
 				rigidBody = nullptr;
 
 			components.erase(components.begin() + index);
+			updateComponentMask();
 
 			if (comp->isAttached())
 				comp->onDetach();
@@ -203,6 +256,8 @@ namespace GX
 			if (it != components.end())
 				components.erase(it);
 
+			updateComponentMask();
+
 			if (component->isAttached())
 				component->onDetach();
 
@@ -237,8 +292,7 @@ namespace GX
 			if (ret == nullptr)
 				ret = newObj;
 
-			newObj->name = obj->name;
-			newObj->nameHash = obj->nameHash;
+			newObj->setName(obj->name);
 			newObj->layer = obj->layer;
 			newObj->batchingStatic = obj->batchingStatic;
 			newObj->lightingStatic = obj->lightingStatic;
@@ -356,7 +410,7 @@ namespace GX
 	{
 		layer = value;
 
-		RigidBody* body = (RigidBody*)getComponent(RigidBody::COMPONENT_TYPE);
+		RigidBody* body = (RigidBody*)getComponent<RigidBody>();
 		if (body != nullptr)
 			body->updateCollisionMask();
 
@@ -374,7 +428,7 @@ namespace GX
 				//Update state
 				child->gameObject->layer = value;
 
-				body = (RigidBody*)child->gameObject->getComponent(RigidBody::COMPONENT_TYPE);
+				body = child->gameObject->getComponent<RigidBody>();
 				if (body != nullptr)
 					body->updateCollisionMask();
 				//
@@ -412,7 +466,7 @@ namespace GX
 	{
 		lightingStatic = value;
 
-		MeshRenderer* renderer = (MeshRenderer*)getComponent(MeshRenderer::COMPONENT_TYPE);
+		MeshRenderer* renderer = (MeshRenderer*)getComponent<MeshRenderer>();
 		if (renderer == nullptr)
 			return;
 
@@ -6,9 +6,10 @@
 #include <vector>
 #include <functional>
 
+#include "../Components/Component.h"
+
 namespace GX
 {
-	class Component;
 	class MonoScript;
 	class Transform;
 	class MeshRenderer;
@@ -18,6 +19,7 @@ namespace GX
 	{
 		friend class APIManager;
 		friend class Transform;
+		friend class Engine;
 
 	private:
 		std::vector<Component*> components;
@@ -38,6 +40,11 @@ namespace GX
 		bool lightingStatic = false;
 		bool batchingStatic = false;
 		bool occlusionStatic = false;
+		bool destroyPending = false; //Set by APIManager::addDestroyObject
+		bool registered = false; //Is in Engine lookup tables
+
+		uint64_t componentMask = 0; //Bit (typeId % 64) is set if a component of that type may be attached
+		void updateComponentMask();
 
 		MonoObject* managedObject = nullptr;
 		uint32_t managedGCHandle = 0;
@@ -60,6 +67,14 @@ namespace GX
 
 		Component* getComponent(std::string type);
 		Component* getComponent(int index);
+		Component* getComponentByTypeId(int typeId);
+
+		template<class T> T* getComponent()
+		{
+			static const int typeId = Component::getTypeId(T::COMPONENT_TYPE);
+			return (T*)getComponentByTypeId(typeId);
+		}
+
 		Transform* getTransform() { return transform; }
 		RigidBody* getRigidBody() { return rigidBody; }
 		std::vector<MonoScript*> getMonoScripts();
@@ -0,0 +1,194 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace GX
+{
+	JobSystem JobSystem::singleton;
+
+	struct ParallelForState
+	{
+	public:
+		std::function<void(size_t begin, size_t end)> job = nullptr;
+		size_t count = 0;
+		size_t grainSize = 1;
+		std::atomic<size_t> next = { 0 };
+		std::atomic<size_t> processed = { 0 };
+
+		void run()
+		{
+			while (true)
+			{
+				size_t begin = next.fetch_add(grainSize);
+				if (begin >= count)
+					break;
+
+				size_t end = std::min(begin + grainSize, count);
+				job(begin, end);
+				processed.fetch_add(end - begin);
+			}
+		}
+	};
+
+	JobSystem::JobSystem()
+	{
+
+	}
+
+	JobSystem::~JobSystem()
+	{
+		shutdown();
+	}
+
+	void JobSystem::init(int numThreads)
+	{
+		if (running)
+			return;
+
+		if (numThreads <= 0)
+		{
+			int hw = (int)std::thread::hardware_concurrency();
+			numThreads = std::max(hw - 1, 1);
+		}
+
+		running = true;
+
+		for (int i = 0; i < numThreads; ++i)
+			workers.push_back(std::thread([=]() { workerThread(); }));
+	}
+
+	void JobSystem::shutdown()
+	{
+		if (!running)
+			return;
+
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			running = false;
+		}
+
+		jobsCondition.notify_all();
+
+		for (auto& worker : workers)
+		{
+			if (worker.joinable())
+				worker.join();
+		}
+
+		workers.clear();
+		jobs.clear();
+	}
+
+	void JobSystem::workerThread()
+	{
+		while (true)
+		{
+			std::function<void()> job = nullptr;
+
+			{
+				std::unique_lock<std::mutex> lock(jobsMutex);
+				jobsCondition.wait(lock, [=]() { return !running || !jobs.empty(); });
+
+				if (!running && jobs.empty())
+					break;
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			job();
+		}
+	}
+
+	void JobSystem::push(std::function<void()> job)
+	{
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			jobs.push_back(std::move(job));
+		}
+
+		jobsCondition.notify_one();
+	}
+
+	bool JobSystem::runPendingJob()
+	{
+		std::function<void()> job = nullptr;
+
+		{
+			std::unique_lock<std::mutex> lock(jobsMutex);
+			if (jobs.empty())
+				return false;
+
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+
+		job();
+
+		return true;
+	}
+
+	JobHandle JobSystem::schedule(std::function<void()> job)
+	{
+		JobHandle handle;
+		handle.counter = std::make_shared<std::atomic<int>>(1);
+
+		if (!running)
+		{
+			job();
+			handle.counter->store(0);
+
+			return handle;
+		}
+
+		std::shared_ptr<std::atomic<int>> counter = handle.counter;
+		push([job, counter]()
+			{
+				job();
+				counter->fetch_sub(1);
+			}
+		);
+
+		return handle;
+	}
+
+	void JobSystem::wait(const JobHandle& handle)
+	{
+		//The awaited job is either queued and gets picked up here, or already runs on a worker
+		while (!handle.isDone())
+		{
+			if (!runPendingJob())
+				std::this_thread::yield();
+		}
+	}
+
+	void JobSystem::parallelFor(size_t count, size_t grainSize, std::function<void(size_t begin, size_t end)> job)
+	{
+		if (count == 0)
+			return;
+
+		grainSize = std::max(grainSize, (size_t)1);
+		size_t numRanges = (count + grainSize - 1) / grainSize;
+
+		if (!running || numRanges == 1)
+		{
+			job(0, count);
+			return;
+		}
+
+		std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+		state->job = job;
+		state->count = count;
+		state->grainSize = grainSize;
+
+		//Helpers which start after all ranges are taken exit immediately, so the caller never waits for busy workers
+		size_t numHelpers = std::min(numRanges - 1, workers.size());
+		for (size_t i = 0; i < numHelpers; ++i)
+			push([state]() { state->run(); });
+
+		state->run();
+
+		while (state->processed.load() < count)
+			std::this_thread::yield();
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GX
+{
+	class JobHandle
+	{
+		friend class JobSystem;
+
+	private:
+		std::shared_ptr<std::atomic<int>> counter = nullptr;
+
+	public:
+		JobHandle() = default;
+		~JobHandle() = default;
+
+		bool isValid() const { return counter != nullptr; }
+		bool isDone() const { return counter == nullptr || counter->load() == 0; }
+	};
+
+	class JobSystem
+	{
+	private:
+		static JobSystem singleton;
+
+		std::vector<std::thread> workers;
+		std::deque<std::function<void()>> jobs;
+		std::mutex jobsMutex;
+		std::condition_variable jobsCondition;
+		std::atomic<bool> running = { false };
+
+		void workerThread();
+		void push(std::function<void()> job);
+		bool runPendingJob(); //Runs one queued job on the calling thread. Returns false if the queue is empty
+
+	public:
+		JobSystem();
+		~JobSystem();
+
+		static JobSystem* getSingleton() { return &singleton; }
+
+		void init(int numThreads = 0);
+		void shutdown();
+
+		bool isRunning() { return running; }
+		int getNumThreads() { return (int)workers.size(); }
+
+		//Runs job on a worker thread. Falls back to immediate execution if workers are not started
+		JobHandle schedule(std::function<void()> job);
+
+		//Blocks the calling thread until the job is finished. Queued jobs are run on the calling thread meanwhile
+		void wait(const JobHandle& handle);
+
+		//Splits [0, count) into ranges of at most grainSize elements and processes them on all workers and the calling thread.
+		//Returns when all ranges are processed
+		void parallelFor(size_t count, size_t grainSize, std::function<void(size_t begin, size_t end)> job);
+	};
+}
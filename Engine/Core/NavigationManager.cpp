@@ -563,7 +563,7 @@ namespace GX
 			if (!obj->getNavigationStatic())
 				continue;
 
-			MeshRenderer* rend = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
+			MeshRenderer* rend = obj->getComponent<MeshRenderer>();
 			if (rend != nullptr && rend->getEnabled())
 			{
 				Mesh* mesh = rend->getMesh();
@@ -598,7 +598,7 @@ namespace GX
 				}
 			}
 
-			Terrain* terrain = (Terrain*)obj->getComponent(Terrain::COMPONENT_TYPE);
+			Terrain* terrain = obj->getComponent<Terrain>();
 			if (terrain != nullptr && terrain->getEnabled())
 			{
 				bounds.merge(terrain->getBounds());
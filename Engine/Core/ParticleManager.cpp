@@ -0,0 +1,81 @@
+#include "ParticleManager.h"
+
+#include <algorithm>
+
+#include "GameObject.h"
+#include "JobSystem.h"
+#include "Time.h"
+#include "../Components/ParticleSystem.h"
+
+namespace GX
+{
+	ParticleManager ParticleManager::singleton;
+
+	ParticleManager::ParticleManager()
+	{
+
+	}
+
+	ParticleManager::~ParticleManager()
+	{
+
+	}
+
+	void ParticleManager::addParticleSystem(ParticleSystem* particleSystem)
+	{
+		if (std::find(particleSystems.begin(), particleSystems.end(), particleSystem) == particleSystems.end())
+			particleSystems.push_back(particleSystem);
+	}
+
+	void ParticleManager::removeParticleSystem(ParticleSystem* particleSystem)
+	{
+		auto it = std::find(particleSystems.begin(), particleSystems.end(), particleSystem);
+		if (it != particleSystems.end())
+			particleSystems.erase(it);
+	}
+
+	void ParticleManager::update(float deltaTime)
+	{
+		std::vector<ParticleEmitter*> active;
+		std::vector<ParticleEmitter*> serial;
+
+		for (auto& ps : particleSystems)
+		{
+			GameObject* obj = ps->getGameObject();
+			if (obj == nullptr || !obj->getActive() || !ps->getEnabled())
+				continue;
+
+			for (auto& emitter : ps->getEmitters())
+			{
+				if (!emitter->getIsPlaying())
+					continue;
+
+				//Bullet world is not thread safe
+				if (emitter->usesPhysicsWorld())
+					serial.push_back(emitter);
+				else
+					active.push_back(emitter);
+			}
+		}
+
+		float timeScale = Time::getTimeScale();
+
+		JobSystem::getSingleton()->parallelFor(active.size(), 1, [&](size_t begin, size_t end)
+			{
+				for (size_t i = begin; i < end; ++i)
+					active[i]->update(deltaTime * active[i]->getTimeScale() * timeScale);
+			}
+		);
+
+		for (auto& emitter : serial)
+			emitter->update(deltaTime * emitter->getTimeScale() * timeScale);
+
+		//GPU buffers are released on the main thread
+		active.insert(active.end(), serial.begin(), serial.end());
+		for (auto& emitter : active)
+		{
+			if (emitter->getParticleCount() == 0)
+				emitter->destroy();
+		}
+	}
+}
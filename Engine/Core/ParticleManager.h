@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+namespace GX
+{
+	class ParticleSystem;
+
+	//Simulates all particle emitters once per frame, before any pass is rendered.
+	//Emitters do not share particles, so each one is processed as a separate job
+	class ParticleManager
+	{
+	private:
+		static ParticleManager singleton;
+
+		std::vector<ParticleSystem*> particleSystems;
+
+	public:
+		ParticleManager();
+		~ParticleManager();
+
+		static ParticleManager* getSingleton() { return &singleton; }
+
+		void addParticleSystem(ParticleSystem* particleSystem);
+		void removeParticleSystem(ParticleSystem* particleSystem);
+
+		//Called once per frame on the main thread
+		void update(float deltaTime);
+	};
+}
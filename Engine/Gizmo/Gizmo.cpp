@@ -202,7 +202,7 @@ namespace GX
 			GameObject* obj = selectedObjects[0]->getGameObject();
 			if (obj != nullptr)
 			{
-				csgBrush = (CSGBrush*)obj->getComponent(CSGBrush::COMPONENT_TYPE);
+				csgBrush = obj->getComponent<CSGBrush>();
 				if (op == ImGuizmo::OPERATION::SCALE)
 				{
 					if (csgBrush != nullptr)
@@ -493,7 +493,7 @@ namespace GX
 		{
 			if (root->getGameObject()->isSerializable())
 			{
-				MeshRenderer* rend = (MeshRenderer*)root->getGameObject()->getComponent(MeshRenderer::COMPONENT_TYPE);
+				MeshRenderer* rend = root->getGameObject()->getComponent<MeshRenderer>();
 
 				if (rend == nullptr)
 				{
@@ -541,7 +541,7 @@ namespace GX
 				Transform* first = nodes[0];
 
 				AxisAlignedBox box;
-				//if (first->getGameObject()->getComponent(MeshRenderer::COMPONENT_TYPE) == nullptr)
+				//if (first->getGameObject()->getComponent<MeshRenderer>() == nullptr)
 				//	box.setExtents(first->getPosition(), first->getPosition() + glm::vec3(0.1f, 0.1f, 0.1f));
 
 				for (auto it = nodes.begin(); it != nodes.end(); ++it)
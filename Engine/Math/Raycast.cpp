@@ -42,8 +42,8 @@ namespace GX
 					continue;
 			}
 
-			MeshRenderer* rend = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
-			Terrain* terrain = (Terrain*)obj->getComponent(Terrain::COMPONENT_TYPE);
+			MeshRenderer* rend = obj->getComponent<MeshRenderer>();
+			Terrain* terrain = obj->getComponent<Terrain>();
 			
 			if (rend != nullptr)
 			{
@@ -180,8 +180,8 @@ namespace GX
 
 			if (obj != nullptr)
 			{
-				MeshRenderer* rend = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
-				Terrain* terrain = (Terrain*)obj->getComponent(Terrain::COMPONENT_TYPE);
+				MeshRenderer* rend = obj->getComponent<MeshRenderer>();
+				Terrain* terrain = obj->getComponent<Terrain>();
 				
 				if (rend != nullptr)
 				{
@@ -257,7 +257,7 @@ namespace GX
 			if (!obj->getActive())
 				continue;
 
-			MeshRenderer* rend = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
+			MeshRenderer* rend = obj->getComponent<MeshRenderer>();
 			if (rend != nullptr)
 			{
 				if (!rend->getEnabled())
@@ -275,7 +275,7 @@ namespace GX
 			}
 			else
 			{
-				Terrain* terrain = (Terrain*)obj->getComponent(Terrain::COMPONENT_TYPE);
+				Terrain* terrain = obj->getComponent<Terrain>();
 				if (terrain != nullptr)
 				{
 					if (!terrain->getEnabled())
@@ -1,5 +1,6 @@
 #include "BatchedGeometry.h"
 
+#include "../glm/common.hpp"
 #include "../glm/gtc/type_ptr.hpp"
 
 #include "../Assets/Material.h"
@@ -45,10 +46,7 @@ namespace GX
     {
         if (!bgfx::isValid(m_vbh) && vertexBuffer.size() > 0)
         {
-            m_vbh = bgfx::createVertexBuffer(
-                bgfx::makeRef(vertexBuffer.data(), vertexBuffer.size() * sizeof(VertexBuffer)),
-                VertexLayouts::subMeshVertexLayout
-            );
+            m_vbh = VertexLayouts::createCompactVertexBuffer(vertexBuffer, false);
         }
 
         if (!bgfx::isValid(m_ibh) && indexBuffer.size() > 0)
@@ -312,7 +310,7 @@ namespace GX
 
             if (obj->getBatchingStatic())
             {
-                MeshRenderer* rend = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
+                MeshRenderer* rend = obj->getComponent<MeshRenderer>();
 
                 if (rend != nullptr)
                 {
@@ -326,6 +324,9 @@ namespace GX
 
                     bool transparent = rend->isTransparent();
 
+                    AxisAlignedBox rendBounds = rend->getBounds();
+                    glm::ivec3 cell = glm::ivec3(glm::floor(rendBounds.getCenter() / std::max(cellSize, 0.001f)));
+
                     Mesh* mesh = rend->getMesh();
 
                     if (mesh != nullptr)
@@ -341,6 +342,8 @@ namespace GX
                             auto& vb = subMesh->getVertexBuffer();
                             auto& ib = subMesh->getIndexBuffer();
 
+                            int numTriangles = (int)ib.size() / 3;
+
                             Batch* batch = nullptr;
                             auto it = std::find_if(batches.begin(), batches.end(), [=](Batch* b) -> bool
                                 {
@@ -350,7 +353,9 @@ namespace GX
                                         b->getLightingStatic() == obj->getLightingStatic() &&
                                         b->getUseLightmapUVs() == subMesh->getUseLightmapUVs() &&
                                         b->getLightmapSize() == rend->getLightmapSize() &&
-                                        b->getNumMeshes() < maxBatchSize;
+                                        b->cell == cell &&
+                                        b->getNumMeshes() < maxBatchSize &&
+                                        b->getNumTriangles() + numTriangles <= maxBatchTriangles;
 
                                     return match;
                                 }
@@ -371,6 +376,7 @@ namespace GX
                                 batch->lightingStatic = obj->getLightingStatic();
                                 batch->useLightmapUVs = subMesh->getUseLightmapUVs();
                                 batch->lightmapSize = rend->getLightmapSize();
+                                batch->cell = cell;
                                 batch->index = numBatches;
 
                                 batches.push_back(batch);
@@ -380,6 +386,7 @@ namespace GX
 
                             batch->guid = md5(batch->guid + obj->getGuid() + "_" + std::to_string(i));
                             batch->numMeshes += 1;
+                            batch->numTriangles += numTriangles;
 
                             auto& batchVb = batch->getVertexBuffer();
                             auto& batchIb = batch->getIndexBuffer();
@@ -413,7 +420,7 @@ namespace GX
                                 ++_v;
                             }
 
-                            batch->cachedAAB.merge(rend->getBounds());
+                            batch->cachedAAB.merge(rendBounds);
                         }
                     }
                 }
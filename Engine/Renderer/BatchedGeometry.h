@@ -44,6 +44,8 @@ namespace GX
             int index = 0;
 
             int numMeshes = 0;
+            int numTriangles = 0;
+            glm::ivec3 cell = glm::ivec3(0); //Spatial cell this batch was built for
 
         public:
             Batch();
@@ -53,6 +55,7 @@ namespace GX
             virtual bool isTransparent() { return transparent; }
             virtual bool isStatic() { return lightingStatic; }
             virtual bool checkCullingMask(LayerMask& mask);
+            virtual Material* getSortMaterial() { return material; }
             virtual void onRender(Camera* camera, int view, uint64_t state, bgfx::ProgramHandle program, int renderMode, std::function<void()> preRenderCallback);
 
             Material* getMaterial() { return material; }
@@ -73,6 +76,7 @@ namespace GX
             int getLightmapSize() { return lightmapSize; }
 
             const int& getNumMeshes() { return numMeshes; }
+            const int& getNumTriangles() { return numTriangles; }
 
             void reloadLightmap();
 
@@ -87,6 +91,11 @@ namespace GX
 
         bool _needRebuild = false;
 
+        //Batches are split into cells of this size (world units) so they can be culled individually
+        float cellSize = 64.0f;
+        //Max triangles per batch
+        int maxBatchTriangles = 65536;
+
     public:
         BatchedGeometry();
         ~BatchedGeometry();
@@ -101,6 +110,12 @@ namespace GX
 
         bool needRebuild() { return _needRebuild; }
 
+        float getCellSize() { return cellSize; }
+        void setCellSize(float value) { cellSize = value; }
+
+        int getMaxBatchTriangles() { return maxBatchTriangles; }
+        void setMaxBatchTriangles(int value) { maxBatchTriangles = value; }
+
         bool loadFromFile(std::string location, std::string name);
         void saveToFile(std::string location, std::string name);
     };
@@ -61,10 +61,7 @@ namespace GX
     {
         if (!bgfx::isValid(m_vbh) && vertexBuffer.size() > 0)
         {
-            m_vbh = bgfx::createVertexBuffer(
-                bgfx::makeRef(vertexBuffer.data(), vertexBuffer.size() * sizeof(VertexBuffer)),
-                VertexLayouts::subMeshVertexLayout
-            );
+            m_vbh = VertexLayouts::createCompactVertexBuffer(vertexBuffer, false);
         }
 
         if (!bgfx::isValid(m_ibh) && indexBuffer.size() > 0)
@@ -470,7 +467,7 @@ namespace GX
 
         for (auto& object : objects)
         {
-            CSGModel* model = (CSGModel*)object->getComponent(CSGModel::COMPONENT_TYPE);
+            CSGModel* model = object->getComponent<CSGModel>();
             if (model == nullptr)
                 continue;
 
@@ -517,7 +514,7 @@ namespace GX
             std::vector<Transform*> nstack;
             for (auto trans : modelTrans->getChildren())
             {
-                if (trans->getGameObject()->getComponent(CSGModel::COMPONENT_TYPE) != nullptr)
+                if (trans->getGameObject()->getComponent<CSGModel>() != nullptr)
                     continue;
 
                 nstack.push_back(trans);
@@ -533,10 +530,10 @@ namespace GX
                 if (!chObj->getActive())
                     continue;
 
-                if (chObj->getComponent(CSGModel::COMPONENT_TYPE) != nullptr)
+                if (chObj->getComponent<CSGModel>() != nullptr)
                     continue;
 
-                CSGBrush* brush = (CSGBrush*)chObj->getComponent(CSGBrush::COMPONENT_TYPE);
+                CSGBrush* brush = chObj->getComponent<CSGBrush>();
 
                 if (brush != nullptr)
                 {
@@ -568,7 +565,7 @@ namespace GX
             nstack.clear();
             for (auto trans : modelTrans->getChildren())
             {
-                if (trans->getGameObject()->getComponent(CSGModel::COMPONENT_TYPE) != nullptr)
+                if (trans->getGameObject()->getComponent<CSGModel>() != nullptr)
                     continue;
 
                 nstack.push_back(trans);
@@ -584,10 +581,10 @@ namespace GX
                 if (!chObj->getActive())
                     continue;
 
-                if (chObj->getComponent(CSGModel::COMPONENT_TYPE) != nullptr)
+                if (chObj->getComponent<CSGModel>() != nullptr)
                     continue;
 
-                CSGBrush* brush = (CSGBrush*)chObj->getComponent(CSGBrush::COMPONENT_TYPE);
+                CSGBrush* brush = chObj->getComponent<CSGBrush>();
 
                 if (brush != nullptr)
                 {
@@ -1127,7 +1124,7 @@ namespace GX
         while (p != nullptr)
         {
             GameObject* obj = p->getGameObject();
-            CSGModel* comp = (CSGModel*)obj->getComponent(CSGModel::COMPONENT_TYPE);
+            CSGModel* comp = obj->getComponent<CSGModel>();
             if (comp != nullptr)
             {
                 model = comp;
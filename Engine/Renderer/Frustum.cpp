@@ -1,6 +1,7 @@
 #include "Frustum.h"
 
 #include <complex>
+#include <emmintrin.h>
 
 #include "../glm/gtc/type_ptr.hpp"
 
@@ -172,6 +173,76 @@ namespace GX
 		return visible;
 	}
 
+	void Frustum::boxesInFrustum(const float* centerX, const float* centerY, const float* centerZ,
+		const float* extentX, const float* extentY, const float* extentZ,
+		uint8_t* visible, size_t begin, size_t end)
+	{
+		size_t i = begin;
+
+		//Four boxes per iteration
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+
+		__m128 planeA[6], planeB[6], planeC[6], planeD[6];
+		__m128 absA[6], absB[6], absC[6];
+		for (int plane = 0; plane < 6; ++plane)
+		{
+			planeA[plane] = _mm_set1_ps(m_Frustum[plane][A]);
+			planeB[plane] = _mm_set1_ps(m_Frustum[plane][B]);
+			planeC[plane] = _mm_set1_ps(m_Frustum[plane][C]);
+			planeD[plane] = _mm_set1_ps(m_Frustum[plane][D]);
+			absA[plane] = _mm_andnot_ps(signMask, planeA[plane]);
+			absB[plane] = _mm_andnot_ps(signMask, planeB[plane]);
+			absC[plane] = _mm_andnot_ps(signMask, planeC[plane]);
+		}
+
+		for (; i + 4 <= end; i += 4)
+		{
+			__m128 cx = _mm_loadu_ps(centerX + i);
+			__m128 cy = _mm_loadu_ps(centerY + i);
+			__m128 cz = _mm_loadu_ps(centerZ + i);
+			__m128 ex = _mm_loadu_ps(extentX + i);
+			__m128 ey = _mm_loadu_ps(extentY + i);
+			__m128 ez = _mm_loadu_ps(extentZ + i);
+
+			__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+			for (int plane = 0; plane < 6; ++plane)
+			{
+				__m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeA[plane], cx), _mm_mul_ps(planeB[plane], cy)),
+					_mm_add_ps(_mm_mul_ps(planeC[plane], cz), planeD[plane]));
+				__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absA[plane], ex), _mm_mul_ps(absB[plane], ey)), _mm_mul_ps(absC[plane], ez));
+
+				//Box is outside if dist < -radius
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(dist, radius), _mm_setzero_ps()));
+			}
+
+			int mask = _mm_movemask_ps(inside);
+			visible[i + 0] = (mask & 1) ? 1 : 0;
+			visible[i + 1] = (mask & 2) ? 1 : 0;
+			visible[i + 2] = (mask & 4) ? 1 : 0;
+			visible[i + 3] = (mask & 8) ? 1 : 0;
+		}
+
+		for (; i < end; ++i)
+		{
+			uint8_t inside = 1;
+
+			for (int plane = 0; plane < 6; ++plane)
+			{
+				float dist = m_Frustum[plane][A] * centerX[i] + m_Frustum[plane][B] * centerY[i] + m_Frustum[plane][C] * centerZ[i] + m_Frustum[plane][D];
+				float radius = std::abs(m_Frustum[plane][A]) * extentX[i] + std::abs(m_Frustum[plane][B]) * extentY[i] + std::abs(m_Frustum[plane][C]) * extentZ[i];
+
+				if (dist + radius < 0.0f)
+				{
+					inside = 0;
+					break;
+				}
+			}
+
+			visible[i] = inside;
+		}
+	}
+
 	void Frustum::normalize()
 	{
 		for (int i = 0; i < 6; ++i)
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include "../glm/mat4x4.hpp"
 #include "../glm/vec3.hpp"
 
@@ -21,6 +24,11 @@ namespace GX
 		bool cubeInFrustum(float x, float y, float z, float size);
 		bool aabbInFrustum(AxisAlignedBox aabb);
 
+		//Tests boxes given as center/extent arrays (SoA) in range [begin, end) and writes 1 to visible for boxes intersecting the frustum
+		void boxesInFrustum(const float* centerX, const float* centerY, const float* centerZ,
+			const float* extentX, const float* extentY, const float* extentZ,
+			uint8_t* visible, size_t begin, size_t end);
+
 	private:
 
 		float m_Frustum[6][4];
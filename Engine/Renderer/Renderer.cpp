@@ -2,6 +2,8 @@
 
 #ifndef _WIN32
 #include <string.h>
+#include <cstddef>
+#include <thread>
 #endif
 
 #include <imgui.h>
@@ -72,6 +74,11 @@
 #include "../Math/Mathf.h"
 #include "../Math/Raycast.h"
 #include "../Core/Time.h"
+#include "../Core/JobSystem.h"
+#include "../Core/AsyncLoader.h"
+#include "../Core/AnimationSystem.h"
+#include "../Core/ParticleManager.h"
+#include "TextureStreamer.h"
 
 #include "../Classes/brtshaderc.h"
 
@@ -82,6 +89,7 @@
 #include "SystemShaders/SimpleTextureShader.h"
 #include "SystemShaders/TerrainTreeBillboardShader.h"
 #include "SystemShaders/TerrainTreeBillboardLightShader.h"
+#include "SystemShaders/TerrainTreeBillboardInstancedShader.h"
 #include "SystemShaders/TransparentShader.h"
 #include "SystemShaders/OutlineShader.h"
 #include "SystemShaders/OutlineFinalShader.h"
@@ -93,6 +101,22 @@
 
 constexpr auto SHADOW_AAB_VAL = 9000;
 
+constexpr uint8_t CULL_FLAG_SKIP = 1 << 0;
+constexpr uint8_t CULL_FLAG_DECAL = 1 << 1;
+constexpr uint8_t CULL_FLAG_ALWAYS_VISIBLE = 1 << 2;
+constexpr uint8_t CULL_FLAG_TRANSPARENT = 1 << 3;
+constexpr uint8_t CULL_FLAG_NULL_BOUNDS = 1 << 4;
+constexpr uint8_t CULL_FLAG_INFINITE_BOUNDS = 1 << 5;
+
+constexpr size_t CULL_GRAIN_SIZE = 1024;
+
+//Sort key layout
+//Opaque:      view (8) | queue (8) | program (12) | material (12) | depth (24), front to back
+//Transparent: view (8) | queue (8) | inverted depth (24) | program (12) | material (12), back to front
+constexpr int SORT_KEY_DEPTH_BITS = 24;
+constexpr uint32_t SORT_KEY_DEPTH_MAX = (1u << SORT_KEY_DEPTH_BITS) - 1;
+constexpr uint32_t SORT_KEY_STATE_MASK = (1u << 24) - 1;
+
 namespace GX
 {
 	Renderer Renderer::singleton;
@@ -251,21 +275,20 @@ namespace GX
 			
 			createResources();
 
-			/*SYSTEM_INFO sysinfo;
-			GetSystemInfo(&sysinfo);
-			int numCPU = sysinfo.dwNumberOfProcessors;
-			numCPU = numCPU >= 2 ? 2 : 1;*/
+			int numCPU = (int)std::thread::hardware_concurrency();
+			numCPU = std::max(std::min(numCPU - 1, 4), 1);
 
 			moc = MaskedOcclusionCulling::Create();
-			//auto impl = moc->GetImplementation();
-			//cmoc = new CullingThreadpool(numCPU, numCPU, numCPU);
-			//cmoc->SetBuffer(moc);
 
 			const int _width = 1920, _height = 1080;
 			moc->SetResolution(_width, _height);
 			moc->SetNearClipPlane(0.1f);
 
-			//cmoc->WakeThreads();
+			//Occluders are binned and rasterized on the threadpool. Vertices are read directly from
+			//VertexBuffer arrays and transformed by the library using the model to clip matrix
+			cmoc = new CullingThreadpool(numCPU, 2, numCPU);
+			cmoc->SetBuffer(moc);
+			cmoc->SetVertexLayout(MaskedOcclusionCulling::VertexLayout(sizeof(VertexBuffer), offsetof(VertexBuffer, position.y), offsetof(VertexBuffer, position.z)));
 		}
 
 		isRunning = true;
@@ -315,6 +338,20 @@ namespace GX
 		fsh = bgfx::createShader(memFsh);
 		terrainTreeBillboardLightPH = bgfx::createProgram(vsh, fsh, true);
 
+		//Compile instanced terrain tree billboard shaders
+		if (bgfx::getCaps()->supported & BGFX_CAPS_INSTANCING)
+		{
+			memVsh = shaderc::compileShaderFromSources(shaderc::ST_VERTEX, "/", shaders::terrainTreeBillboardInstancedVertex.c_str(), "", shaders::terrainTreeBillboardInstancedVarying.c_str());
+			memFsh = shaderc::compileShaderFromSources(shaderc::ST_FRAGMENT, "/", shaders::terrainTreeBillboardFragment.c_str(), "", shaders::terrainTreeBillboardInstancedVarying.c_str());
+			vsh = bgfx::createShader(memVsh);
+			fsh = bgfx::createShader(memFsh);
+			terrainTreeBillboardInstancedPH = bgfx::createProgram(vsh, fsh, true);
+
+			memFsh = shaderc::compileShaderFromSources(shaderc::ST_FRAGMENT, "/", shaders::terrainTreeBillboardLightFragment.c_str(), "", shaders::terrainTreeBillboardInstancedVarying.c_str());
+			fsh = bgfx::createShader(memFsh);
+			terrainTreeBillboardLightInstancedPH = bgfx::createProgram(vsh, fsh, true);
+		}
+
 		//Compile billboard shader
 		memVsh = shaderc::compileShaderFromSources(shaderc::ST_VERTEX, "/", shaders::transparentVertex.c_str(), "", shaders::transparentVarying.c_str());
 		memFsh = shaderc::compileShaderFromSources(shaderc::ST_FRAGMENT, "/", shaders::transparentFragment.c_str(), "", shaders::transparentVarying.c_str());
@@ -478,6 +515,12 @@ namespace GX
 		
 		if (bgfx::isValid(terrainTreeBillboardLightPH))
 			bgfx::destroy(terrainTreeBillboardLightPH);
+
+		if (bgfx::isValid(terrainTreeBillboardInstancedPH))
+			bgfx::destroy(terrainTreeBillboardInstancedPH);
+
+		if (bgfx::isValid(terrainTreeBillboardLightInstancedPH))
+			bgfx::destroy(terrainTreeBillboardLightInstancedPH);
 		
 		if (bgfx::isValid(transparentPH))
 			bgfx::destroy(transparentPH);
@@ -505,6 +548,8 @@ namespace GX
 		simpleTexturePH = { bgfx::kInvalidHandle };
 		terrainTreeBillboardPH = { bgfx::kInvalidHandle };
 		terrainTreeBillboardLightPH = { bgfx::kInvalidHandle };
+		terrainTreeBillboardInstancedPH = { bgfx::kInvalidHandle };
+		terrainTreeBillboardLightInstancedPH = { bgfx::kInvalidHandle };
 		transparentPH = { bgfx::kInvalidHandle };
 		combinePH = { bgfx::kInvalidHandle };
 		outlineFinalPH = { bgfx::kInvalidHandle };
@@ -545,6 +590,15 @@ namespace GX
 
 		destroyResources();
 
+		if (cmoc != nullptr)
+			delete cmoc;
+
+		if (moc != nullptr)
+			MaskedOcclusionCulling::Destroy(moc);
+
+		cmoc = nullptr;
+		moc = nullptr;
+
 		bgfx::shutdown();
 
 		while (bgfx::RenderFrame::NoContext != bgfx::renderFrame()) {};
@@ -787,7 +841,7 @@ namespace GX
 				while (par != nullptr)
 				{
 					GameObject* ob = par->getGameObject();
-					Mask* mask = (Mask*)ob->getComponent(Mask::COMPONENT_TYPE);
+					Mask* mask = ob->getComponent<Mask>();
 					if (mask != nullptr)
 					{
 						UIElement::Properties& props = mask->getProperties();
@@ -847,8 +901,16 @@ namespace GX
 		numDrawCalls = 0;
 		numTriangles = 0;
 
+		//Create GPU resources for assets loaded in background
+		AsyncLoader::getSingleton()->processUploads();
+
+		//Swap texture mip levels requested during the last frame
+		TextureStreamer::getSingleton()->update();
+
 		clearTransientRenderables();
 
+		cullingDataOutdated = true;
+
 		Camera::updateDynamicResolution();
 
 		std::vector<GameObject*> gameObjects = Engine::getSingleton()->getGameObjects();
@@ -946,6 +1008,10 @@ namespace GX
 
 		//-->Render UI end
 
+		//Poses and skinning matrices are shared by shadow and camera passes
+		AnimationSystem::getSingleton()->update(Time::getDeltaTime());
+		ParticleManager::getSingleton()->update(Time::getDeltaTime());
+
 		//----------Render point and spot light shadows----------//
 
 		renderPointAndSpotLightShadows();
@@ -1006,64 +1072,502 @@ namespace GX
 
 			//-----------Render forward-----------//
 
-			std::vector<Renderable*> transparentObjects;
+			RenderList* renderList = getRenderList(renderQueue);
 
 			//Render opaque
 
-			for (auto it = renderables.begin(); it != renderables.end(); ++it)
+			beginInstancing();
+
+			for (auto it = renderList->opaque.begin(); it != renderList->opaque.end(); ++it)
 			{
-				Renderable* comp = *it;
+				Renderable* comp = it->renderable;
 
-				if (comp->getSkipRendering() || comp->isDecal())
-					continue;
+				comp->onRender(camera, RENDER_FORWARD_PASS_ID + viewLayer, getRenderState(camera, defaultRenderState), { bgfx::kInvalidHandle }, static_cast<int>(RenderMode::Forward), [=]() {
+					setSystemUniforms(camera);
+					});
+			}
 
-				if (comp->getRenderQueue() != renderQueue)
-					continue;
+			endInstancing(camera, RENDER_FORWARD_PASS_ID + viewLayer, getRenderState(camera, defaultRenderState), [=]() {
+				setSystemUniforms(camera);
+				});
 
-				if (!comp->checkCullingMask(camera->getCullingMask()))
-					continue;
+			//Render transparent (already sorted back to front)
+			for (auto it = renderList->transparent.begin(); it != renderList->transparent.end(); ++it)
+			{
+				Renderable* comp = it->renderable;
 
-				if (!comp->isAlwaysVisible())
+				comp->onRender(camera, RENDER_FORWARD_PASS_ID + viewLayer, getRenderState(camera, defaultRenderState), { bgfx::kInvalidHandle }, static_cast<int>(RenderMode::Forward), [=]() {
+					setSystemUniforms(camera);
+					});
+			}
+		}
+	}
+
+	void Renderer::updateCullingData()
+	{
+		cullingDataOutdated = false;
+
+		size_t count = renderables.size();
+
+		cullRenderables = renderables;
+		cullCenterX.resize(count);
+		cullCenterY.resize(count);
+		cullCenterZ.resize(count);
+		cullExtentX.resize(count);
+		cullExtentY.resize(count);
+		cullExtentZ.resize(count);
+		cullFlags.resize(count);
+		cullQueues.resize(count);
+		cullStateKeys.resize(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			Renderable* comp = cullRenderables[i];
+
+			uint8_t flags = 0;
+			glm::vec3 center = glm::vec3(0.0f);
+			glm::vec3 extent = glm::vec3(0.0f);
+
+			if (comp->getSkipRendering())
+				flags |= CULL_FLAG_SKIP;
+			else
+			{
+				if (comp->isDecal())
+					flags |= CULL_FLAG_DECAL;
+				else if (comp->isTransparent())
+					flags |= CULL_FLAG_TRANSPARENT;
+
+				if (comp->isAlwaysVisible())
+					flags |= CULL_FLAG_ALWAYS_VISIBLE;
+				else
 				{
-					if (!camera->isVisible(comp->getBounds()))
-						continue;
+					AxisAlignedBox aab = comp->getBounds();
+
+					if (aab.isNull())
+						flags |= CULL_FLAG_NULL_BOUNDS;
+					else if (aab.isInfinite())
+						flags |= CULL_FLAG_INFINITE_BOUNDS;
+					else
+					{
+						center = aab.getCenter();
+						extent = aab.getHalfSize();
+					}
 				}
+			}
+
+			cullCenterX[i] = center.x;
+			cullCenterY[i] = center.y;
+			cullCenterZ[i] = center.z;
+			cullExtentX[i] = extent.x;
+			cullExtentY[i] = extent.y;
+			cullExtentZ[i] = extent.z;
+			cullFlags[i] = flags;
+			cullQueues[i] = comp->getRenderQueue();
+			cullStateKeys[i] = (flags & CULL_FLAG_SKIP) ? 0 : makeStateKey(comp->getSortMaterial());
+		}
+	}
+
+	void Renderer::cullVisibleRenderables(Camera* camera, int viewLayer, bool testOcclusion)
+	{
+		if (cullingDataOutdated)
+			updateCullingData();
+
+		size_t count = cullRenderables.size();
+		cullVisible.resize(count);
 
-				if (!comp->isTransparent())
+		Frustum* frustum = camera->getFrustum();
+
+		testOcclusion = testOcclusion && moc != nullptr;
+
+		JobSystem::getSingleton()->parallelFor(count, CULL_GRAIN_SIZE, [&](size_t begin, size_t end)
+			{
+				frustum->boxesInFrustum(cullCenterX.data(), cullCenterY.data(), cullCenterZ.data(),
+					cullExtentX.data(), cullExtentY.data(), cullExtentZ.data(),
+					cullVisible.data(), begin, end);
+
+				//Depth buffer is read only here, so queries are safe from any thread
+				if (testOcclusion)
 				{
-					comp->onRender(camera, RENDER_FORWARD_PASS_ID + viewLayer, getRenderState(camera, defaultRenderState), { bgfx::kInvalidHandle }, static_cast<int>(RenderMode::Forward), [=]() {
-						setSystemUniforms(camera);
-						});
+					for (size_t i = begin; i < end; ++i)
+					{
+						if (!cullVisible[i] || (cullFlags[i] & (CULL_FLAG_SKIP | CULL_FLAG_ALWAYS_VISIBLE | CULL_FLAG_NULL_BOUNDS | CULL_FLAG_INFINITE_BOUNDS)))
+							continue;
+
+						if (isBoxOccluded(i))
+							cullVisible[i] = 0;
+					}
 				}
-				else
-					transparentObjects.push_back(comp);
 			}
+		);
 
-			//Sort transparent
-			glm::vec3 cameraPos = camera->getTransform()->getPosition();
-			std::sort(transparentObjects.begin(), transparentObjects.end(), [=](Renderable* rend1, Renderable* rend2) -> bool
-				{
-					glm::vec3 pos1 = rend1->getBounds().getCenter();
-					glm::vec3 pos2 = rend2->getBounds().getCenter();
+		visibleRenderables.clear();
+		visibleDecals.clear();
 
-					float dist1 = glm::distance(pos1, cameraPos);
-					float dist2 = glm::distance(pos2, cameraPos);
+		for (auto& list : renderLists)
+		{
+			list.opaque.clear();
+			list.transparent.clear();
+		}
 
-					return dist1 > dist2;
-				}
-			);
+		LayerMask& cullingMask = camera->getCullingMask();
+		glm::vec3 cameraPos = camera->getTransform()->getPosition();
+		float depthScale = (float)SORT_KEY_DEPTH_MAX / std::max(camera->getFar(), 0.001f);
 
-			//Render transparent
-			for (auto it = transparentObjects.begin(); it != transparentObjects.end(); ++it)
+		for (size_t i = 0; i < count; ++i)
+		{
+			uint8_t flags = cullFlags[i];
+
+			if (flags & CULL_FLAG_SKIP)
+				continue;
+
+			if (!(flags & CULL_FLAG_ALWAYS_VISIBLE))
 			{
-				Renderable* comp = *it;
+				if (flags & CULL_FLAG_NULL_BOUNDS)
+					continue;
 
-				comp->onRender(camera, RENDER_FORWARD_PASS_ID + viewLayer, getRenderState(camera, defaultRenderState), { bgfx::kInvalidHandle }, static_cast<int>(RenderMode::Forward), [=]() {
-					setSystemUniforms(camera);
-					});
+				if (!(flags & CULL_FLAG_INFINITE_BOUNDS) && !cullVisible[i])
+					continue;
 			}
 
-			transparentObjects.clear();
+			Renderable* comp = cullRenderables[i];
+
+			if (!comp->checkCullingMask(cullingMask))
+				continue;
+
+			if (flags & CULL_FLAG_DECAL)
+			{
+				visibleDecals.push_back(comp);
+				continue;
+			}
+
+			//Distance is computed once per draw and quantized into the key
+			uint32_t depth = 0;
+			if (!(flags & (CULL_FLAG_ALWAYS_VISIBLE | CULL_FLAG_INFINITE_BOUNDS)))
+			{
+				float dx = cullCenterX[i] - cameraPos.x;
+				float dy = cullCenterY[i] - cameraPos.y;
+				float dz = cullCenterZ[i] - cameraPos.z;
+				float dist = sqrtf(dx * dx + dy * dy + dz * dz) * depthScale;
+				depth = (uint32_t)std::min(dist, (float)SORT_KEY_DEPTH_MAX);
+			}
+
+			int queue = cullQueues[i];
+			uint32_t stateKey = cullStateKeys[i];
+
+			RenderItem item;
+			item.renderable = comp;
+			item.key = makeOpaqueSortKey(viewLayer, queue, stateKey, depth);
+
+			visibleRenderables.push_back(item);
+
+			RenderList* list = getRenderList(queue);
+			if (flags & CULL_FLAG_TRANSPARENT)
+			{
+				item.key = makeTransparentSortKey(viewLayer, queue, stateKey, depth);
+				list->transparent.push_back(item);
+			}
+			else
+				list->opaque.push_back(item);
+		}
+
+		sortRenderItems(visibleRenderables);
+
+		for (auto& list : renderLists)
+		{
+			sortRenderItems(list.opaque);
+			sortRenderItems(list.transparent);
+		}
+	}
+
+	bool Renderer::isBoxOccluded(size_t index)
+	{
+		const glm::mat4x4& mtx = occlusionViewProj;
+
+		float xmin = FLT_MAX, ymin = FLT_MAX, wmin = FLT_MAX;
+		float xmax = -FLT_MAX, ymax = -FLT_MAX;
+
+		for (int c = 0; c < 8; ++c)
+		{
+			glm::vec4 corner = glm::vec4(
+				cullCenterX[index] + ((c & 1) ? cullExtentX[index] : -cullExtentX[index]),
+				cullCenterY[index] + ((c & 2) ? cullExtentY[index] : -cullExtentY[index]),
+				cullCenterZ[index] + ((c & 4) ? cullExtentZ[index] : -cullExtentZ[index]),
+				1.0f);
+
+			glm::vec4 clip = mtx * corner;
+
+			//Box crosses the near plane. Treat as visible
+			if (clip.w <= 0.1f)
+				return false;
+
+			float x = clip.x / clip.w;
+			float y = clip.y / clip.w;
+
+			xmin = std::min(xmin, x);
+			ymin = std::min(ymin, y);
+			xmax = std::max(xmax, x);
+			ymax = std::max(ymax, y);
+			wmin = std::min(wmin, clip.w);
+		}
+
+		xmin = std::max(xmin, -1.0f);
+		ymin = std::max(ymin, -1.0f);
+		xmax = std::min(xmax, 1.0f);
+		ymax = std::min(ymax, 1.0f);
+
+		if (xmin >= xmax || ymin >= ymax)
+			return false;
+
+		return moc->TestRect(xmin, ymin, xmax, ymax, wmin) == MaskedOcclusionCulling::OCCLUDED;
+	}
+
+	uint64_t Renderer::makeOpaqueSortKey(int viewLayer, int queue, uint32_t stateKey, uint32_t depth)
+	{
+		return ((uint64_t)(viewLayer & 0xFF) << 56)
+			| ((uint64_t)(queue & 0xFF) << 48)
+			| ((uint64_t)(stateKey & SORT_KEY_STATE_MASK) << 24)
+			| (uint64_t)(depth & SORT_KEY_DEPTH_MAX);
+	}
+
+	uint64_t Renderer::makeTransparentSortKey(int viewLayer, int queue, uint32_t stateKey, uint32_t depth)
+	{
+		return ((uint64_t)(viewLayer & 0xFF) << 56)
+			| ((uint64_t)(queue & 0xFF) << 48)
+			| ((uint64_t)(SORT_KEY_DEPTH_MAX - (depth & SORT_KEY_DEPTH_MAX)) << 24)
+			| (uint64_t)(stateKey & SORT_KEY_STATE_MASK);
+	}
+
+	uint32_t Renderer::makeStateKey(Material* material)
+	{
+		if (material == nullptr)
+			return SORT_KEY_STATE_MASK;
+
+		//Pointer hashes are enough here. A collision only affects grouping, never correctness
+		uint32_t programId = 0xFFF;
+		Shader* shader = material->getShader();
+		if (shader != nullptr)
+			programId = (uint32_t)(std::hash<Shader*>{}(shader) % 0xFFF);
+
+		uint32_t materialId = (uint32_t)(std::hash<Material*>{}(material) % 0xFFF);
+
+		return (programId << 12) | materialId;
+	}
+
+	void Renderer::sortRenderItems(std::vector<RenderItem>& items)
+	{
+		size_t count = items.size();
+		if (count < 2)
+			return;
+
+		//LSD radix sort, 8 bits per pass. Passes where all keys share the same byte are skipped
+		sortBuffer.resize(count);
+
+		RenderItem* src = items.data();
+		RenderItem* dst = sortBuffer.data();
+
+		for (int shift = 0; shift < 64; shift += 8)
+		{
+			size_t histogram[256] = { 0 };
+
+			for (size_t i = 0; i < count; ++i)
+				++histogram[(src[i].key >> shift) & 0xFF];
+
+			if (histogram[(src[0].key >> shift) & 0xFF] == count)
+				continue;
+
+			size_t offset = 0;
+			for (int b = 0; b < 256; ++b)
+			{
+				size_t c = histogram[b];
+				histogram[b] = offset;
+				offset += c;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+				dst[histogram[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+			std::swap(src, dst);
+		}
+
+		if (src != items.data())
+			memcpy(items.data(), src, count * sizeof(RenderItem));
+	}
+
+	RenderList* Renderer::getRenderList(int queue)
+	{
+		for (auto& list : renderLists)
+		{
+			if (list.queue == queue)
+				return &list;
+		}
+
+		RenderList list;
+		list.queue = queue;
+		renderLists.push_back(list);
+
+		return &renderLists[renderLists.size() - 1];
+	}
+
+	void Renderer::beginInstancing()
+	{
+		for (int i = 0; i < numInstanceBatches; ++i)
+			instanceBatches[i].transforms.clear();
+
+		numInstanceBatches = 0;
+		instanceBatchMap.clear();
+
+		collectInstances = instancingEnabled && (bgfx::getCaps()->supported & BGFX_CAPS_INSTANCING) != 0;
+	}
+
+	bool Renderer::addInstance(SubMesh* subMesh, int lod, Material* material, const glm::mat4x4& transform)
+	{
+		if (!collectInstances)
+			return false;
+
+		InstanceBatchKey key = std::make_tuple(subMesh, material, lod);
+
+		auto it = instanceBatchMap.find(key);
+		if (it != instanceBatchMap.end())
+		{
+			if (it->second < 0)
+				return false;
+
+			instanceBatches[it->second].transforms.push_back(transform);
+
+			return true;
+		}
+
+		//Every pass of the material shader must provide an instanced variant
+		bool instanced = material != nullptr && material->isLoaded();
+		Shader* shader = instanced ? material->getShader() : nullptr;
+
+		if (shader == nullptr || !shader->isLoaded() || shader->getPassCount() == 0)
+			instanced = false;
+
+		if (instanced)
+		{
+			for (int j = 0; j < shader->getPassCount(); ++j)
+			{
+				Pass* pass = shader->getPass(j);
+				if (pass == nullptr || pass->getInstancedProgramVariant(material->getDefinesStringHash()) == nullptr)
+				{
+					instanced = false;
+					break;
+				}
+			}
+		}
+
+		if (!instanced)
+		{
+			instanceBatchMap[key] = -1;
+			return false;
+		}
+
+		if (numInstanceBatches == instanceBatches.size())
+			instanceBatches.push_back(InstanceBatch());
+
+		InstanceBatch& batch = instanceBatches[numInstanceBatches];
+		batch.subMesh = subMesh;
+		batch.material = material;
+		batch.lod = lod;
+		batch.transforms.push_back(transform);
+
+		instanceBatchMap[key] = numInstanceBatches;
+		++numInstanceBatches;
+
+		return true;
+	}
+
+	void Renderer::endInstancing(Camera* camera, int view, uint64_t state, std::function<void()> preRenderCallback)
+	{
+		if (!collectInstances)
+			return;
+
+		collectInstances = false;
+
+		const uint16_t stride = sizeof(glm::mat4x4);
+
+		for (int b = 0; b < numInstanceBatches; ++b)
+		{
+			InstanceBatch& batch = instanceBatches[b];
+			SubMesh* subMesh = batch.subMesh;
+			Material* material = batch.material;
+			Shader* shader = material->getShader();
+
+			uint32_t numInstances = (uint32_t)batch.transforms.size();
+
+			for (int j = 0; j < shader->getPassCount(); ++j)
+			{
+				Pass* pass = shader->getPass(j);
+				ProgramVariant* pv = pass->getInstancedProgramVariant(material->getDefinesStringHash());
+
+				if (pv == nullptr)
+					continue;
+
+				size_t iterationCount = 1;
+				if (pv->iterationMode == IterationMode::PerLight)
+					iterationCount = lights.size();
+
+				for (int iter = 0; iter < iterationCount; ++iter)
+				{
+					if (pv->iterationMode == IterationMode::PerLight)
+					{
+						if (!lights[iter]->submitUniforms())
+							continue;
+					}
+
+					uint32_t offset = 0;
+					while (offset < numInstances)
+					{
+						uint32_t count = bgfx::getAvailInstanceDataBuffer(numInstances - offset, stride);
+						if (count == 0)
+							break;
+
+						if (pv->iterationMode != IterationMode::PerLight && lights.size() > 0)
+						{
+							Light* light = getFirstLight();
+							if (light != nullptr)
+								light->submitUniforms();
+						}
+
+						bgfx::InstanceDataBuffer idb;
+						bgfx::allocInstanceDataBuffer(&idb, count, stride);
+						memcpy(idb.data, &batch.transforms[offset], count * stride);
+
+						bgfx::setVertexBuffer(0, subMesh->getVertexBufferHandle());
+
+						if (batch.lod > 0 && subMesh->getLodLevelsCount() > 0)
+						{
+							if (subMesh->getLodIndexBuffer(batch.lod - 1).size() > 0)
+								bgfx::setIndexBuffer(subMesh->getLodIndexBufferHandle(batch.lod - 1));
+						}
+						else
+						{
+							if (subMesh->getIndexBuffer().size() > 0)
+								bgfx::setIndexBuffer(subMesh->getIndexBufferHandle());
+						}
+
+						bgfx::setInstanceDataBuffer(&idb);
+						bgfx::setState(pv->getRenderState(state));
+
+						material->submitUniforms(pv, camera);
+
+						bgfx::setUniform(uGpuSkinning, glm::value_ptr(glm::vec4(0.0f)), 1);
+						bgfx::setUniform(uHasLightmap, glm::value_ptr(glm::vec4(0.0f)), 1);
+
+						//Per object matrices are meaningless here. Instanced variants derive them from the instance data
+						bgfx::setUniform(uNormalMatrix, glm::value_ptr(glm::mat3x3(1.0f)), 1);
+						bgfx::setUniform(uInvModel, glm::value_ptr(glm::mat4x4(1.0f)), 1);
+
+						if (preRenderCallback != nullptr)
+							preRenderCallback();
+
+						bgfx::submit(view, pv->programHandle);
+
+						offset += count;
+					}
+				}
+			}
 		}
 	}
 
@@ -1837,13 +2341,16 @@ namespace GX
 
 	void Renderer::calculateVisibility(const glm::mat4x4& view, const glm::mat4x4& proj, Frustum* frustum, float maxDistance)
 	{
-		moc->ClearBuffer();
+		cmoc->WakeThreads();
+		cmoc->ClearBuffer();
 
-		std::vector<GameObject*> staticNodes = Engine::getSingleton()->getGameObjects();
+		std::vector<GameObject*>& staticNodes = Engine::getSingleton()->getGameObjects();
 
 		glm::mat4x4 viewProj = proj * view;
 		glm::vec3 cameraPos = glm::vec3(view[3][0], view[3][1], view[3][2]);
 
+		occlusionViewProj = viewProj;
+
 		for (auto it = staticNodes.begin(); it != staticNodes.end(); ++it)
 		{
 			GameObject* obj = *it;
@@ -1855,7 +2362,7 @@ namespace GX
 			if (!obj->getOcclusionStatic())
 				continue;
 
-			MeshRenderer* rend = (MeshRenderer*)obj->getComponent(MeshRenderer::COMPONENT_TYPE);
+			MeshRenderer* rend = obj->getComponent<MeshRenderer>();
 			if (rend != nullptr && rend->getEnabled())
 			{
 				if (rend->isSkinned())
@@ -1878,9 +2385,7 @@ namespace GX
 				if (mesh != nullptr)
 				{
 					glm::mat4x4 mtx = viewProj * t->getTransformMatrix();
-
-					auto& lodVbuf = rend->getLodVertexBuffer();
-					auto& lodVbufMtx = rend->getLodVertexBufferMtxCache();
+					cmoc->SetMatrix(glm::value_ptr(mtx));
 
 					for (int sm = 0; sm < mesh->getSubMeshCount(); ++sm)
 					{
@@ -1889,44 +2394,26 @@ namespace GX
 						auto& vbuf = subMesh->getVertexBuffer();
 						auto& ibuf = subMesh->getIndexBuffer();
 
+						if (vbuf.size() == 0)
+							continue;
+
 						int maxLod = subMesh->getLodLevelsCount() - 1;
 
 						if (maxLod >= 0)
 						{
 							auto& lodIbuf = subMesh->getLodIndexBuffer(maxLod);
-
-							for (int i = 0; i < lodVbufMtx[sm].size(); ++i)
-								lodVbufMtx[sm][i] = false;
-
-							for (int i = 0; i < lodIbuf.size(); ++i)
-							{
-								if (!lodVbufMtx[sm][lodIbuf[i]])
-								{
-									glm::vec4 pos = mtx * glm::vec4(vbuf[lodIbuf[i]].position, 1.0);
-									lodVbuf[sm][lodIbuf[i]] = pos;
-									lodVbufMtx[sm][lodIbuf[i]] = true;
-								}
-							}
-
-							moc->RenderTriangles(&lodVbuf[sm][0].x, lodIbuf.data(), lodIbuf.size() / 3);
-						}
-
-						if (maxLod < 0)
-						{
-							for (int i = 0; i < vbuf.size(); ++i)
-							{
-								glm::vec4 pos = mtx * glm::vec4(vbuf[i].position, 1.0);
-								lodVbuf[sm][i] = pos;
-							}
-
-							moc->RenderTriangles(&lodVbuf[sm][0].x, ibuf.data(), ibuf.size() / 3);
+							cmoc->RenderTriangles(&vbuf[0].position.x, lodIbuf.data(), (int)lodIbuf.size() / 3);
 						}
+						else
+							cmoc->RenderTriangles(&vbuf[0].position.x, ibuf.data(), (int)ibuf.size() / 3);
 					}
 				}
 			}
 		}
 
-		//cmoc->Flush();
+		//Queries are made from the render thread after this point, so finish rasterization and let the workers sleep
+		cmoc->Flush();
+		cmoc->SuspendThreads();
 	}
 
 	void Renderer::updateEnvironmentMap()
@@ -2,6 +2,8 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <tuple>
 #include <functional>
 #include <bx/thread.h>
 #include <bgfx/bgfx.h>
@@ -27,6 +29,7 @@ namespace GX
 	class GameObject;
 	class Frustum;
 	class Cubemap;
+	class SubMesh;
 
 	#define MAX_LIGHTS 8
 
@@ -62,6 +65,30 @@ namespace GX
 		std::vector<glm::vec3> triangles;
 	};
 
+	struct InstanceBatch
+	{
+	public:
+		SubMesh* subMesh = nullptr;
+		Material* material = nullptr;
+		int lod = 0;
+		std::vector<glm::mat4x4> transforms;
+	};
+
+	struct RenderItem
+	{
+	public:
+		uint64_t key = 0;
+		Renderable* renderable = nullptr;
+	};
+
+	struct RenderList
+	{
+	public:
+		int queue = 0;
+		std::vector<RenderItem> opaque;
+		std::vector<RenderItem> transparent;
+	};
+
 	enum class SkyModel
 	{
 		Box,
@@ -202,6 +229,8 @@ namespace GX
 		bgfx::ProgramHandle simpleTexturePH = { bgfx::kInvalidHandle };
 		bgfx::ProgramHandle terrainTreeBillboardPH = { bgfx::kInvalidHandle };
 		bgfx::ProgramHandle terrainTreeBillboardLightPH = { bgfx::kInvalidHandle };
+		bgfx::ProgramHandle terrainTreeBillboardInstancedPH = { bgfx::kInvalidHandle };
+		bgfx::ProgramHandle terrainTreeBillboardLightInstancedPH = { bgfx::kInvalidHandle };
 		bgfx::ProgramHandle transparentPH = { bgfx::kInvalidHandle };
 		bgfx::ProgramHandle outlinePH = { bgfx::kInvalidHandle };
 		bgfx::ProgramHandle outlineFinalPH = { bgfx::kInvalidHandle };
@@ -267,11 +296,54 @@ namespace GX
 		void renderObjects(Camera* camera, int viewLayer, int renderQueue, const glm::mat4x4& view, const glm::mat4x4& proj, const glm::mat4x4& skyMtx);
 		void renderRenderCallbacks(Camera* camera, int viewLayer);
 
+		//Culling
+		bool cullingDataOutdated = true;
+		std::vector<Renderable*> cullRenderables;
+		std::vector<float> cullCenterX;
+		std::vector<float> cullCenterY;
+		std::vector<float> cullCenterZ;
+		std::vector<float> cullExtentX;
+		std::vector<float> cullExtentY;
+		std::vector<float> cullExtentZ;
+		std::vector<uint8_t> cullFlags;
+		std::vector<int> cullQueues;
+		std::vector<uint32_t> cullStateKeys;
+		std::vector<uint8_t> cullVisible;
+
+		std::vector<RenderItem> visibleRenderables;
+		std::vector<Renderable*> visibleDecals;
+		std::vector<RenderList> renderLists;
+		std::vector<RenderItem> sortBuffer;
+
+		void updateCullingData();
+		void cullVisibleRenderables(Camera* camera, int viewLayer, bool testOcclusion = false);
+		RenderList* getRenderList(int queue);
+
+		//Sort keys
+		static uint64_t makeOpaqueSortKey(int viewLayer, int queue, uint32_t stateKey, uint32_t depth);
+		static uint64_t makeTransparentSortKey(int viewLayer, int queue, uint32_t stateKey, uint32_t depth);
+		static uint32_t makeStateKey(Material* material);
+		void sortRenderItems(std::vector<RenderItem>& items);
+
+		//Instancing
+		typedef std::tuple<SubMesh*, Material*, int> InstanceBatchKey;
+
+		bool instancingEnabled = true;
+		bool collectInstances = false;
+		int numInstanceBatches = 0;
+		std::vector<InstanceBatch> instanceBatches;
+		std::map<InstanceBatchKey, int> instanceBatchMap;
+
+		void beginInstancing();
+		void endInstancing(Camera* camera, int view, uint64_t state, std::function<void()> preRenderCallback);
+
 		//Occlusion culling
 		MaskedOcclusionCulling* moc = nullptr;
 		CullingThreadpool* cmoc = nullptr;
+		glm::mat4x4 occlusionViewProj = glm::identity<glm::mat4x4>(); //View projection matrix of the last calculateVisibility call
 
 		void calculateVisibility(const glm::mat4x4& view, const glm::mat4x4& proj, Frustum* frustum = nullptr, float maxDistance = FLT_MAX);
+		bool isBoxOccluded(size_t index); //Tests the screen rect of a culling box against the depth buffer filled by calculateVisibility
 
 	public:
 		static Renderer* getSingleton() { return &singleton; }
@@ -335,6 +407,8 @@ namespace GX
 		bgfx::ProgramHandle getSimpleTextureProgram() { return simpleTexturePH; }
 		bgfx::ProgramHandle getTerrainTreeBillboardProgram() { return terrainTreeBillboardPH; }
 		bgfx::ProgramHandle getTerrainTreeBillboardLightProgram() { return terrainTreeBillboardLightPH; }
+		bgfx::ProgramHandle getTerrainTreeBillboardInstancedProgram() { return terrainTreeBillboardInstancedPH; }
+		bgfx::ProgramHandle getTerrainTreeBillboardLightInstancedProgram() { return terrainTreeBillboardLightInstancedPH; }
 		bgfx::ProgramHandle getShadowCasterProgram() { return shadowCasterPH; }
 		bgfx::ProgramHandle getLightProgram() { return lightPH; }
 		bgfx::ProgramHandle getCombineProgram() { return combinePH; }
@@ -386,6 +460,12 @@ namespace GX
 		void setShadowsEnabled(bool value) { shadowsEnabled = value; }
 		bool getShadowsEnabled() { return shadowsEnabled; }
 
+		void setInstancingEnabled(bool value) { instancingEnabled = value; }
+		bool getInstancingEnabled() { return instancingEnabled; }
+
+		bool getCollectInstances() { return collectInstances; }
+		bool addInstance(SubMesh* subMesh, int lod, Material* material, const glm::mat4x4& transform);
+
 		int getOutlineViewId();
 		int getFinalViewId();
 		int getSceneViewId();
@@ -404,6 +484,7 @@ namespace GX
 
 		MaskedOcclusionCulling* getOcclusionCullingProcessor() { return moc; }
 		CullingThreadpool* getOcclusionCullingThreadpool() { return cmoc; }
+		const glm::mat4x4& getOcclusionViewProj() { return occlusionViewProj; }
 
 		void updateEnvironmentMap();
 		void deleteEnvironmentMap();
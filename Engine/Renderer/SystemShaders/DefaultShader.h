@@ -15,7 +15,7 @@ namespace shaders
 		"{\n"
 		"	tags\n"
 		"	{\n"
-		"\n"
+		"		instancing on\n"
 		"	}\n"
 		"\n"
 		"	varying\n"
@@ -23,11 +23,19 @@ namespace shaders
 		"		vec3 a_position : POSITION;\n"
 		"		vec4 a_weight : BLENDWEIGHT;\n"
 		"		vec4 a_indices : BLENDINDICES;\n"
+		"		vec4 i_data0 : TEXCOORD7;\n"
+		"		vec4 i_data1 : TEXCOORD6;\n"
+		"		vec4 i_data2 : TEXCOORD5;\n"
+		"		vec4 i_data3 : TEXCOORD4;\n"
 		" }\n"
 		"\n"
 		"	vertex\n"
 		"	{\n"
+		"		#ifdef INSTANCING\n"
+		"		$input a_position, a_weight, a_indices, i_data0, i_data1, i_data2, i_data3\n"
+		"		#else\n"
 		"		$input a_position, a_weight, a_indices\n"
+		"		#endif\n"
 		"\n"
 		"		#include \"common.sh\"\n"
 		"\n"
@@ -36,6 +44,12 @@ namespace shaders
 		"\n"
 		"		void main()\n"
 		"		{\n"
+		"		#ifdef INSTANCING\n"
+		"			//Instanced draws are never skinned\n"
+		"			mat4 model = mtxFromCols(i_data0, i_data1, i_data2, i_data3);\n"
+		"			vec3 wpos = mul(model, vec4(a_position, 1.0)).xyz;\n"
+		"			gl_Position = mul(u_viewProj, vec4(wpos, 1.0));\n"
+		"		#else\n"
 		"			mat4 model = u_model[0];\n"
 		"\n"
 		"			if (u_skinned.x == 1.0)\n"
@@ -52,6 +66,7 @@ namespace shaders
 		"			{\n"
 		"				gl_Position = mul(u_modelViewProj, vec4(a_position, 1.0));\n"
 		"			}\n"
+		"		#endif\n"
 		"		}\n"
 		"	}\n"
 		"\n"
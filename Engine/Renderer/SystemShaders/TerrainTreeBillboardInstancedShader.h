@@ -0,0 +1,36 @@
+#include <string>
+
+namespace shaders
+{
+	static std::string terrainTreeBillboardInstancedVarying =
+		"vec2 v_texcoord0 : TEXCOORD0 = vec2(0.0, 0.0);\n"
+		"vec3 v_position  : POSITION = vec3(0.0, 0.0, 0.0);\n"
+		"\n"
+		"vec3 a_position  : POSITION;\n"
+		"vec2 a_texcoord0 : TEXCOORD0;\n"
+		"vec4 i_data0     : TEXCOORD7;\n"
+		"vec4 i_data1     : TEXCOORD6;\n"
+		"vec4 i_data2     : TEXCOORD5;\n"
+		"vec4 i_data3     : TEXCOORD4;\n";
+
+	//Quad is turned to the camera here, the instance matrix only gives the position and scale of the tree
+	static std::string terrainTreeBillboardInstancedVertex =
+		"$input a_position, a_texcoord0, i_data0, i_data1, i_data2, i_data3\n"
+		"$output v_texcoord0, v_position\n"
+		"\n"
+		"uniform mat4 u_view;\n"
+		"uniform mat4 u_viewProj;\n"
+		"\n"
+		"void main()\n"
+		"{\n"
+		"	vec3 right = vec3(u_view[0][0], u_view[1][0], u_view[2][0]);\n"
+		"	vec3 up = vec3(u_view[0][1], u_view[1][1], u_view[2][1]);\n"
+		"	float scale = length(i_data0.xyz);\n"
+		"\n"
+		"	vec3 position = i_data3.xyz + (right * a_position.x + up * a_position.y) * scale;\n"
+		"\n"
+		"	gl_Position = u_viewProj * vec4(position, 1.0);\n"
+		"	v_texcoord0 = a_texcoord0;\n"
+		"	v_position = position;\n"
+		"}\n";
+}
@@ -0,0 +1,323 @@
+#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <bgfx/bgfx.h>
+
+#include "Renderer.h"
+#include "../Core/Engine.h"
+#include "../Assets/Texture.h"
+#include "../Assets/Material.h"
+#include "../Components/Camera.h"
+#include "../Math/Mathf.h"
+#include "../Serialization/Settings/ProjectSettings.h"
+
+namespace GX
+{
+	TextureStreamer TextureStreamer::singleton;
+
+	TextureStreamer::TextureStreamer()
+	{
+
+	}
+
+	TextureStreamer::~TextureStreamer()
+	{
+
+	}
+
+	bool TextureStreamer::isEnabled()
+	{
+		return Engine::getSingleton()->getSettings()->getTextureStreaming();
+	}
+
+	uint64_t TextureStreamer::getBudget()
+	{
+		return (uint64_t)std::max(Engine::getSingleton()->getSettings()->getTextureStreamingBudget(), 1) * 1024 * 1024;
+	}
+
+	uint32_t TextureStreamer::getResidentSize(Texture* texture, int mip)
+	{
+		return (uint32_t)texture->size - Texture::getMipOffset(texture->format, texture->width, texture->height, mip);
+	}
+
+	int TextureStreamer::getTailMip(Texture* texture)
+	{
+		int mip = 0;
+		while ((texture->width >> mip) > tailResolution && mip < texture->numMipMaps - 1)
+			++mip;
+
+		return mip;
+	}
+
+	int TextureStreamer::getStartMip(Texture* texture)
+	{
+		if (!isEnabled() || !texture->streamed)
+			return 0;
+
+		return getTailMip(texture);
+	}
+
+	void TextureStreamer::addTexture(Texture* texture)
+	{
+		if (textures.find(texture) != textures.end())
+			return;
+
+		Entry entry;
+		entry.lastRequestFrame = frame;
+		textures[texture] = entry;
+
+		residentSize += getResidentSize(texture, texture->residentMip);
+	}
+
+	void TextureStreamer::removeTexture(Texture* texture)
+	{
+		auto it = textures.find(texture);
+		if (it == textures.end())
+			return;
+
+		Entry& entry = it->second;
+
+		if (entry.request != nullptr)
+		{
+			JobSystem::getSingleton()->wait(entry.request->job);
+
+			if (entry.request->data != nullptr)
+				delete[] entry.request->data;
+		}
+
+		residentSize -= getResidentSize(texture, texture->residentMip);
+
+		textures.erase(it);
+	}
+
+	void TextureStreamer::requestMip(Texture* texture, int mip)
+	{
+		auto it = textures.find(texture);
+		if (it == textures.end())
+		{
+			//Textures join the streamer when they are requested for the first time
+			if (!isEnabled() || !texture->streamable || texture->keepData || !bgfx::isValid(texture->textureHandle))
+				return;
+
+			texture->streamed = true;
+			addTexture(texture);
+			it = textures.find(texture);
+		}
+
+		Entry& entry = it->second;
+		entry.requestedMip = std::min(entry.requestedMip, std::max(mip, 0));
+		entry.lastRequestFrame = frame;
+	}
+
+	void TextureStreamer::requestMaterial(Camera* camera, Material* material, float worldSize, float distance)
+	{
+		if (material == nullptr || !isEnabled())
+			return;
+
+		for (auto& u : material->getUniforms())
+		{
+			if (u.getType() != UniformType::Sampler2D)
+				continue;
+
+			Texture* texture = u.getValue<Sampler2DDef>().second;
+			if (texture != nullptr)
+				requestMip(texture, calcMip(camera, texture, worldSize, distance));
+		}
+	}
+
+	int TextureStreamer::calcMip(Camera* camera, Texture* texture, float worldSize, float distance)
+	{
+		if (camera == nullptr || texture == nullptr || texture->getWidth() == 0 || worldSize <= 0.0f)
+			return 0;
+
+		float viewHeight = std::max((float)Renderer::getSingleton()->getHeight() * camera->getViewportHeight(), 1.0f);
+
+		//World units covered by one screen pixel
+		float pixelSize = 0.0f;
+		if (camera->getProjectionType() == ProjectionType::Perspective)
+		{
+			float dist = std::max(distance, camera->getNear());
+			pixelSize = 2.0f * dist * tan(camera->getFOVy() * Mathf::fDeg2Rad * 0.5f) / viewHeight;
+		}
+		else
+			pixelSize = 2.0f * camera->getOrthographicSize() / viewHeight;
+
+		float texelSize = worldSize / (float)texture->getWidth();
+
+		return std::max((int)std::floor(std::log2(pixelSize / texelSize)), 0);
+	}
+
+	int TextureStreamer::getNumPending()
+	{
+		int num = 0;
+		for (auto& it : textures)
+		{
+			if (it.second.request != nullptr)
+				++num;
+		}
+
+		return num;
+	}
+
+	void TextureStreamer::scheduleRequest(Texture* texture, Entry& entry, int mip)
+	{
+		std::shared_ptr<Request> request = std::make_shared<Request>();
+		request->mip = mip;
+
+		std::string texName = texture->getCachedFileName();
+		uint32_t size = (uint32_t)texture->size;
+		uint32_t offset = Texture::getMipOffset(texture->format, texture->width, texture->height, mip);
+
+		request->size = size - offset;
+		request->job = JobSystem::getSingleton()->schedule([=]()
+			{
+				request->data = Texture::readMipLevels(texName, offset, size);
+			}
+		);
+
+		entry.request = request;
+	}
+
+	void TextureStreamer::finishRequest(Texture* texture, Entry& entry)
+	{
+		std::shared_ptr<Request> request = entry.request;
+		entry.request = nullptr;
+
+		JobSystem::getSingleton()->wait(request->job);
+
+		//Cache is missing or was changed. Keep what is resident and stop trying
+		if (request->data == nullptr)
+		{
+			entry.failed = true;
+			return;
+		}
+
+		int mip = request->mip;
+
+		const bgfx::Memory* mem = bgfx::makeRef(reinterpret_cast<const void*>(request->data), request->size, Texture::releaseDataCallback, nullptr);
+		bgfx::TextureHandle handle = bgfx::createTexture2D(uint16_t(texture->width >> mip), uint16_t(texture->height >> mip), true, 1, texture->format, texture->getState(), mem);
+
+		if (bgfx::isValid(texture->textureHandle))
+			bgfx::destroy(texture->textureHandle);
+
+		texture->textureHandle = handle;
+
+		residentSize -= getResidentSize(texture, texture->residentMip);
+		texture->residentMip = mip;
+		residentSize += getResidentSize(texture, texture->residentMip);
+	}
+
+	void TextureStreamer::update()
+	{
+		++frame;
+
+		if (textures.empty())
+			return;
+
+		bool enabled = isEnabled();
+		int64_t budget = enabled ? (int64_t)getBudget() : INT64_MAX;
+
+		//Memory use after all running requests are applied
+		int64_t projectedSize = (int64_t)residentSize;
+		int numJobs = 0;
+
+		std::vector<std::pair<Texture*, int>> upgrades;
+		std::vector<std::pair<Texture*, int>> downgrades;
+
+		for (auto& it : textures)
+		{
+			Texture* texture = it.first;
+			Entry& entry = it.second;
+
+			if (entry.request != nullptr && entry.request->job.isDone())
+				finishRequest(texture, entry);
+
+			if (entry.requestedMip != INT_MAX)
+			{
+				entry.wantedMip = entry.requestedMip;
+				entry.requestedMip = INT_MAX;
+			}
+
+			if (entry.request != nullptr)
+			{
+				projectedSize += (int64_t)getResidentSize(texture, entry.request->mip) - getResidentSize(texture, texture->residentMip);
+				++numJobs;
+				continue;
+			}
+
+			if (entry.failed)
+				continue;
+
+			int tailMip = getTailMip(texture);
+			int wanted = tailMip;
+
+			if (!enabled)
+				wanted = 0;
+			else if (frame - entry.lastRequestFrame <= evictFrames)
+				wanted = std::min(entry.wantedMip, tailMip);
+
+			if (wanted < texture->residentMip)
+				upgrades.push_back(std::make_pair(texture, wanted));
+			else if (wanted > texture->residentMip)
+				downgrades.push_back(std::make_pair(texture, wanted));
+		}
+
+		if (numJobs >= maxJobs)
+			return;
+
+		//Release memory first. Textures out of view go back to the tail, visible ones lose detail only when over budget
+		std::sort(downgrades.begin(), downgrades.end(), [this](const std::pair<Texture*, int>& a, const std::pair<Texture*, int>& b) -> bool
+			{
+				return textures[a.first].lastRequestFrame < textures[b.first].lastRequestFrame;
+			}
+		);
+
+		for (auto& d : downgrades)
+		{
+			if (numJobs >= maxJobs)
+				break;
+
+			Texture* texture = d.first;
+			Entry& entry = textures[texture];
+
+			bool stale = frame - entry.lastRequestFrame > evictFrames;
+			if (!stale && projectedSize <= budget)
+				continue;
+
+			projectedSize -= (int64_t)getResidentSize(texture, texture->residentMip) - getResidentSize(texture, d.second);
+			scheduleRequest(texture, entry, d.second);
+			++numJobs;
+		}
+
+		//Most blurred textures first
+		std::sort(upgrades.begin(), upgrades.end(), [](const std::pair<Texture*, int>& a, const std::pair<Texture*, int>& b) -> bool
+			{
+				return a.first->residentMip - a.second > b.first->residentMip - b.second;
+			}
+		);
+
+		for (auto& u : upgrades)
+		{
+			if (numJobs >= maxJobs)
+				break;
+
+			Texture* texture = u.first;
+			int currentSize = getResidentSize(texture, texture->residentMip);
+
+			//Go as close to the wanted mip as the budget allows
+			int mip = u.second;
+			while (mip < texture->residentMip && projectedSize + (int64_t)getResidentSize(texture, mip) - currentSize > budget)
+				++mip;
+
+			if (mip >= texture->residentMip)
+				continue;
+
+			projectedSize += (int64_t)getResidentSize(texture, mip) - currentSize;
+			scheduleRequest(texture, textures[texture], mip);
+			++numJobs;
+		}
+	}
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <climits>
+#include <memory>
+#include <unordered_map>
+
+#include "../Core/JobSystem.h"
+
+namespace GX
+{
+	class Texture;
+	class Camera;
+	class Material;
+
+	//Keeps only the mip levels which are actually visible in GPU memory.
+	//Renderers report the mip they need every frame, missing levels are read from the Library cache on job threads
+	class TextureStreamer
+	{
+	private:
+		struct Request
+		{
+		public:
+			int mip = 0;
+			unsigned char* data = nullptr;
+			uint32_t size = 0;
+			JobHandle job;
+		};
+
+		struct Entry
+		{
+		public:
+			int requestedMip = INT_MAX; //Finest mip requested during the last frame
+			int wantedMip = INT_MAX;
+			uint32_t lastRequestFrame = 0;
+			bool failed = false;
+			std::shared_ptr<Request> request = nullptr;
+		};
+
+		static TextureStreamer singleton;
+
+		std::unordered_map<Texture*, Entry> textures;
+		uint32_t frame = 0;
+		uint64_t residentSize = 0;
+
+		int maxJobs = 4;
+		int tailResolution = 128; //Mip chain below this size is always resident
+		uint32_t evictFrames = 120; //Textures not requested for this number of frames go back to the tail
+
+		static uint32_t getResidentSize(Texture* texture, int mip);
+		int getTailMip(Texture* texture);
+
+		void scheduleRequest(Texture* texture, Entry& entry, int mip);
+		void finishRequest(Texture* texture, Entry& entry);
+
+	public:
+		TextureStreamer();
+		~TextureStreamer();
+
+		static TextureStreamer* getSingleton() { return &singleton; }
+
+		bool isEnabled();
+		uint64_t getBudget(); //Bytes
+
+		//First mip uploaded on load. 0 if the texture is not streamed or was never requested
+		int getStartMip(Texture* texture);
+
+		void addTexture(Texture* texture);
+		void removeTexture(Texture* texture);
+
+		//Called by renderers every frame the texture is visible. Only requested textures are streamed
+		void requestMip(Texture* texture, int mip);
+
+		//Requests all 2D textures of the material for an object of worldSize units at the given distance
+		void requestMaterial(Camera* camera, Material* material, float worldSize, float distance);
+
+		//Mip level at which one texel of a texture stretched over worldSize units matches one pixel at the given distance
+		static int calcMip(Camera* camera, Texture* texture, float worldSize, float distance);
+
+		//Applies finished loads and schedules new ones. Called once per frame on the main thread
+		void update();
+
+		uint64_t getResidentSize() { return residentSize; }
+		int getNumTextures() { return (int)textures.size(); }
+		int getNumPending();
+
+		int getMaxJobs() { return maxJobs; }
+		void setMaxJobs(int value) { maxJobs = value; }
+	};
+}
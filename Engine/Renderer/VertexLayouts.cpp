@@ -1,5 +1,12 @@
 #include "VertexLayouts.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <bx/math.h>
+
+#include "VertexBuffer.h"
+
 namespace GX
 {
 	bgfx::VertexLayout VertexLayouts::verticesOnlyVertexLayout;
@@ -8,6 +15,43 @@ namespace GX
 	bgfx::VertexLayout VertexLayouts::terrainVertexLayout;
 	bgfx::VertexLayout VertexLayouts::waterVertexLayout;
 	bgfx::VertexLayout VertexLayouts::particleVertexLayout;
+	bgfx::VertexLayout VertexLayouts::instanceMatrixLayout;
+	bgfx::VertexLayout VertexLayouts::compactSubMeshVertexLayouts[COMPACT_VERTEX_FORMAT_COUNT];
+
+	//Half floats keep at least 1/1024 precision in this range
+	static const float HALF_UV_RANGE = 2.0f;
+	static bool halfUVSupported = false;
+
+	static inline int16_t packSnorm16(float value)
+	{
+		return (int16_t)std::round(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+	}
+
+	static inline uint8_t packUnorm8(float value)
+	{
+		return (uint8_t)std::round(std::min(std::max(value, 0.0f), 1.0f) * 255.0f);
+	}
+
+	static inline void packDirection(uint8_t* dst, const glm::vec3& value, float w)
+	{
+		int16_t* d = (int16_t*)dst;
+		d[0] = packSnorm16(value.x);
+		d[1] = packSnorm16(value.y);
+		d[2] = packSnorm16(value.z);
+		d[3] = packSnorm16(w);
+	}
+
+	static inline void packTexCoord(uint8_t* dst, const glm::vec2& value, bool halfFloat)
+	{
+		if (halfFloat)
+		{
+			uint16_t* d = (uint16_t*)dst;
+			d[0] = bx::halfFromFloat(value.x);
+			d[1] = bx::halfFromFloat(value.y);
+		}
+		else
+			memcpy(dst, &value.x, sizeof(float) * 2);
+	}
 
 	void VertexLayouts::init()
 	{
@@ -66,5 +110,122 @@ namespace GX
 			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float, true, true)
 			.add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
 			.end();
+
+		instanceMatrixLayout = bgfx::VertexLayout();
+		instanceMatrixLayout
+			.begin()
+			.add(bgfx::Attrib::TexCoord7, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord6, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord5, 4, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord4, 4, bgfx::AttribType::Float)
+			.end();
+
+		halfUVSupported = (bgfx::getCaps()->supported & BGFX_CAPS_VERTEX_ATTRIB_HALF) != 0;
+
+		for (int i = 0; i < COMPACT_VERTEX_FORMAT_COUNT; ++i)
+		{
+			bgfx::AttribType::Enum uvType = (halfUVSupported && !(i & COMPACT_VERTEX_FLOAT_UV)) ? bgfx::AttribType::Half : bgfx::AttribType::Float;
+
+			bgfx::VertexLayout& layout = compactSubMeshVertexLayouts[i];
+			layout = bgfx::VertexLayout();
+			layout
+				.begin()
+				.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+				.add(bgfx::Attrib::Normal, 4, bgfx::AttribType::Int16, true)
+				.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Int16, true)
+				.add(bgfx::Attrib::Bitangent, 4, bgfx::AttribType::Int16, true)
+				.add(bgfx::Attrib::TexCoord0, 2, uvType)
+				.add(bgfx::Attrib::TexCoord1, 2, uvType);
+
+			if (i & COMPACT_VERTEX_SKINNED)
+			{
+				layout
+					.add(bgfx::Attrib::Weight, 4, bgfx::AttribType::Uint8, true)
+					.add(bgfx::Attrib::Indices, 4, bgfx::AttribType::Uint8);
+			}
+
+			layout
+				.add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true)
+				.end();
+		}
+	}
+
+	int VertexLayouts::selectCompactVertexFormat(const std::vector<VertexBuffer>& vertices, bool skinned)
+	{
+		int format = skinned ? COMPACT_VERTEX_SKINNED : 0;
+
+		for (auto& v : vertices)
+		{
+			if (std::abs(v.texcoord0.x) > HALF_UV_RANGE || std::abs(v.texcoord0.y) > HALF_UV_RANGE ||
+				std::abs(v.texcoord1.x) > HALF_UV_RANGE || std::abs(v.texcoord1.y) > HALF_UV_RANGE)
+			{
+				format |= COMPACT_VERTEX_FLOAT_UV;
+				break;
+			}
+		}
+
+		return format;
+	}
+
+	bgfx::VertexBufferHandle VertexLayouts::createCompactVertexBuffer(const std::vector<VertexBuffer>& vertices, bool skinned)
+	{
+		if (vertices.empty())
+			return BGFX_INVALID_HANDLE;
+
+		int format = selectCompactVertexFormat(vertices, skinned);
+		const bgfx::VertexLayout& layout = compactSubMeshVertexLayouts[format];
+
+		bool halfUV = halfUVSupported && !(format & COMPACT_VERTEX_FLOAT_UV);
+
+		uint16_t stride = layout.getStride();
+		uint16_t normalOffset = layout.getOffset(bgfx::Attrib::Normal);
+		uint16_t tangentOffset = layout.getOffset(bgfx::Attrib::Tangent);
+		uint16_t bitangentOffset = layout.getOffset(bgfx::Attrib::Bitangent);
+		uint16_t uv0Offset = layout.getOffset(bgfx::Attrib::TexCoord0);
+		uint16_t uv1Offset = layout.getOffset(bgfx::Attrib::TexCoord1);
+		uint16_t colorOffset = layout.getOffset(bgfx::Attrib::Color0);
+
+		//Memory is owned by bgfx and released after upload, so only the packed copy lives on the GPU
+		const bgfx::Memory* mem = bgfx::alloc((uint32_t)(vertices.size() * stride));
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			const VertexBuffer& v = vertices[i];
+			uint8_t* dst = mem->data + i * stride;
+
+			memcpy(dst, &v.position.x, sizeof(float) * 3);
+			packDirection(dst + normalOffset, v.normal, 0.0f);
+			packDirection(dst + tangentOffset, v.tangent, 0.0f);
+			packDirection(dst + bitangentOffset, v.bitangent, 0.0f);
+			packTexCoord(dst + uv0Offset, v.texcoord0, halfUV);
+			packTexCoord(dst + uv1Offset, v.texcoord1, halfUV);
+
+			if (format & COMPACT_VERTEX_SKINNED)
+			{
+				uint8_t* weights = dst + layout.getOffset(bgfx::Attrib::Weight);
+				uint8_t* indices = dst + layout.getOffset(bgfx::Attrib::Indices);
+
+				int sum = 0;
+				int largest = 0;
+
+				for (int j = 0; j < 4; ++j)
+				{
+					weights[j] = packUnorm8(v.blendWeights[j]);
+					indices[j] = (uint8_t)std::min(std::max(v.blendIndices[j], 0.0f), 255.0f);
+
+					sum += weights[j];
+					if (weights[j] > weights[largest])
+						largest = j;
+				}
+
+				//Keep weights summed to one after quantization
+				if (sum > 0 && std::abs(sum - 255) <= 4)
+					weights[largest] = (uint8_t)std::min(std::max(weights[largest] + 255 - sum, 0), 255);
+			}
+
+			memcpy(dst + colorOffset, &v.color, sizeof(uint32_t));
+		}
+
+		return bgfx::createVertexBuffer(mem, layout);
 	}
 }
\ No newline at end of file
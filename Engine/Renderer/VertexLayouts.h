@@ -1,9 +1,12 @@
 #pragma once
 
+#include <vector>
 #include <bgfx/bgfx.h>
 
 namespace GX
 {
+	struct VertexBuffer;
+
 	class VertexLayouts
 	{
 	public:
@@ -13,7 +16,22 @@ namespace GX
 		static bgfx::VertexLayout terrainVertexLayout;
 		static bgfx::VertexLayout waterVertexLayout;
 		static bgfx::VertexLayout particleVertexLayout;
+		static bgfx::VertexLayout instanceMatrixLayout; //Per instance model matrix read as i_data0..i_data3
+
+		//Compact GPU layouts for mesh data. Normals, tangents and bitangents are snorm16,
+		//texture coordinates are half floats if precision allows, blend data is 8 bit and only present for skinned meshes
+		enum CompactVertexFormat
+		{
+			COMPACT_VERTEX_SKINNED = 1 << 0,
+			COMPACT_VERTEX_FLOAT_UV = 1 << 1,
+			COMPACT_VERTEX_FORMAT_COUNT = 4
+		};
+
+		static bgfx::VertexLayout compactSubMeshVertexLayouts[COMPACT_VERTEX_FORMAT_COUNT];
 
 		static void init();
+
+		static int selectCompactVertexFormat(const std::vector<VertexBuffer>& vertices, bool skinned);
+		static bgfx::VertexBufferHandle createCompactVertexBuffer(const std::vector<VertexBuffer>& vertices, bool skinned);
 	};
 }
\ No newline at end of file
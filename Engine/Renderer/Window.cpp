@@ -19,6 +19,8 @@
 #include "../Engine/Assets/Scene.h"
 #include "../Engine/Core/Debug.h"
 #include "../Engine/Core/Time.h"
+#include "../Engine/Core/JobSystem.h"
+#include "../Engine/Core/AsyncLoader.h"
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -53,6 +55,7 @@ namespace GX
 			Debug::createLogFile(Helper::ExePath() + "editor.log");
 
 		Engine::getSingleton()->loadPlugins();
+		JobSystem::getSingleton()->init();
 		Renderer::getSingleton()->init(sdlWindow, context);
 		
 		if (!Engine::getSingleton()->getAssetsPath().empty())
@@ -169,8 +172,10 @@ namespace GX
 		SoundManager::getSingleton()->destroy();
 		PhysicsManager::getSingleton()->free();
 		NavigationManager::getSingleton()->cleanup();
+		AsyncLoader::getSingleton()->cancelAll();
 		Asset::unloadAll();
 		Renderer::getSingleton()->shutdown();
+		JobSystem::getSingleton()->shutdown();
 		Engine::getSingleton()->unloadPlugins();
 		APIManager::getSingleton()->close();
 
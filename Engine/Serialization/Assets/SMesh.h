@@ -6,6 +6,8 @@
 #include "../Data/SMatrix4.h"
 #include "../Data/SColor.h"
 
+#include "../../Renderer/VertexBuffer.h"
+
 #include "../Serializers/BinarySerializer.h"
 
 namespace GX
@@ -61,10 +63,15 @@ namespace GX
 	class SLodInfo : public Archive
 	{
 	public:
+		virtual int getVersion() { return 1; }
+
 		virtual void serialize(Serializer* s)
 		{
 			Archive::serialize(s);
-			dataVector(indexBuffer);
+			if (version > 0)
+				dataBlob(indexBuffer);
+			else
+				dataVector(indexBuffer);
 		}
 
 		SLodInfo() {}
@@ -76,13 +83,30 @@ namespace GX
 	class SSubMesh : public Archive
 	{
 	public:
+		virtual int getVersion() { return 1; }
+
 		virtual void serialize(Serializer* s)
 		{
 			Archive::serialize(s);
 			data(materialName);
 			data(useLightmapUVs);
-			data(vertexBuffer);
-			dataVector(indexBuffer);
+			if (version > 0)
+			{
+				//Vertex and index streams are stored as raw blocks in the VertexBuffer layout
+				int vertexStride = sizeof(VertexBuffer);
+				data(vertexStride);
+
+				if (vertexStride != sizeof(VertexBuffer))
+					throw std::invalid_argument("Incompatible vertex layout");
+
+				dataBlob(vertices);
+				dataBlob(indexBuffer);
+			}
+			else
+			{
+				data(vertexBuffer);
+				dataVector(indexBuffer);
+			}
 			data(bones);
 			data(lods);
 		}
@@ -91,6 +115,7 @@ namespace GX
 		~SSubMesh()
 		{
 			vertexBuffer.clear();
+			vertices.clear();
 			indexBuffer.clear();
 			lods.clear();
 			bones.clear();
@@ -99,7 +124,8 @@ namespace GX
 		std::string materialName = "";
 		bool useLightmapUVs = false;
 
-		std::vector<SVertexBuffer> vertexBuffer;
+		std::vector<SVertexBuffer> vertexBuffer; //Version 0 only
+		std::vector<VertexBuffer> vertices;
 		std::vector<uint32_t> indexBuffer;
 		std::vector<SLodInfo> lods;
 		std::vector<SBoneInfo> bones;
@@ -12,6 +12,8 @@ namespace GX
 	class STexture : public Archive
 	{
 	public:
+		virtual int getVersion() { return 1; }
+
 		virtual void serialize(Serializer* s)
 		{
 			Archive::serialize(s);
@@ -29,7 +31,14 @@ namespace GX
 			data(filterMode);
 			data(maxResolution);
 			data(border);
-			dataVector(pixels);
+			if (version > 0)
+				data(textureFormat);
+
+			//Only the length of pixel data is read, stream stays at its beginning
+			if (skipPixels && s->getOperation() == Serializer::Operation::Deserialize)
+				data(pixelsSize);
+			else
+				dataVector(pixels);
 		}
 
 		STexture() {}
@@ -49,6 +58,10 @@ namespace GX
 		int filterMode = 0;
 		int maxResolution = 4096;
 		SRect border;
+		int textureFormat = -1; //bgfx::TextureFormat. Not stored in old caches
 		std::vector<unsigned char> pixels;
+
+		bool skipPixels = false;
+		int pixelsSize = 0;
 	};
 }
\ No newline at end of file
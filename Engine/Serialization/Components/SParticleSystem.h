@@ -158,7 +158,7 @@ namespace GX
 		SParticleEmitter() {}
 		~SParticleEmitter() {}
 
-		virtual int getVersion() { return 3; }
+		virtual int getVersion() { return 4; }
 
 		virtual void serialize(Serializer* s)
 		{
@@ -208,6 +208,12 @@ namespace GX
 				data(animationTimeMode);
 				data(animationFps);
 			}
+
+			if (version > 3)
+			{
+				data(collisionMode);
+				data(collisionResponse);
+			}
 		}
 
 	public:
@@ -232,6 +238,8 @@ namespace GX
 		bool enablePhysics = false;
 		float friction = 0.85f;
 		float bounciness = 0.25f;
+		int collisionMode = 0;
+		int collisionResponse = 0;
 		bool animated = false;
 		SVector2 animationGridSize = SVector2(1, 1);
 		int animationTimeMode = 0;
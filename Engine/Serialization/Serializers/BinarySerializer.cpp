@@ -142,12 +142,8 @@ namespace GX
 		int size = (int)t.size();
 		write(size, s);
 
-		char* buf = new char[size];
-		memcpy(buf, &t[0], size * sizeof(char));
-
-		s->write(buf, size * sizeof(char));
-
-		delete[] buf;
+		if (size > 0)
+			s->write(reinterpret_cast<const char*>(&t[0]), size * sizeof(char));
 	}
 
 	void BinarySerializer::writeVectorULong(std::vector<unsigned long long>& t, std::ostream* s)
@@ -411,11 +407,8 @@ namespace GX
 
 		t.resize(size);
 
-		char* buf = new char[size];
-		s->read(buf, size * sizeof(char));
-		
-		memcpy(&t[0], buf, size * sizeof(char));
-		delete[] buf;
+		if (size > 0)
+			s->read(reinterpret_cast<char*>(&t[0]), size * sizeof(char));
 	}
 
 	void BinarySerializer::readVectorULong(std::vector<unsigned long long>& t, std::istream* s)
@@ -1,5 +1,7 @@
 #include "Serializer.h"
 
+#include <utility>
+
 #include "../../Classes/md5.h"
 
 namespace GX
@@ -26,6 +28,47 @@ namespace GX
 			throw std::invalid_argument("Writing to file failed");
 	}
 
+	void Serializer::writeBlob(const char* t, size_t size, std::ostream* s)
+	{
+		std::streamoff pos = s->tellp();
+		int padding = (int)((BLOB_ALIGNMENT - pos % BLOB_ALIGNMENT) % BLOB_ALIGNMENT);
+
+		char zero[BLOB_ALIGNMENT] = { 0 };
+		s->write(zero, padding);
+
+		if (size > 0)
+			s->write(t, size);
+
+		checkOutputStream(s);
+	}
+
+	void Serializer::readBlob(char* t, size_t size, std::istream* s)
+	{
+		checkInputStream(s);
+
+		std::streamoff pos = s->tellg();
+		int padding = (int)((BLOB_ALIGNMENT - pos % BLOB_ALIGNMENT) % BLOB_ALIGNMENT);
+		s->seekg(padding, std::ios_base::cur);
+
+		if (size == 0)
+			return;
+
+		s->read(t, size);
+
+		if ((size_t)s->gcount() != size)
+			throw std::invalid_argument("Reading from file failed");
+
+		//Data is stored in the byte order of the machine that wrote it
+		if (is_big_endian() != endian_is_big)
+		{
+			for (size_t i = 0; i + 3 < size; i += 4)
+			{
+				std::swap(t[i], t[i + 3]);
+				std::swap(t[i + 1], t[i + 2]);
+			}
+		}
+	}
+
 	void Serializer::serialize(std::ostream* s, Archive* a, std::string fileFormat)
 	{
 		operation = Operation::Serialize;
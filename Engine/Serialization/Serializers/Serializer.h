@@ -4,6 +4,7 @@
 #include <istream>
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 namespace GX
 {
@@ -27,6 +28,9 @@ namespace GX
 		template<typename T>
 		void dataVector(T& t);
 
+		template<typename T>
+		void dataBlob(std::vector<T>& t);
+
 		virtual void serialize(Serializer* s);
 		virtual int getVersion() { return 0; }
 	};
@@ -53,6 +57,9 @@ namespace GX
 		void checkInputStream(std::istream* s);
 		void checkOutputStream(std::ostream* s);
 
+		void writeBlob(const char* t, size_t size, std::ostream* s);
+		void readBlob(char* t, size_t size, std::istream* s);
+
 	public:
 		Serializer() {}
 		virtual ~Serializer() {}
@@ -78,6 +85,34 @@ namespace GX
 				readVector(t, (std::istream*)stream);
 		}
 
+		//Writes vector contents as a single raw block aligned to BLOB_ALIGNMENT bytes from the beginning of the stream.
+		//Elements must consist of 4 byte values only, so the block can be byte swapped as a whole on load
+		template<typename T>
+		inline void dataBlob(std::vector<T>& t)
+		{
+			static_assert(sizeof(T) % 4 == 0, "Blob elements must consist of 4 byte values");
+
+			if (operation == Operation::Serialize)
+			{
+				int size = (int)t.size();
+				write(size, (std::ostream*)stream);
+				writeBlob(reinterpret_cast<const char*>(t.data()), t.size() * sizeof(T), (std::ostream*)stream);
+			}
+			else
+			{
+				int size = 0;
+				read(size, (std::istream*)stream);
+
+				if (size < 0)
+					throw std::invalid_argument("Corrupted data block");
+
+				t.resize(size);
+				readBlob(reinterpret_cast<char*>(t.data()), t.size() * sizeof(T), (std::istream*)stream);
+			}
+		}
+
+		static const int BLOB_ALIGNMENT = 16;
+
 		//
 
 		template<typename T>
@@ -162,6 +197,12 @@ namespace GX
 		serializer->dataVector(t);
 	}
 
+	template<typename T>
+	inline void Archive::dataBlob(std::vector<T>& t)
+	{
+		serializer->dataBlob(t);
+	}
+
 	//Write
 
 	template<>
@@ -33,9 +33,11 @@ namespace GX
 		float shadowDistance = 100.0f;
 		bool shadowsEnabled = true;
 
-		int textureCompression = 2;
+		int textureCompression = 7; //Texture::CompressionMethod::Auto
 		int textureCompressionQuality = 1;
 		int textureMaxResolution = 4096;
+		bool textureStreaming = true;
+		int textureStreamingBudget = 512; //Megabytes
 
 		bool enableSteamAPI = false;
 		int steamAppId = 0;
@@ -50,6 +52,8 @@ namespace GX
 		ProjectSettings();
 		~ProjectSettings() = default;
 
+		virtual int getVersion() { return 1; }
+
 		virtual void serialize(Serializer* s)
 		{
 			Archive::serialize(s);
@@ -89,6 +93,12 @@ namespace GX
 					data(collisionMatrix[i][j]);
 				}
 			}
+
+			if (version > 0)
+			{
+				data(textureStreaming);
+				data(textureStreamingBudget);
+			}
 		}
 
 		void save();
@@ -163,6 +173,12 @@ namespace GX
 		int getTextureMaxResolution() { return textureMaxResolution; }
 		void setTextureMaxResolution(int value, std::function<void(std::string status, int progress)> callback = nullptr);
 
+		bool getTextureStreaming() { return textureStreaming; }
+		void setTextureStreaming(bool value) { textureStreaming = value; }
+
+		int getTextureStreamingBudget() { return textureStreamingBudget; }
+		void setTextureStreamingBudget(int value) { textureStreamingBudget = value; }
+
 		bool getEnableSteamAPI() { return enableSteamAPI; }
 		void setEnableSteamAPI(bool value) { enableSteamAPI = value; }
 
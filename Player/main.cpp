@@ -9,6 +9,7 @@
 #include "../Engine/Components/Camera.h"
 #include "../Engine/Assets/Scene.h"
 #include "../Engine/Assets/Texture.h"
+#include "../Engine/Assets/AnimationClip.h"
 #include "../Engine/Classes/Helpers.h"
 #include "../Engine/Classes/IO.h"
 #include "../Engine/Classes/StringConverter.h"
@@ -74,6 +75,9 @@ int main(int argc, char* argv[])
 	GX::Engine::getSingleton()->setAssemblyPath(projectPath + assemblyPath);
 	GX::Engine::getSingleton()->setBuiltinResourcesPath(GX::Helper::ExePath() + "BuiltinResources/");
 
+	//Clips are not edited in the player
+	GX::AnimationClip::setCompressOnLoad(true);
+
 	GX::ProjectSettings* settings = GX::Engine::getSingleton()->getSettings();
 	settings->load();
 